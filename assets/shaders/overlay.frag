@@ -0,0 +1,12 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+in vec4 Color;
+
+// Font atlas coverage in the red channel
+uniform sampler2D atlas;
+
+void main() {
+    FragColor = vec4(Color.rgb, Color.a * texture(atlas, TexCoord).r);
+}
\ No newline at end of file
@@ -0,0 +1,22 @@
+# Runs two server builds with --state-hash and fails unless they print the same hashes.
+# Usage: cmake -DFIRST=<server> -DSECOND=<server> [-DSECONDS=N] -P compare_state_hashes.cmake
+if(NOT SECONDS)
+    set(SECONDS 120)
+endif()
+
+foreach(SERVER FIRST SECOND)
+    execute_process(
+        COMMAND ${${SERVER}} --state-hash ${SECONDS}
+        OUTPUT_VARIABLE ${SERVER}_OUTPUT
+        RESULT_VARIABLE ${SERVER}_RESULT
+    )
+    if(NOT ${SERVER}_RESULT EQUAL 0)
+        message(FATAL_ERROR "${${SERVER}} --state-hash failed: ${${SERVER}_RESULT}")
+    endif()
+endforeach()
+
+message("${FIRST}:\n${FIRST_OUTPUT}")
+message("${SECOND}:\n${SECOND_OUTPUT}")
+if(NOT FIRST_OUTPUT STREQUAL SECOND_OUTPUT)
+    message(FATAL_ERROR "State hashes differ between the two builds")
+endif()
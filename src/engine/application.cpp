@@ -1,12 +1,30 @@
 #include "application.h"
 #include "input.h"
 #include "timer.h"
+#include "utils/alloc_counter.h"
 #include <glad/glad.h>
 #include <iostream>
 
+// Keys whose presses go through the timestamped queue, so taps shorter than a frame
+// still land on the right tick
+struct PressBinding {
+    SDL_Scancode key;
+    int player;
+    uint8_t buttons;
+};
+
+static const PressBinding PRESS_BINDINGS[] = {
+    { SDL_SCANCODE_W, 0, INPUT_JUMP },
+    { SDL_SCANCODE_SPACE, 0, INPUT_ATTACK },
+    { SDL_SCANCODE_UP, 1, INPUT_JUMP },
+    { SDL_SCANCODE_RCTRL, 1, INPUT_ATTACK }
+};
+
 Application::Application(const char* title, int width, int height)
     : m_window(nullptr), m_glContext(nullptr), m_running(false), m_width(width), m_height(height),
-      m_shader(nullptr), m_gameManager(nullptr) {
+      m_shader(nullptr), m_gameManager(nullptr), m_replayRecorder(nullptr), m_frameTimeMicroseconds(0),
+      m_inputThread(nullptr), m_controllerMoveX(), m_framePacer(nullptr), m_gpuProfiler(nullptr),
+      m_perfOverlay(nullptr), m_overlayAllocations(0), m_latencyTracker(nullptr), m_lastStatsMicroseconds(0) {
     
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
         std::cerr << "SDL could not initialize! SDL_Error: " << SDL_GetError() << std::endl;
@@ -55,7 +73,7 @@ Application::Application(const char* title, int width, int height)
     m_gameManager = new GameManager();
     m_gameManager->init();
     
-    // Add two players for testing
+    // Add two players for testing; each can also use the game controller with its index
     m_gameManager->addPlayer(FighterType::BALANCED, 0);
     m_gameManager->addPlayer(FighterType::HEAVY, 1);
     
@@ -64,24 +82,126 @@ Application::Application(const char* title, int width, int height)
     
     initRenderData();
     
+    m_framePacer = new FramePacer();
+    m_framePacer->configure(m_window, VsyncMode::ADAPTIVE, 0);
+    m_gpuProfiler = new GpuProfiler();
+    m_gameManager->setGpuProfiler(m_gpuProfiler);
+    m_perfOverlay = new PerfOverlay();
+    m_latencyTracker = new LatencyTracker();
+    m_inputThread = new InputThread();
+    
     m_running = true;
 }
 
 void Application::run() {
+    // The constructor reported why; nothing past the failed step exists
+    if (!m_running) {
+        return;
+    }
+    
     Input::init();
     Timer timer;
+    
+    m_inputThread->start();
 
     while (m_running) {
+        ProfileZone frameZone("frame");
+        m_frameStats.beginFrame(Input::getTimeMicroseconds());
+        m_gpuProfiler->beginFrame();
         float delta_time = timer.getDeltaTime();
 
         processInput();
+        
+        // The overlay's timestamps are only taken while it's shown
+        bool showOverlay = m_perfOverlay && m_perfOverlay->isVisible();
+        uint64_t updateStart = showOverlay ? Input::getTimeMicroseconds() : 0;
         update(delta_time);
+        uint64_t renderStart = showOverlay ? Input::getTimeMicroseconds() : 0;
         render();
-        SDL_GL_SwapWindow(m_window);
+        if (showOverlay) {
+            drawPerfOverlay(renderStart - updateStart, Input::getTimeMicroseconds() - renderStart);
+        }
+        
+        m_frameStats.endCpu(Input::getTimeMicroseconds());
+        swapBuffers();
+        m_frameStats.endPresent(Input::getTimeMicroseconds());
+        if (GlInterposer::isInstalled()) {
+            GlInterposer::endFrame();
+        }
+        
+        m_latencyTracker->framePresented(m_gameManager->takeConsumedInputTime());
+        m_latencyTracker->poll();
+        printStats();
+        
+        m_framePacer->waitForNextFrame();
     }
+    
+    m_inputThread->stop();
+}
+
+void Application::printStats() {
+    const uint64_t STATS_INTERVAL_MICROSECONDS = 5000000;
+    uint64_t now = Input::getTimeMicroseconds();
+    if (m_lastStatsMicroseconds == 0) {
+        m_lastStatsMicroseconds = now;
+    }
+    if (now - m_lastStatsMicroseconds < STATS_INTERVAL_MICROSECONDS) {
+        return;
+    }
+    m_lastStatsMicroseconds = now;
+    
+    std::cout << m_frameStats.formatSummary() << "  " << m_framePacer->getLateFrameCount() << " late" << std::endl;
+    if (GlInterposer::isInstalled()) {
+        const GlFrameCounters& gl = GlInterposer::getLastFrame();
+        std::cout << "gl per frame  " << gl.calls << " calls  " << gl.drawCalls << " draws  "
+                  << gl.stateChanges << " state changes (" << gl.redundantStateChanges << " redundant)  "
+                  << gl.bufferUploads + gl.textureUploads << " uploads  " << gl.bytesUploaded << " bytes" << std::endl;
+    }
+    
+    HdrHistogram& latency = m_latencyTracker->getHistogram();
+    if (latency.getCount() == 0) {
+        return;
+    }
+    std::cout << "input latency  p50 " << latency.getPercentile(50.0) / 1000.0 << " ms"
+              << "  p95 " << latency.getPercentile(95.0) / 1000.0 << " ms"
+              << "  p99 " << latency.getPercentile(99.0) / 1000.0 << " ms"
+              << "  max " << latency.getMax() / 1000.0 << " ms"
+              << "  (" << latency.getCount() << " inputs)" << std::endl;
+    latency.reset();
+}
+
+void Application::setFramePacing(VsyncMode vsync, int targetFps) {
+    if (m_framePacer) {
+        m_framePacer->configure(m_window, vsync, targetFps);
+    }
+}
+
+void Application::enableGlDebug() {
+    if (m_glContext) {
+        GlInterposer::install();
+    }
+}
+
+void Application::captureTrace(const std::string& path) {
+    m_tracePath = path;
+    Profiler::beginCapture();
+}
+
+void Application::recordReplay(const std::string& path) {
+    if (!m_gameManager) {
+        return;
+    }
+    
+    if (!m_replayRecorder) {
+        m_replayRecorder = new ReplayRecorder();
+    }
+    m_replayRecorder->begin(*m_gameManager);
+    m_gameManager->setReplayRecorder(m_replayRecorder);
+    m_replayPath = path;
 }
 
 void Application::processInput() {
+    ProfileZone zone("input");
     Input::update();
     
     SDL_Event event;
@@ -95,33 +215,110 @@ void Application::processInput() {
         if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_ESCAPE) {
             m_running = false;
         }
+        
+        if (event.type == SDL_KEYDOWN && event.key.keysym.scancode == SDL_SCANCODE_F12 && GlInterposer::isInstalled()) {
+            GlInterposer::captureNextFrame("gl_frame.log");
+        }
+        
+        if (event.type == SDL_KEYDOWN && event.key.keysym.scancode == SDL_SCANCODE_F3 && !event.key.repeat && m_perfOverlay) {
+            m_perfOverlay->toggle();
+            m_overlayAllocations = AllocationCounter::get().allocations;
+        }
     }
+    m_frameTimeMicroseconds = Input::getTimeMicroseconds();
     
-    // Process player 1 input
+    // Jumps and attacks are queued with their timestamps
+    InputEvent inputEvent;
+    while (Input::pollEvent(inputEvent)) {
+        if (inputEvent.type != InputEventType::KEY_DOWN) {
+            continue;
+        }
+        for (const PressBinding& binding : PRESS_BINDINGS) {
+            if (binding.key == inputEvent.code) {
+                m_gameManager->queuePress(binding.player, binding.buttons, AttackType::NEUTRAL, inputEvent.timeMicroseconds);
+            }
+        }
+    }
+    
+    // Controller presses carry the time the input thread sampled them
+    ControllerEvent controllerEvent;
+    while (m_inputThread && m_inputThread->pollEvent(controllerEvent)) {
+        m_controllerMoveX[controllerEvent.controller] = controllerEvent.moveX;
+        
+        int player = m_gameManager->getPlayerForController(controllerEvent.controller);
+        if (player >= 0 && controllerEvent.pressed != 0) {
+            m_gameManager->queuePress(player, controllerEvent.pressed, controllerEvent.attackType, controllerEvent.timeMicroseconds);
+        }
+    }
+    
+    // Movement is held, so sampling it once per frame is enough
     glm::vec2 movement1(0.0f);
     if (Input::isKeyDown(SDL_SCANCODE_A)) movement1.x -= 1.0f;
     if (Input::isKeyDown(SDL_SCANCODE_D)) movement1.x += 1.0f;
-    bool jump1 = Input::isKeyPressed(SDL_SCANCODE_W);
-    bool attack1 = Input::isKeyPressed(SDL_SCANCODE_SPACE);
+    if (movement1.x == 0.0f) movement1 = getControllerMovement(0);
     
-    m_gameManager->processPlayerInput(0, movement1, jump1, attack1, AttackType::NEUTRAL);
+    m_gameManager->processPlayerInput(0, movement1, false, false, AttackType::NEUTRAL);
     
-    // Process player 2 input
     glm::vec2 movement2(0.0f);
     if (Input::isKeyDown(SDL_SCANCODE_LEFT)) movement2.x -= 1.0f;
     if (Input::isKeyDown(SDL_SCANCODE_RIGHT)) movement2.x += 1.0f;
-    bool jump2 = Input::isKeyPressed(SDL_SCANCODE_UP);
-    bool attack2 = Input::isKeyPressed(SDL_SCANCODE_RCTRL);
+    if (movement2.x == 0.0f) movement2 = getControllerMovement(1);
     
-    m_gameManager->processPlayerInput(1, movement2, jump2, attack2, AttackType::NEUTRAL);
+    m_gameManager->processPlayerInput(1, movement2, false, false, AttackType::NEUTRAL);
+}
+
+glm::vec2 Application::getControllerMovement(int player) const {
+    for (int i = 0; i < InputThread::MAX_CONTROLLERS; i++) {
+        if (m_controllerMoveX[i] != 0 && m_gameManager->getPlayerForController(i) == player) {
+            return glm::vec2(static_cast<float>(m_controllerMoveX[i]), 0.0f);
+        }
+    }
+    return glm::vec2(0.0f);
 }
 
 void Application::update(float deltaTime) {
+    ProfileZone zone("update");
     // Update game manager
-    m_gameManager->update(deltaTime);
+    m_gameManager->update(deltaTime, m_frameTimeMicroseconds);
+}
+
+void Application::swapBuffers() {
+    ProfileZone zone("swap");
+    SDL_GL_SwapWindow(m_window);
+}
+
+void Application::drawPerfOverlay(uint64_t updateMicroseconds, uint64_t renderMicroseconds) {
+    GpuZone zone(m_gpuProfiler, "overlay");
+    PerfOverlaySample sample;
+    
+    const FrameTiming& frame = m_frameStats.getLastFrame();
+    sample.frameMs = frame.frameMicroseconds / 1000.0f;
+    sample.cpuMs = frame.cpuMicroseconds / 1000.0f;
+    sample.updateMs = updateMicroseconds / 1000.0f;
+    sample.renderMs = renderMicroseconds / 1000.0f;
+    
+    // The interposer's counters are for the previous frame, overlay included
+    if (GlInterposer::isInstalled()) {
+        const GlFrameCounters& gl = GlInterposer::getLastFrame();
+        sample.hasGlCounters = true;
+        sample.drawCalls = gl.drawCalls;
+        sample.stateChanges = gl.stateChanges;
+        sample.redundantStateChanges = gl.redundantStateChanges;
+    }
+    
+    uint64_t allocations = AllocationCounter::get().allocations;
+    sample.allocations = allocations - m_overlayAllocations;
+    m_overlayAllocations = allocations;
+    
+    const SimulationCounters& simulation = m_gameManager->getSimulationCounters();
+    sample.totalHitboxes = simulation.totalHitboxes;
+    sample.totalCollisionPairs = simulation.totalCollisionPairs;
+    
+    m_perfOverlay->draw(sample, m_width, m_height);
 }
 
 void Application::render() {
+    ProfileZone zone("render");
     glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     
@@ -166,13 +363,32 @@ void Application::initRenderData() {
 }
 
 Application::~Application() {
+    if (m_replayRecorder) {
+        m_replayRecorder->save(m_replayPath, *m_gameManager);
+        m_gameManager->setReplayRecorder(nullptr);
+        delete m_replayRecorder;
+    }
+    
+    if (!m_frameStatsPath.empty()) {
+        m_frameStats.exportTo(m_frameStatsPath);
+    }
+    if (!m_tracePath.empty()) {
+        Profiler::endCapture(m_tracePath);
+    }
+    
+    delete m_inputThread;
     delete m_shader;
     delete m_gameManager;
+    delete m_framePacer;
+    delete m_gpuProfiler;
+    delete m_perfOverlay;
+    delete m_latencyTracker;
     
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
     glDeleteBuffers(1, &EBO);
 
+    GlInterposer::uninstall();
     SDL_GL_DeleteContext(m_glContext);
     SDL_DestroyWindow(m_window);
     SDL_Quit();
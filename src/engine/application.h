@@ -8,6 +8,15 @@
 #include "rendering/shader.h"
 #include "game/game_manager.h"
 #include "game/fighter.h"
+#include "game/replay.h"
+#include "latency_tracker.h"
+#include "input_thread.h"
+#include "frame_pacer.h"
+#include "frame_stats.h"
+#include "rendering/gpu_profiler.h"
+#include "rendering/gl_interposer.h"
+#include "rendering/perf_overlay.h"
+#include <string>
 
 class Application {
 public:
@@ -15,11 +24,34 @@ public:
     ~Application();
 
     void run();
+    
+    // Records every simulation tick from here on and writes the replay to `path` on exit
+    void recordReplay(const std::string& path);
+    
+    // Adaptive vsync with no cap of its own by default. targetFps 0 leaves the rate to
+    // vsync, or to the display's refresh rate when vsync is unavailable.
+    void setFramePacing(VsyncMode vsync, int targetFps);
+    
+    // Writes the session's frame-time statistics to `path` as JSON on exit
+    void exportFrameStats(const std::string& path) { m_frameStatsPath = path; }
+    FrameStats& getFrameStats() { return m_frameStats; }
+    
+    // Captures CPU zones and GPU pass times from here on and writes a Chrome trace to
+    // `path` on exit
+    void captureTrace(const std::string& path);
+    
+    // Counts GL calls, state changes and uploads per frame (printed with the stats).
+    // F12 then writes the next frame's full call log to gl_frame.log.
+    void enableGlDebug();
 private:
     void processInput();
     void update(float deltaTime);  
     void render();
+    void swapBuffers();
+    void drawPerfOverlay(uint64_t updateMicroseconds, uint64_t renderMicroseconds);
     void initRenderData();
+    void printStats();
+    glm::vec2 getControllerMovement(int player) const;
 
     SDL_Window* m_window;
     SDL_GLContext m_glContext;
@@ -30,6 +62,30 @@ private:
     Shader* m_shader;
     GameManager* m_gameManager;
     
+    ReplayRecorder* m_replayRecorder;
+    std::string m_replayPath;
+    
+    // When this frame's input was sampled, on Input's event clock
+    uint64_t m_frameTimeMicroseconds;
+    
+    // Controllers are sampled off the main thread; this is the latest stick or d-pad
+    // direction each one reported
+    InputThread* m_inputThread;
+    int8_t m_controllerMoveX[InputThread::MAX_CONTROLLERS];
+    
+    FramePacer* m_framePacer;
+    FrameStats m_frameStats;
+    std::string m_frameStatsPath;
+    GpuProfiler* m_gpuProfiler;
+    std::string m_tracePath;
+    
+    // F3 toggles it; allocations are counted from one overlay frame to the next
+    PerfOverlay* m_perfOverlay;
+    uint64_t m_overlayAllocations;
+    
+    LatencyTracker* m_latencyTracker;
+    uint64_t m_lastStatsMicroseconds;
+    
     unsigned int VAO, VBO, EBO;
 };
 #endif
@@ -0,0 +1,106 @@
+#include "frame_pacer.h"
+#include "utils/profiler.h"
+#include <algorithm>
+#include <iostream>
+
+FramePacer::FramePacer()
+    : m_vsync(VsyncMode::OFF), m_targetFps(0), m_frequency(SDL_GetPerformanceFrequency()),
+      m_framePeriod(0), m_refreshPeriod(0), m_nextFrame(0), m_lastFrame(0),
+      m_spinMargin(static_cast<Uint64>(INITIAL_SPIN_MARGIN_SECONDS * m_frequency)),
+      m_frames(0), m_lateFrames(0) {
+}
+
+void FramePacer::configure(SDL_Window* window, VsyncMode vsync, int targetFps) {
+    // -1 is adaptive vsync; drivers without EXT_swap_control_tear reject it
+    m_vsync = VsyncMode::OFF;
+    if (vsync == VsyncMode::ADAPTIVE && SDL_GL_SetSwapInterval(-1) == 0) {
+        m_vsync = VsyncMode::ADAPTIVE;
+    } else if (vsync != VsyncMode::OFF && SDL_GL_SetSwapInterval(1) == 0) {
+        m_vsync = VsyncMode::ON;
+    } else {
+        if (vsync != VsyncMode::OFF) {
+            std::cerr << "Vsync unavailable, capping frame rate instead: " << SDL_GetError() << std::endl;
+        }
+        SDL_GL_SetSwapInterval(0);
+    }
+    
+    int refreshRate = FALLBACK_REFRESH_RATE;
+    SDL_DisplayMode mode;
+    if (window && SDL_GetWindowDisplayMode(window, &mode) == 0 && mode.refresh_rate > 0) {
+        refreshRate = mode.refresh_rate;
+    }
+    m_refreshPeriod = m_frequency / refreshRate;
+    
+    m_targetFps = targetFps > 0 ? targetFps : 0;
+    if (m_targetFps == 0 && m_vsync == VsyncMode::OFF) {
+        m_targetFps = refreshRate;
+    }
+    m_framePeriod = m_targetFps > 0 ? m_frequency / m_targetFps : 0;
+    
+    m_nextFrame = 0;
+    m_lastFrame = 0;
+}
+
+void FramePacer::waitForNextFrame() {
+    Uint64 now = SDL_GetPerformanceCounter();
+    
+    // A frame is late when it took noticeably longer than its slot: the cap's period, or
+    // one refresh under vsync (i.e. it missed a vblank)
+    Uint64 slot = m_framePeriod;
+    if (m_vsync != VsyncMode::OFF) {
+        slot = std::max(slot, m_refreshPeriod);
+    }
+    if (m_lastFrame != 0 && now - m_lastFrame > slot + slot / 2) {
+        m_lateFrames++;
+    }
+    m_frames++;
+    
+    if (m_framePeriod > 0) {
+        if (m_nextFrame == 0) {
+            m_nextFrame = now;
+        }
+        m_nextFrame += m_framePeriod;
+        
+        // Behind schedule: start over from now instead of rushing frames out to catch up
+        if (now >= m_nextFrame) {
+            m_nextFrame = now;
+        } else {
+            sleepUntil(m_nextFrame);
+        }
+    }
+    
+    m_lastFrame = SDL_GetPerformanceCounter();
+}
+
+void FramePacer::sleepUntil(Uint64 deadline) {
+    ProfileZone zone("frame pacing");
+    Uint64 now = SDL_GetPerformanceCounter();
+    
+    // Coarse part: SDL_Delay has millisecond granularity and may overshoot
+    if (deadline > now + m_spinMargin) {
+        Uint64 sleepTicks = deadline - now - m_spinMargin;
+        Uint32 milliseconds = static_cast<Uint32>(sleepTicks * 1000 / m_frequency);
+        if (milliseconds > 0) {
+            Uint64 sleepEnd = now + static_cast<Uint64>(milliseconds) * m_frequency / 1000;
+            SDL_Delay(milliseconds);
+            now = SDL_GetPerformanceCounter();
+            
+            // Track how far the OS oversleeps: widen the margin at once when it overshoots
+            // by more, and narrow it slowly otherwise so a single hiccup doesn't leave us
+            // spinning for milliseconds every frame
+            Uint64 overshoot = now > sleepEnd ? now - sleepEnd : 0;
+            Uint64 minMargin = static_cast<Uint64>(MIN_SPIN_MARGIN_SECONDS * m_frequency);
+            Uint64 maxMargin = static_cast<Uint64>(MAX_SPIN_MARGIN_SECONDS * m_frequency);
+            if (overshoot > m_spinMargin) {
+                m_spinMargin = std::min(overshoot, maxMargin);
+            } else {
+                m_spinMargin = std::max(m_spinMargin - (m_spinMargin - overshoot) / 8, minMargin);
+            }
+        }
+    }
+    
+    // Fine part: spin on the counter
+    while (now < deadline) {
+        now = SDL_GetPerformanceCounter();
+    }
+}
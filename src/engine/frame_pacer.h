@@ -0,0 +1,59 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <SDL2/SDL.h>
+#include <cstdint>
+
+enum class VsyncMode {
+    OFF,
+    ON,
+    ADAPTIVE    // Syncs when on time, tears instead of waiting a whole refresh when late
+};
+
+// Paces the main loop. Vsync is requested from the driver, falling back from adaptive to
+// regular vsync when unsupported; a frame rate cap is enforced by sleeping until shortly
+// before the frame is due and spinning on the performance counter for the rest, since
+// OS sleeps can overshoot by a millisecond or more. With neither available, frames are
+// capped at the display's refresh rate rather than spinning as fast as possible.
+class FramePacer {
+public:
+    FramePacer();
+    
+    // Needs a current GL context. targetFps 0 means no cap of our own.
+    void configure(SDL_Window* window, VsyncMode vsync, int targetFps);
+    
+    // Call once per frame after the buffer swap. Waits until the next frame is due and
+    // counts the one just finished as late if it overran its slot.
+    void waitForNextFrame();
+    
+    VsyncMode getVsyncMode() const { return m_vsync; }        // What the driver accepted
+    int getTargetFps() const { return m_targetFps; }
+    uint64_t getLateFrameCount() const { return m_lateFrames; }
+    uint64_t getFrameCount() const { return m_frames; }
+    
+private:
+    static constexpr int FALLBACK_REFRESH_RATE = 60;
+    
+    // The last stretch before a deadline is spun rather than slept; the margin follows
+    // how much the OS's sleeps overshoot, within these bounds
+    static constexpr double INITIAL_SPIN_MARGIN_SECONDS = 0.002;
+    static constexpr double MIN_SPIN_MARGIN_SECONDS = 0.0005;
+    static constexpr double MAX_SPIN_MARGIN_SECONDS = 0.004;
+    
+    VsyncMode m_vsync;
+    int m_targetFps;
+    
+    Uint64 m_frequency;
+    Uint64 m_framePeriod;       // Counter ticks per frame; 0 when uncapped
+    Uint64 m_refreshPeriod;     // Counter ticks per display refresh
+    Uint64 m_nextFrame;         // Counter value the next frame is due at
+    Uint64 m_lastFrame;
+    Uint64 m_spinMargin;
+    
+    uint64_t m_frames;
+    uint64_t m_lateFrames;
+    
+    void sleepUntil(Uint64 deadline);
+};
+
+#endif
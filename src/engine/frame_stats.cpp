@@ -0,0 +1,159 @@
+#include "frame_stats.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+FrameStats::FrameStats()
+    : m_frameTimes(MAX_FRAME_MICROSECONDS)
+    , m_cpuTimes(MAX_FRAME_MICROSECONDS)
+    , m_presentTimes(MAX_FRAME_MICROSECONDS)
+    , m_frameStart(0)
+    , m_cpuEnd(0)
+    , m_presentEnd(0)
+    , m_lastFrame()
+    , m_windowFrameTimes(MAX_FRAME_MICROSECONDS)
+    , m_window()
+    , m_windows()
+    , m_windowCount(0)
+    , m_windowNext(0)
+{
+    setHitchThresholds({33.3, 50.0, 100.0});
+}
+
+void FrameStats::setHitchThresholds(const std::vector<double>& milliseconds) {
+    m_hitchThresholds = milliseconds;
+    std::sort(m_hitchThresholds.begin(), m_hitchThresholds.end());
+    m_hitchCounts.assign(m_hitchThresholds.size(), 0);
+}
+
+void FrameStats::beginFrame(uint64_t timeMicroseconds) {
+    // Only frames that went all the way through present are recorded
+    if (m_frameStart != 0 && m_cpuEnd >= m_frameStart && m_presentEnd >= m_cpuEnd && timeMicroseconds >= m_presentEnd) {
+        recordFrame(timeMicroseconds - m_frameStart, m_cpuEnd - m_frameStart, m_presentEnd - m_cpuEnd);
+    }
+    
+    if (m_window.startMicroseconds == 0) {
+        m_window.startMicroseconds = timeMicroseconds;
+    } else if (timeMicroseconds - m_window.startMicroseconds >= WINDOW_MICROSECONDS) {
+        // A hitch longer than a second starts the next window late rather than leaving
+        // empty ones behind
+        closeWindow(timeMicroseconds);
+    }
+    
+    m_frameStart = timeMicroseconds;
+    m_cpuEnd = 0;
+    m_presentEnd = 0;
+}
+
+void FrameStats::endCpu(uint64_t timeMicroseconds) {
+    m_cpuEnd = timeMicroseconds;
+}
+
+void FrameStats::endPresent(uint64_t timeMicroseconds) {
+    m_presentEnd = timeMicroseconds;
+}
+
+void FrameStats::recordFrame(uint64_t frameMicroseconds, uint64_t cpuMicroseconds, uint64_t presentMicroseconds) {
+    m_lastFrame = {frameMicroseconds, cpuMicroseconds, presentMicroseconds};
+    m_frameTimes.record(frameMicroseconds);
+    m_cpuTimes.record(cpuMicroseconds);
+    m_presentTimes.record(presentMicroseconds);
+    m_windowFrameTimes.record(frameMicroseconds);
+    
+    double milliseconds = frameMicroseconds / 1000.0;
+    for (size_t i = 0; i < m_hitchThresholds.size(); i++) {
+        if (milliseconds > m_hitchThresholds[i]) {
+            m_hitchCounts[i]++;
+        }
+    }
+    
+    m_window.frames++;
+    if (!m_hitchThresholds.empty() && milliseconds > m_hitchThresholds[0]) {
+        m_window.hitches++;
+    }
+}
+
+void FrameStats::closeWindow(uint64_t timeMicroseconds) {
+    m_window.p99FrameMicroseconds = m_windowFrameTimes.getPercentile(99.0);
+    m_window.maxFrameMicroseconds = m_windowFrameTimes.getMax();
+    
+    m_windows[m_windowNext] = m_window;
+    m_windowNext = (m_windowNext + 1) % WINDOW_HISTORY;
+    m_windowCount = std::min(m_windowCount + 1, WINDOW_HISTORY);
+    
+    m_window = FrameWindow();
+    m_window.startMicroseconds = timeMicroseconds;
+    m_windowFrameTimes.reset();
+}
+
+std::vector<FrameWindow> FrameStats::getWindows() const {
+    std::vector<FrameWindow> windows;
+    windows.reserve(m_windowCount);
+    int first = (m_windowNext - m_windowCount + WINDOW_HISTORY) % WINDOW_HISTORY;
+    for (int i = 0; i < m_windowCount; i++) {
+        windows.push_back(m_windows[(first + i) % WINDOW_HISTORY]);
+    }
+    return windows;
+}
+
+std::string FrameStats::formatSummary() const {
+    std::ostringstream stream;
+    stream << "frame time  p50 " << m_frameTimes.getPercentile(50.0) / 1000.0 << " ms"
+           << "  p90 " << m_frameTimes.getPercentile(90.0) / 1000.0 << " ms"
+           << "  p99 " << m_frameTimes.getPercentile(99.0) / 1000.0 << " ms"
+           << "  p99.9 " << m_frameTimes.getPercentile(99.9) / 1000.0 << " ms"
+           << "  max " << m_frameTimes.getMax() / 1000.0 << " ms"
+           << "  (" << m_frameTimes.getCount() << " frames";
+    for (size_t i = 0; i < m_hitchThresholds.size(); i++) {
+        stream << ", " << m_hitchCounts[i] << " over " << m_hitchThresholds[i] << " ms";
+    }
+    stream << ")";
+    return stream.str();
+}
+
+static void writePercentiles(std::ostream& out, const char* name, const HdrHistogram& histogram) {
+    out << "  \"" << name << "\": {"
+        << "\"p50\": " << histogram.getPercentile(50.0) / 1000.0
+        << ", \"p90\": " << histogram.getPercentile(90.0) / 1000.0
+        << ", \"p99\": " << histogram.getPercentile(99.0) / 1000.0
+        << ", \"p99.9\": " << histogram.getPercentile(99.9) / 1000.0
+        << ", \"max\": " << histogram.getMax() / 1000.0
+        << ", \"mean\": " << histogram.getMean() / 1000.0 << "},\n";
+}
+
+bool FrameStats::exportTo(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Failed to write frame stats to " << path << std::endl;
+        return false;
+    }
+    
+    out << "{\n";
+    out << "  \"frames\": " << m_frameTimes.getCount() << ",\n";
+    writePercentiles(out, "frame_ms", m_frameTimes);
+    writePercentiles(out, "cpu_ms", m_cpuTimes);
+    writePercentiles(out, "present_ms", m_presentTimes);
+    
+    out << "  \"hitches\": [";
+    for (size_t i = 0; i < m_hitchThresholds.size(); i++) {
+        out << (i ? ", " : "") << "{\"threshold_ms\": " << m_hitchThresholds[i] << ", \"count\": " << m_hitchCounts[i] << "}";
+    }
+    out << "],\n";
+    
+    // Window start times are relative to the first one kept
+    std::vector<FrameWindow> windows = getWindows();
+    out << "  \"windows\": [";
+    for (size_t i = 0; i < windows.size(); i++) {
+        const FrameWindow& window = windows[i];
+        out << (i ? ",\n    " : "\n    ")
+            << "{\"start_s\": " << (window.startMicroseconds - windows[0].startMicroseconds) / 1000000.0
+            << ", \"frames\": " << window.frames
+            << ", \"hitches\": " << window.hitches
+            << ", \"p99_ms\": " << window.p99FrameMicroseconds / 1000.0
+            << ", \"max_ms\": " << window.maxFrameMicroseconds / 1000.0 << "}";
+    }
+    out << (windows.empty() ? "]\n" : "\n  ]\n");
+    out << "}\n";
+    return static_cast<bool>(out);
+}
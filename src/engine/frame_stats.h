@@ -0,0 +1,92 @@
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "utils/hdr_histogram.h"
+
+// Summary of one second of frames
+struct FrameWindow {
+    uint64_t startMicroseconds;
+    uint32_t frames;
+    uint32_t hitches;                 // Frames over the lowest hitch threshold
+    uint64_t p99FrameMicroseconds;
+    uint64_t maxFrameMicroseconds;
+};
+
+struct FrameTiming {
+    uint64_t frameMicroseconds;
+    uint64_t cpuMicroseconds;
+    uint64_t presentMicroseconds;
+};
+
+// Every frame's timings, unclamped, for frame-time targets on release builds. Each frame
+// is split into CPU time (frame start until the swap is issued) and present time (the
+// swap call itself, which is where vsync and a full driver queue block); the frame time
+// is start to next start, so it also covers frame pacing.
+class FrameStats {
+public:
+    FrameStats();
+    
+    // Frame times above each threshold count as a hitch against it. Defaults to 33.3, 50
+    // and 100 ms.
+    void setHitchThresholds(const std::vector<double>& milliseconds);
+    
+    // Timestamps on Input::getTimeMicroseconds()'s clock. beginFrame records the
+    // frame before it.
+    void beginFrame(uint64_t timeMicroseconds);
+    void endCpu(uint64_t timeMicroseconds);
+    void endPresent(uint64_t timeMicroseconds);
+    
+    const HdrHistogram& getFrameTimes() const { return m_frameTimes; }
+    const HdrHistogram& getCpuTimes() const { return m_cpuTimes; }
+    const HdrHistogram& getPresentTimes() const { return m_presentTimes; }
+    
+    // The most recently recorded frame, i.e. the one before the current beginFrame
+    const FrameTiming& getLastFrame() const { return m_lastFrame; }
+    
+    const std::vector<double>& getHitchThresholds() const { return m_hitchThresholds; }
+    uint64_t getHitchCount(int threshold) const { return m_hitchCounts[threshold]; }
+    
+    // The last WINDOW_HISTORY complete seconds, oldest first
+    std::vector<FrameWindow> getWindows() const;
+    
+    // One line of p50/p90/p99/p99.9 frame times and hitch counts
+    std::string formatSummary() const;
+    
+    // Whole-session histograms, hitch counts and window history as JSON
+    bool exportTo(const std::string& path) const;
+    
+    static constexpr int WINDOW_HISTORY = 120;
+    
+private:
+    // Anything slower than a minute is recorded as a minute
+    static constexpr uint64_t MAX_FRAME_MICROSECONDS = 60000000;
+    static constexpr uint64_t WINDOW_MICROSECONDS = 1000000;
+    
+    HdrHistogram m_frameTimes;
+    HdrHistogram m_cpuTimes;
+    HdrHistogram m_presentTimes;
+    
+    std::vector<double> m_hitchThresholds;     // Milliseconds, ascending
+    std::vector<uint64_t> m_hitchCounts;
+    
+    // Frame in progress
+    uint64_t m_frameStart;
+    uint64_t m_cpuEnd;
+    uint64_t m_presentEnd;
+    FrameTiming m_lastFrame;
+    
+    // Current one-second window and the ring of finished ones
+    HdrHistogram m_windowFrameTimes;
+    FrameWindow m_window;
+    FrameWindow m_windows[WINDOW_HISTORY];
+    int m_windowCount;
+    int m_windowNext;
+    
+    void recordFrame(uint64_t frameMicroseconds, uint64_t cpuMicroseconds, uint64_t presentMicroseconds);
+    void closeWindow(uint64_t timeMicroseconds);
+};
+
+#endif
@@ -1,4 +1,5 @@
 #include "input.h"
+#include <algorithm>
 
 bool Input::m_keys[SDL_NUM_SCANCODES] = {false};
 bool Input::m_keysPressed[SDL_NUM_SCANCODES] = {false};
@@ -10,8 +11,46 @@ int Input::m_mouseX = 0;
 int Input::m_mouseY = 0;
 int Input::m_mouseDeltaX = 0;
 int Input::m_mouseDeltaY = 0;
+InputEvent Input::m_events[EVENT_BUFFER_SIZE];
+uint32_t Input::m_eventRead = 0;
+uint32_t Input::m_eventWrite = 0;
+uint64_t Input::m_droppedEvents = 0;
 
 void Input::init() {
+    m_eventRead = 0;
+    m_eventWrite = 0;
+}
+
+uint64_t Input::getTimeMicroseconds() {
+    static const Uint64 frequency = SDL_GetPerformanceFrequency();
+    Uint64 counter = SDL_GetPerformanceCounter();
+    return counter / frequency * 1000000 + counter % frequency * 1000000 / frequency;
+}
+
+bool Input::pollEvent(InputEvent& event) {
+    if (m_eventRead == m_eventWrite) {
+        return false;
+    }
+    event = m_events[m_eventRead % EVENT_BUFFER_SIZE];
+    m_eventRead++;
+    return true;
+}
+
+void Input::pushEvent(InputEventType type, int code, Uint32 sdlTimestamp) {
+    // SDL stamps events in milliseconds when it queues them, which can be well before
+    // we poll; move that age onto the high-resolution clock
+    uint64_t now = getTimeMicroseconds();
+    uint64_t age = static_cast<uint64_t>(SDL_GetTicks() - sdlTimestamp) * 1000;
+
+    if (m_eventWrite - m_eventRead == EVENT_BUFFER_SIZE) {
+        m_eventRead++;
+        m_droppedEvents++;
+    }
+    InputEvent& event = m_events[m_eventWrite % EVENT_BUFFER_SIZE];
+    event.timeMicroseconds = now - std::min(age, now);
+    event.type = type;
+    event.code = code;
+    m_eventWrite++;
 }
 
 void Input::update() {
@@ -35,12 +74,14 @@ void Input::processEvent(const SDL_Event& event) {
             if (!m_keys[event.key.keysym.scancode]) {
                 m_keys[event.key.keysym.scancode] = true;
                 m_keysPressed[event.key.keysym.scancode] = true;
+                pushEvent(InputEventType::KEY_DOWN, event.key.keysym.scancode, event.key.timestamp);
             }
             break;
 
         case SDL_KEYUP:
             m_keys[event.key.keysym.scancode] = false;
             m_keysReleased[event.key.keysym.scancode] = true;
+            pushEvent(InputEventType::KEY_UP, event.key.keysym.scancode, event.key.timestamp);
             break;
 
         case SDL_MOUSEMOTION:
@@ -56,6 +97,7 @@ void Input::processEvent(const SDL_Event& event) {
                 if (!m_mouseButtons[index]) {
                     m_mouseButtons[index] = true;
                     m_mouseButtonsPressed[index] = true;
+                    pushEvent(InputEventType::MOUSE_DOWN, index, event.button.timestamp);
                 }
             }
             break;
@@ -65,6 +107,7 @@ void Input::processEvent(const SDL_Event& event) {
                 int index = event.button.button - 1;
                 m_mouseButtons[index] = false;
                 m_mouseButtonsReleased[index] = true;
+                pushEvent(InputEventType::MOUSE_UP, index, event.button.timestamp);
             }
             break;
     }
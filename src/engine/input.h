@@ -2,6 +2,21 @@
 #define INPUT_H
 
 #include <SDL2/SDL.h>
+#include <cstdint>
+
+enum class InputEventType : uint8_t {
+    KEY_DOWN,
+    KEY_UP,
+    MOUSE_DOWN,
+    MOUSE_UP
+};
+
+// A press or release with the time it happened, so nothing is lost between frames
+struct InputEvent {
+    uint64_t timeMicroseconds;  // On getTimeMicroseconds()'s clock
+    InputEventType type;
+    int code;                   // SDL_Scancode, or mouse button index
+};
 
 class Input {
 public:
@@ -9,6 +24,11 @@ public:
     static void update();
     static void processEvent(const SDL_Event& event);
     
+    // Oldest unread event. Events stay queued across update() until read.
+    static bool pollEvent(InputEvent& event);
+    static uint64_t getTimeMicroseconds();
+    static uint64_t getDroppedEventCount() { return m_droppedEvents; }
+    
     static bool isKeyDown(SDL_Scancode key) { return m_keys[key]; }
     static bool isKeyPressed(SDL_Scancode key) { return m_keysPressed[key]; }
     static bool isKeyReleased(SDL_Scancode key) { return m_keysReleased[key]; }
@@ -35,6 +55,15 @@ private:
     static bool m_mouseButtons[5];
     static bool m_mouseButtonsPressed[5];
     static bool m_mouseButtonsReleased[5];
+    
+    // Far more than one frame's worth; when full the oldest event is dropped
+    static constexpr int EVENT_BUFFER_SIZE = 256;
+    static InputEvent m_events[EVENT_BUFFER_SIZE];
+    static uint32_t m_eventRead;
+    static uint32_t m_eventWrite;
+    static uint64_t m_droppedEvents;
+    
+    static void pushEvent(InputEventType type, int code, Uint32 sdlTimestamp);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,176 @@
+#include "input_thread.h"
+#include "input.h"
+#include "game/player_input.h"
+#include <chrono>
+#include <iostream>
+
+InputThread::InputThread(int rateHz)
+    : m_rateHz(rateHz > 0 ? rateHz : 1000)
+    , m_running(false)
+    , m_droppedEvents(0)
+    , m_controllerCount(0)
+    , m_joystickCount(-1)
+{
+}
+
+InputThread::~InputThread() {
+    stop();
+}
+
+bool InputThread::start() {
+    if (m_thread.joinable()) {
+        return true;
+    }
+    
+    if (SDL_InitSubSystem(SDL_INIT_GAMECONTROLLER) < 0) {
+        std::cerr << "Game controllers unavailable! SDL_Error: " << SDL_GetError() << std::endl;
+        return false;
+    }
+    
+    // Controllers are read directly by the input thread, so keep their events out of
+    // the main thread's queue
+    SDL_GameControllerEventState(SDL_IGNORE);
+    
+    m_running = true;
+    m_thread = std::thread(&InputThread::run, this);
+    return true;
+}
+
+void InputThread::stop() {
+    if (!m_thread.joinable()) {
+        return;
+    }
+    
+    m_running = false;
+    m_thread.join();
+    SDL_QuitSubSystem(SDL_INIT_GAMECONTROLLER);
+}
+
+void InputThread::run() {
+    typedef std::chrono::steady_clock Clock;
+    const Clock::duration period = std::chrono::duration_cast<Clock::duration>(std::chrono::microseconds(1000000 / m_rateHz));
+    const Clock::duration rescanInterval = std::chrono::milliseconds(RESCAN_INTERVAL_MILLISECONDS);
+    
+    Clock::time_point next = Clock::now();
+    Clock::time_point nextRescan = next;
+    
+    while (m_running.load(std::memory_order_relaxed)) {
+        SDL_GameControllerUpdate();
+        
+        // Hotplug is noticed by polling the joystick count rather than through events,
+        // which only the main thread sees
+        if (next >= nextRescan) {
+            if (SDL_NumJoysticks() != m_joystickCount) {
+                closeControllers();
+                openControllers();
+            }
+            nextRescan = next + rescanInterval;
+        }
+        
+        uint64_t now = Input::getTimeMicroseconds();
+        for (int i = 0; i < m_controllerCount; i++) {
+            sample(i, now);
+        }
+        
+        // After a stall (e.g. the machine was suspended) resume from now instead of
+        // sampling in a burst
+        next += period;
+        Clock::time_point current = Clock::now();
+        if (next < current) {
+            next = current;
+        }
+        std::this_thread::sleep_until(next);
+    }
+    
+    closeControllers();
+}
+
+void InputThread::openControllers() {
+    m_joystickCount = SDL_NumJoysticks();
+    for (int i = 0; i < m_joystickCount && m_controllerCount < MAX_CONTROLLERS; i++) {
+        if (!SDL_IsGameController(i)) {
+            continue;
+        }
+        SDL_GameController* handle = SDL_GameControllerOpen(i);
+        if (!handle) {
+            std::cerr << "Could not open game controller " << i << "! SDL_Error: " << SDL_GetError() << std::endl;
+            continue;
+        }
+        
+        // Buttons already held when a controller appears don't count as presses
+        m_controllers[m_controllerCount++] = read(handle);
+    }
+}
+
+void InputThread::closeControllers() {
+    for (int i = 0; i < m_controllerCount; i++) {
+        SDL_GameControllerClose(m_controllers[i].handle);
+    }
+    
+    // Release anything the removed controllers were holding
+    uint64_t now = Input::getTimeMicroseconds();
+    for (int i = 0; i < m_controllerCount; i++) {
+        if (m_controllers[i].moveX != 0) {
+            ControllerEvent event = {now, i, 0, 0, AttackType::NEUTRAL};
+            if (!m_events.push(event)) {
+                m_droppedEvents.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+    m_controllerCount = 0;
+}
+
+void InputThread::sample(int index, uint64_t timeMicroseconds) {
+    ControllerState& previous = m_controllers[index];
+    ControllerState current = read(previous.handle);
+    
+    bool attack = current.attack && !previous.attack;
+    bool special = current.special && !previous.special;
+    uint8_t pressed = 0;
+    if (current.jump && !previous.jump) pressed |= INPUT_JUMP;
+    if (attack || special) pressed |= INPUT_ATTACK;
+    
+    if (pressed != 0 || current.moveX != previous.moveX) {
+        ControllerEvent event;
+        event.timeMicroseconds = timeMicroseconds;
+        event.controller = index;
+        event.moveX = current.moveX;
+        event.pressed = pressed;
+        // A normal attack wins over a special pressed in the same sample
+        event.attackType = (pressed & INPUT_ATTACK) ? attackDirection(current, !attack) : AttackType::NEUTRAL;
+        
+        if (!m_events.push(event)) {
+            m_droppedEvents.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    
+    previous = current;
+}
+
+InputThread::ControllerState InputThread::read(SDL_GameController* handle) {
+    ControllerState state;
+    state.handle = handle;
+    
+    Sint16 x = SDL_GameControllerGetAxis(handle, SDL_CONTROLLER_AXIS_LEFTX);
+    Sint16 y = SDL_GameControllerGetAxis(handle, SDL_CONTROLLER_AXIS_LEFTY);
+    state.moveX = x < -STICK_DEAD_ZONE ? -1 : (x > STICK_DEAD_ZONE ? 1 : 0);
+    // SDL's Y axis points down; the game's points up
+    state.moveY = y < -STICK_DEAD_ZONE ? 1 : (y > STICK_DEAD_ZONE ? -1 : 0);
+    
+    if (SDL_GameControllerGetButton(handle, SDL_CONTROLLER_BUTTON_DPAD_LEFT)) state.moveX = -1;
+    if (SDL_GameControllerGetButton(handle, SDL_CONTROLLER_BUTTON_DPAD_RIGHT)) state.moveX = 1;
+    if (SDL_GameControllerGetButton(handle, SDL_CONTROLLER_BUTTON_DPAD_UP)) state.moveY = 1;
+    if (SDL_GameControllerGetButton(handle, SDL_CONTROLLER_BUTTON_DPAD_DOWN)) state.moveY = -1;
+    
+    state.jump = SDL_GameControllerGetButton(handle, SDL_CONTROLLER_BUTTON_A) != 0;
+    state.attack = SDL_GameControllerGetButton(handle, SDL_CONTROLLER_BUTTON_X) != 0;
+    state.special = SDL_GameControllerGetButton(handle, SDL_CONTROLLER_BUTTON_B) != 0;
+    return state;
+}
+
+AttackType InputThread::attackDirection(const ControllerState& state, bool special) {
+    if (state.moveY > 0) return special ? AttackType::SPECIAL_UP : AttackType::UP;
+    if (state.moveY < 0) return special ? AttackType::SPECIAL_DOWN : AttackType::DOWN;
+    if (state.moveX != 0) return special ? AttackType::SPECIAL_SIDE : AttackType::SIDE;
+    return special ? AttackType::SPECIAL_NEUTRAL : AttackType::NEUTRAL;
+}
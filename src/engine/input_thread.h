@@ -0,0 +1,80 @@
+#ifndef INPUT_THREAD_H
+#define INPUT_THREAD_H
+
+#include <SDL2/SDL.h>
+#include <atomic>
+#include <thread>
+#include <cstdint>
+#include "game/fighter_components.h"
+#include "utils/spsc_queue.h"
+
+// A change in one controller's state, stamped when the input thread saw it
+struct ControllerEvent {
+    uint64_t timeMicroseconds;  // On Input::getTimeMicroseconds()'s clock
+    int controller;             // Index passed to GameManager::addPlayer
+    int8_t moveX;               // -1 left, 0 none, 1 right; held until the next event
+    uint8_t pressed;            // InputButtons pressed since the last event
+    AttackType attackType;      // Direction of the attack or special in `pressed`
+};
+
+// Samples game controllers on a dedicated thread at a fixed rate (1 kHz by default)
+// instead of once per rendered frame, and hands changes to the main thread through a
+// lock-free queue. Controller i is the i-th attached game controller.
+//
+// Keyboard and mouse stay on the main thread: SDL only delivers them by pumping events
+// on the thread that owns the window, and their events already carry timestamps.
+class InputThread {
+public:
+    static constexpr int MAX_CONTROLLERS = 4;
+    
+    InputThread(int rateHz = 1000);
+    ~InputThread();
+    
+    bool start();
+    void stop();
+    
+    // Main thread only
+    bool pollEvent(ControllerEvent& event) { return m_events.pop(event); }
+    
+    // Events lost because the main thread stopped draining the queue
+    uint64_t getDroppedEventCount() const { return m_droppedEvents.load(std::memory_order_relaxed); }
+    
+private:
+    // Button layout: A jumps, X attacks, B specials. The left stick or d-pad moves and
+    // picks the attack direction.
+    struct ControllerState {
+        SDL_GameController* handle;
+        int8_t moveX;
+        int8_t moveY;
+        bool jump;
+        bool attack;
+        bool special;
+    };
+    
+    // Stick deflection below this reads as centred
+    static constexpr int16_t STICK_DEAD_ZONE = 8000;
+    static constexpr int RESCAN_INTERVAL_MILLISECONDS = 1000;
+    
+    int m_rateHz;
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+    std::atomic<uint64_t> m_droppedEvents;
+    SpscQueue<ControllerEvent, 1024> m_events;
+    
+    // Touched only by the input thread
+    ControllerState m_controllers[MAX_CONTROLLERS];
+    int m_controllerCount;
+    int m_joystickCount;
+    
+    void run();
+    void openControllers();
+    void closeControllers();
+    void sample(int index, uint64_t timeMicroseconds);
+    static ControllerState read(SDL_GameController* handle);
+    static AttackType attackDirection(const ControllerState& state, bool special);
+    
+    InputThread(const InputThread&) = delete;
+    InputThread& operator=(const InputThread&) = delete;
+};
+
+#endif
@@ -0,0 +1,62 @@
+#include "latency_tracker.h"
+#include "input.h"
+
+LatencyTracker::LatencyTracker()
+    : m_pendingStart(0)
+    , m_pendingCount(0)
+    , m_histogram(MAX_LATENCY_MICROSECONDS)
+    , m_droppedSamples(0)
+{
+}
+
+LatencyTracker::~LatencyTracker() {
+    clear();
+}
+
+void LatencyTracker::framePresented(uint64_t inputTimeMicroseconds) {
+    if (inputTimeMicroseconds == 0) {
+        return;
+    }
+    
+    if (m_pendingCount == MAX_PENDING) {
+        popFront();
+        m_droppedSamples++;
+    }
+    
+    PendingFrame& frame = m_pending[(m_pendingStart + m_pendingCount) % MAX_PENDING];
+    frame.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    frame.inputTimeMicroseconds = inputTimeMicroseconds;
+    m_pendingCount++;
+    
+    // Make sure the fence reaches the GPU even if nothing else is submitted
+    glFlush();
+}
+
+void LatencyTracker::poll() {
+    // Fences signal in submission order, so stop at the first one still pending
+    while (m_pendingCount > 0) {
+        PendingFrame& frame = m_pending[m_pendingStart];
+        GLenum status = glClientWaitSync(frame.fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            break;
+        }
+        
+        uint64_t now = Input::getTimeMicroseconds();
+        if (now > frame.inputTimeMicroseconds) {
+            m_histogram.record(now - frame.inputTimeMicroseconds);
+        }
+        popFront();
+    }
+}
+
+void LatencyTracker::clear() {
+    while (m_pendingCount > 0) {
+        popFront();
+    }
+}
+
+void LatencyTracker::popFront() {
+    glDeleteSync(m_pending[m_pendingStart].fence);
+    m_pendingStart = (m_pendingStart + 1) % MAX_PENDING;
+    m_pendingCount--;
+}
@@ -0,0 +1,52 @@
+#ifndef LATENCY_TRACKER_H
+#define LATENCY_TRACKER_H
+
+#include <glad/glad.h>
+#include <cstdint>
+#include "utils/hdr_histogram.h"
+
+// Input-to-photon latency. After each buffer swap that shows the result of an input, a
+// fence goes into the GL command stream behind the swap; once the GPU has passed it the
+// frame is on its way to the display, and the time since the input was stamped is
+// recorded. Fences are polled without blocking, so a sample can read up to one frame
+// late; scanout itself isn't visible to GL and isn't included.
+class LatencyTracker {
+public:
+    LatencyTracker();
+    ~LatencyTracker();
+    
+    // Call right after SDL_GL_SwapWindow. inputTimeMicroseconds is the oldest input the
+    // presented ticks consumed, on Input::getTimeMicroseconds()'s clock; 0 for none.
+    void framePresented(uint64_t inputTimeMicroseconds);
+    
+    // Records every fence the GPU has passed
+    void poll();
+    
+    // Deletes outstanding fences; call before the GL context goes away
+    void clear();
+    
+    // Latency in microseconds
+    HdrHistogram& getHistogram() { return m_histogram; }
+    uint64_t getDroppedSamples() const { return m_droppedSamples; }
+    
+private:
+    // Frames queued in the driver; more than this and the oldest sample is dropped
+    static constexpr int MAX_PENDING = 8;
+    // Anything slower than ten seconds is recorded as ten seconds
+    static constexpr uint64_t MAX_LATENCY_MICROSECONDS = 10000000;
+    
+    struct PendingFrame {
+        GLsync fence;
+        uint64_t inputTimeMicroseconds;
+    };
+    
+    PendingFrame m_pending[MAX_PENDING];
+    int m_pendingStart;
+    int m_pendingCount;
+    HdrHistogram m_histogram;
+    uint64_t m_droppedSamples;
+    
+    void popFront();
+};
+
+#endif
@@ -0,0 +1,261 @@
+#include "timer_wheel.h"
+#include <algorithm>
+#include <cstring>
+
+TimerWheel::TimerWheel()
+    : m_currentTick(0)
+    , m_nextId(1)
+    , m_pendingCount(0)
+{
+}
+
+uint32_t TimerWheel::schedule(uint32_t delayTicks, uint32_t owner, uint16_t kind, uint16_t data) {
+    TimerEvent event;
+    event.tick = m_currentTick + std::max<uint32_t>(delayTicks, 1);
+    event.id = m_nextId++;
+    event.owner = owner;
+    event.kind = kind;
+    event.data = data;
+    
+    place(event);
+    m_pendingCount++;
+    return event.id;
+}
+
+void TimerWheel::place(const TimerEvent& event) {
+    uint64_t delta = event.tick - m_currentTick;
+    
+    // Pick the finest level whose span covers the delay; the slot comes from the
+    // absolute tick, so the event drops a level each time its slot is cascaded
+    for (int level = 0; level < LEVELS; level++) {
+        if (delta < (1ull << (SLOT_BITS * (level + 1)))) {
+            int slot = static_cast<int>((event.tick >> (SLOT_BITS * level)) & (SLOTS - 1));
+            m_slots[level][slot].push_back(event);
+            return;
+        }
+    }
+    
+    m_overflow.push_back(event);
+}
+
+void TimerWheel::cascade(int level) {
+    int slot = static_cast<int>((m_currentTick >> (SLOT_BITS * level)) & (SLOTS - 1));
+    
+    std::vector<TimerEvent> events;
+    events.swap(m_slots[level][slot]);
+    for (const TimerEvent& event : events) {
+        place(event);
+    }
+    
+    // Reuse the vector's storage for the slot
+    events.clear();
+    if (m_slots[level][slot].empty()) {
+        m_slots[level][slot].swap(events);
+    }
+}
+
+void TimerWheel::advance(std::vector<TimerEvent>& expired) {
+    m_currentTick++;
+    
+    // When a level wraps, redistribute the next slot of the level above it, coarsest first
+    if ((m_currentTick & (SLOTS - 1)) == 0) {
+        int topLevel = 1;
+        while (topLevel < LEVELS - 1 && ((m_currentTick >> (SLOT_BITS * topLevel)) & (SLOTS - 1)) == 0) {
+            topLevel++;
+        }
+        
+        if (topLevel == LEVELS - 1 && ((m_currentTick >> (SLOT_BITS * topLevel)) & (SLOTS - 1)) == 0 && !m_overflow.empty()) {
+            std::vector<TimerEvent> overflow;
+            overflow.swap(m_overflow);
+            for (const TimerEvent& event : overflow) {
+                place(event);
+            }
+        }
+        
+        for (int level = topLevel; level >= 1; level--) {
+            cascade(level);
+        }
+    }
+    
+    std::vector<TimerEvent>& due = m_slots[0][m_currentTick & (SLOTS - 1)];
+    if (due.empty()) {
+        return;
+    }
+    
+    size_t first = expired.size();
+    expired.insert(expired.end(), due.begin(), due.end());
+    m_pendingCount -= due.size();
+    due.clear();
+    
+    // Cascades can interleave events, so restore scheduling order for determinism
+    std::sort(expired.begin() + first, expired.end(), [](const TimerEvent& a, const TimerEvent& b) {
+        return a.id < b.id;
+    });
+}
+
+template <typename Predicate>
+void TimerWheel::removeIf(Predicate predicate) {
+    for (int level = 0; level < LEVELS; level++) {
+        for (int slot = 0; slot < SLOTS; slot++) {
+            std::vector<TimerEvent>& events = m_slots[level][slot];
+            size_t before = events.size();
+            events.erase(std::remove_if(events.begin(), events.end(), predicate), events.end());
+            m_pendingCount -= before - events.size();
+        }
+    }
+    
+    size_t before = m_overflow.size();
+    m_overflow.erase(std::remove_if(m_overflow.begin(), m_overflow.end(), predicate), m_overflow.end());
+    m_pendingCount -= before - m_overflow.size();
+}
+
+bool TimerWheel::cancel(uint32_t id, uint64_t tick) {
+    if (tick <= m_currentTick) {
+        return false;
+    }
+    
+    // The event sits in the slot for its tick on one of the levels, or in overflow
+    for (int level = 0; level < LEVELS; level++) {
+        int slot = static_cast<int>((tick >> (SLOT_BITS * level)) & (SLOTS - 1));
+        std::vector<TimerEvent>& events = m_slots[level][slot];
+        for (size_t i = 0; i < events.size(); i++) {
+            if (events[i].id == id) {
+                events.erase(events.begin() + i);
+                m_pendingCount--;
+                return true;
+            }
+        }
+    }
+    
+    for (size_t i = 0; i < m_overflow.size(); i++) {
+        if (m_overflow[i].id == id) {
+            m_overflow.erase(m_overflow.begin() + i);
+            m_pendingCount--;
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+void TimerWheel::cancelOwner(uint32_t owner) {
+    removeIf([owner](const TimerEvent& event) { return event.owner == owner; });
+}
+
+void TimerWheel::removeOwner(uint32_t owner) {
+    cancelOwner(owner);
+    
+    for (int level = 0; level < LEVELS; level++) {
+        for (int slot = 0; slot < SLOTS; slot++) {
+            for (TimerEvent& event : m_slots[level][slot]) {
+                if (event.owner > owner) {
+                    event.owner--;
+                }
+            }
+        }
+    }
+    for (TimerEvent& event : m_overflow) {
+        if (event.owner > owner) {
+            event.owner--;
+        }
+    }
+}
+
+void TimerWheel::clear() {
+    for (int level = 0; level < LEVELS; level++) {
+        for (int slot = 0; slot < SLOTS; slot++) {
+            m_slots[level][slot].clear();
+        }
+    }
+    m_overflow.clear();
+    m_currentTick = 0;
+    m_nextId = 1;
+    m_pendingCount = 0;
+}
+
+// Events are encoded field by field so struct padding never reaches the output
+static const size_t ENCODED_EVENT_SIZE = sizeof(uint64_t) + sizeof(uint32_t) * 2 + sizeof(uint16_t) * 2;
+
+void TimerWheel::serialize(std::vector<uint8_t>& out) const {
+    // Header: current tick, next id, event count; then the events sorted by id so the
+    // encoding doesn't depend on which slots they currently sit in
+    // Scratch keeps its capacity so repeated snapshots don't allocate
+    std::vector<TimerEvent>& events = m_serializeScratch;
+    events.clear();
+    for (int level = 0; level < LEVELS; level++) {
+        for (int slot = 0; slot < SLOTS; slot++) {
+            events.insert(events.end(), m_slots[level][slot].begin(), m_slots[level][slot].end());
+        }
+    }
+    events.insert(events.end(), m_overflow.begin(), m_overflow.end());
+    std::sort(events.begin(), events.end(), [](const TimerEvent& a, const TimerEvent& b) {
+        return a.id < b.id;
+    });
+    
+    uint32_t count = static_cast<uint32_t>(events.size());
+    size_t offset = out.size();
+    out.resize(offset + sizeof(m_currentTick) + sizeof(m_nextId) + sizeof(count) + count * ENCODED_EVENT_SIZE);
+    
+    uint8_t* cursor = out.data() + offset;
+    std::memcpy(cursor, &m_currentTick, sizeof(m_currentTick));
+    cursor += sizeof(m_currentTick);
+    std::memcpy(cursor, &m_nextId, sizeof(m_nextId));
+    cursor += sizeof(m_nextId);
+    std::memcpy(cursor, &count, sizeof(count));
+    cursor += sizeof(count);
+    
+    for (const TimerEvent& event : events) {
+        std::memcpy(cursor, &event.tick, sizeof(event.tick));
+        cursor += sizeof(event.tick);
+        std::memcpy(cursor, &event.id, sizeof(event.id));
+        cursor += sizeof(event.id);
+        std::memcpy(cursor, &event.owner, sizeof(event.owner));
+        cursor += sizeof(event.owner);
+        std::memcpy(cursor, &event.kind, sizeof(event.kind));
+        cursor += sizeof(event.kind);
+        std::memcpy(cursor, &event.data, sizeof(event.data));
+        cursor += sizeof(event.data);
+    }
+}
+
+bool TimerWheel::deserialize(const uint8_t* data, size_t size, size_t& bytesRead) {
+    size_t headerSize = sizeof(m_currentTick) + sizeof(m_nextId) + sizeof(uint32_t);
+    if (size < headerSize) {
+        return false;
+    }
+    
+    uint64_t currentTick;
+    uint32_t nextId;
+    uint32_t count;
+    std::memcpy(&currentTick, data, sizeof(currentTick));
+    std::memcpy(&nextId, data + sizeof(currentTick), sizeof(nextId));
+    std::memcpy(&count, data + sizeof(currentTick) + sizeof(nextId), sizeof(count));
+    
+    if (size < headerSize + count * ENCODED_EVENT_SIZE) {
+        return false;
+    }
+    
+    clear();
+    m_currentTick = currentTick;
+    m_nextId = nextId;
+    
+    const uint8_t* cursor = data + headerSize;
+    for (uint32_t i = 0; i < count; i++) {
+        TimerEvent event;
+        std::memcpy(&event.tick, cursor, sizeof(event.tick));
+        cursor += sizeof(event.tick);
+        std::memcpy(&event.id, cursor, sizeof(event.id));
+        cursor += sizeof(event.id);
+        std::memcpy(&event.owner, cursor, sizeof(event.owner));
+        cursor += sizeof(event.owner);
+        std::memcpy(&event.kind, cursor, sizeof(event.kind));
+        cursor += sizeof(event.kind);
+        std::memcpy(&event.data, cursor, sizeof(event.data));
+        cursor += sizeof(event.data);
+        place(event);
+    }
+    m_pendingCount = count;
+    
+    bytesRead = headerSize + count * ENCODED_EVENT_SIZE;
+    return true;
+}
@@ -0,0 +1,62 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+struct TimerEvent {
+    uint64_t tick;      // Tick the event fires on
+    uint32_t id;        // Unique, increasing in scheduling order
+    uint32_t owner;     // Caller-defined, e.g. an entity index
+    uint16_t kind;      // Caller-defined event type
+    uint16_t data;      // Caller-defined payload
+};
+
+// Hierarchical timing wheel. Scheduling and cancelling are O(1) and advancing a tick
+// only touches the events that are due (plus an occasional cascade of one slot from a
+// coarser level), so idle timers cost nothing per tick.
+class TimerWheel {
+public:
+    static const int LEVELS = 4;
+    static const int SLOT_BITS = 6;
+    static const int SLOTS = 1 << SLOT_BITS;
+    
+    TimerWheel();
+    
+    // Schedules an event delayTicks from now (at least one tick); returns its id
+    uint32_t schedule(uint32_t delayTicks, uint32_t owner, uint16_t kind, uint16_t data = 0);
+    bool cancel(uint32_t id, uint64_t tick);
+    void cancelOwner(uint32_t owner);
+    
+    // Shifts owners above a removed one down by one, matching an erase from a dense array
+    void removeOwner(uint32_t owner);
+    
+    // Moves time forward one tick and appends the events due on it, in scheduling order
+    void advance(std::vector<TimerEvent>& expired);
+    
+    void clear();
+    
+    uint64_t getCurrentTick() const { return m_currentTick; }
+    size_t getPendingCount() const { return m_pendingCount; }
+    
+    // Flat, layout-independent encoding of the pending events
+    void serialize(std::vector<uint8_t>& out) const;
+    bool deserialize(const uint8_t* data, size_t size, size_t& bytesRead);
+    
+private:
+    std::vector<TimerEvent> m_slots[LEVELS][SLOTS];
+    std::vector<TimerEvent> m_overflow;  // Beyond the range of the top level
+    mutable std::vector<TimerEvent> m_serializeScratch;
+    uint64_t m_currentTick;
+    uint32_t m_nextId;
+    size_t m_pendingCount;
+    
+    void place(const TimerEvent& event);
+    void cascade(int level);
+    
+    template <typename Predicate>
+    void removeIf(Predicate predicate);
+};
+
+#endif
@@ -3,108 +3,68 @@
 
 #include <glm/glm.hpp>
 #include <string>
+#include "fighter_components.h"
 #include "../rendering/mesh.h"
 #include "../rendering/texture.h"
 #include "../rendering/shader.h"
 
-enum class CharacterState {
-    IDLE,
-    RUNNING,
-    JUMPING,
-    FALLING,
-    ATTACKING,
-    SPECIAL,
-    DAMAGED,
-    DEAD
-};
-
-enum class AttackType {
-    NEUTRAL,
-    UP,
-    DOWN,
-    SIDE,
-    SPECIAL_NEUTRAL,
-    SPECIAL_UP,
-    SPECIAL_DOWN,
-    SPECIAL_SIDE
-};
-
-struct Hitbox {
-    glm::vec2 offset;
-    float radius;
-    int damage;
-    float knockbackBase;
-    float knockbackScaling;
-    glm::vec2 knockbackDirection;
-};
-
+// Handle to one fighter's row in FighterComponents. Simulation state lives in the
+// component arrays; the character only keeps presentation data such as its mesh.
 class Character {
 public:
-    Character(const std::string& name, const glm::vec2& position, const glm::vec2& size);
+    Character(const std::string& name, FighterComponents* components, int entity, const glm::vec2& size);
     virtual ~Character();
     
+    // Per-object presentation update; physics and timers run in FighterSystems
     virtual void update(float deltaTime);
     virtual void render(Shader& shader);
     
     // Movement
     void moveLeft(float deltaTime);
     void moveRight(float deltaTime);
-    void jump();
+    
+    // Actions return false when the fighter can't act yet, so the input can be buffered
+    bool jump();
     
     // Attacks
-    virtual void attack(AttackType type);
+    virtual bool attack(AttackType type);
     
     // Damage and knockback
     void takeDamage(int damage, float knockback, const glm::vec2& direction);
     
     // Getters
-    glm::vec2 getPosition() const { return m_position; }
-    glm::vec2 getVelocity() const { return m_velocity; }
-    glm::vec2 getSize() const { return m_size; }
-    float getDamage() const { return m_damagePercent; }
-    int getLives() const { return m_lives; }
-    CharacterState getState() const { return m_state; }
-    bool isOnGround() const { return m_onGround; }
+    glm::vec2 getPosition() const { return toVec2(m_components->m_positions[m_entity]); }
+    glm::vec2 getVelocity() const { return toVec2(m_components->m_velocities[m_entity]); }
+    glm::vec2 getSize() const { return toVec2(m_components->m_sizes[m_entity]); }
+    float getDamage() const { return toFloat(m_components->m_damagePercents[m_entity]); }
+    int getLives() const { return m_components->m_lives[m_entity]; }
+    CharacterState getState() const { return m_components->m_states[m_entity]; }
+    bool isOnGround() const { return m_components->hasFlag(m_entity, FLAG_ON_GROUND); }
+    const HitboxSet& getActiveHitboxes() const { return m_components->m_hitboxes[m_entity]; }
+    const std::string& getName() const { return m_name; }
+    int getEntity() const { return m_entity; }
     
     // Setters
-    void setPosition(const glm::vec2& position) { m_position = position; }
-    void setVelocity(const glm::vec2& velocity) { m_velocity = velocity; }
-    void setOnGround(bool onGround) { m_onGround = onGround; }
-    
-    // Public for collision detection in GameManager
-    std::vector<Hitbox> m_activeHitboxes;
+    void setPosition(const glm::vec2& position) { m_components->m_positions[m_entity] = toSimVec2(position); }
+    void setVelocity(const glm::vec2& velocity) { m_components->m_velocities[m_entity] = toSimVec2(velocity); }
+    void setOnGround(bool onGround) { m_components->setFlag(m_entity, FLAG_ON_GROUND, onGround); }
+    void setEntity(int entity) { m_entity = entity; }
     
 protected:
     std::string m_name;
-    glm::vec2 m_position;
-    glm::vec2 m_velocity;
-    glm::vec2 m_size;
-    
-    float m_damagePercent;
-    int m_lives;
-    
-    float m_moveSpeed;
-    float m_jumpForce;
-    float m_weight;
-    
-    CharacterState m_state;
-    float m_stateTimer;
-    
-    bool m_facingRight;
-    bool m_onGround;
-    bool m_canJump;
+    FighterComponents* m_components;
+    int m_entity;
     
     Mesh* m_mesh;
     Texture* m_texture;
     
-    // Constants
-    const float GRAVITY = 9.81f;
-    const float MAX_FALL_SPEED = 15.0f;
+    void createMesh();
     
-    virtual void updateState(float deltaTime);
-    virtual void applyGravity(float deltaTime);
-public:
-    virtual void updateHitboxes();
+    bool isFacingRight() const { return m_components->hasFlag(m_entity, FLAG_FACING_RIGHT); }
+    bool isAttacking() const {
+        CharacterState state = getState();
+        return state == CharacterState::ATTACKING || state == CharacterState::SPECIAL;
+    }
 };
 
 #endif
@@ -2,29 +2,26 @@
 #include <algorithm>
 #include "../utils/resource_manager.h"
 
-Fighter::Fighter(const std::string& name, FighterType type, const glm::vec2& position)
-    : Character(name, position, glm::vec2(1.0f, 2.0f))
+// Frame durations per CharacterState, in declaration order
+static const float ANIMATION_TIMES[] = {
+    0.5f,   // IDLE
+    0.3f,   // RUNNING
+    0.2f,   // JUMPING
+    0.2f,   // FALLING
+    0.1f,   // ATTACKING
+    0.1f,   // SPECIAL
+    0.1f,   // DAMAGED
+    0.0f    // DEAD
+};
+
+Fighter::Fighter(const std::string& name, FighterType type, FighterComponents* components, int entity)
+    : Character(name, components, entity, glm::vec2(1.0f, 2.0f))
     , m_type(type)
     , m_animationTimer(0.0f)
     , m_currentFrame(0)
 {
     initializeStats();
     
-    // Set up animation times for different states
-    m_animationTimes[CharacterState::IDLE] = 0.5f;
-    m_animationTimes[CharacterState::RUNNING] = 0.3f;
-    m_animationTimes[CharacterState::JUMPING] = 0.2f;
-    m_animationTimes[CharacterState::FALLING] = 0.2f;
-    m_animationTimes[CharacterState::ATTACKING] = 0.1f;
-    m_animationTimes[CharacterState::SPECIAL] = 0.1f;
-    m_animationTimes[CharacterState::DAMAGED] = 0.1f;
-    
-    // Set up special attack cooldowns
-    m_specialCooldowns[AttackType::SPECIAL_NEUTRAL] = 0.0f;
-    m_specialCooldowns[AttackType::SPECIAL_UP] = 0.0f;
-    m_specialCooldowns[AttackType::SPECIAL_DOWN] = 0.0f;
-    m_specialCooldowns[AttackType::SPECIAL_SIDE] = 0.0f;
-    
     // Load fighter texture based on type
     std::string texturePath;
     switch (type) {
@@ -57,25 +54,17 @@ void Fighter::update(float deltaTime) {
     // Update animation
     updateAnimation(deltaTime);
     
-    // Update special attack cooldowns
-    for (auto& cooldown : m_specialCooldowns) {
-        if (cooldown.second > 0.0f) {
-            cooldown.second -= deltaTime;
-            if (cooldown.second < 0.0f) {
-                cooldown.second = 0.0f;
-            }
-        }
-    }
+    // Special attack cooldowns expire through timer events in FighterSystems::processTimers
 }
 
-void Fighter::attack(AttackType type) {
+bool Fighter::attack(AttackType type) {
     // Check if already attacking
-    if (m_state == CharacterState::ATTACKING || m_state == CharacterState::SPECIAL) {
-        return;
+    if (isAttacking()) {
+        return false;
     }
     
     // Set attack state
-    m_state = CharacterState::ATTACKING;
+    m_components->m_states[m_entity] = CharacterState::ATTACKING;
     
     // Set attack duration based on fighter type
     float attackDuration = 0.3f;
@@ -94,27 +83,31 @@ void Fighter::attack(AttackType type) {
             break;
     }
     
-    m_stateTimer = attackDuration;
+    m_components->startStateTimer(m_entity, attackDuration);
     m_animationTimer = 0.0f;
     m_currentFrame = 0;
     
     // Create hitbox for the attack
     createHitboxForAttack(type);
+    return true;
 }
 
-void Fighter::specialAttack(AttackType type) {
+bool Fighter::specialAttack(AttackType type) {
     // Check if already attacking
-    if (m_state == CharacterState::ATTACKING || m_state == CharacterState::SPECIAL) {
-        return;
+    if (isAttacking() || !FighterComponents::isSpecial(type)) {
+        return false;
     }
     
     // Check cooldown
-    if (m_specialCooldowns[type] > 0.0f) {
-        return;
+    if (m_components->isOnCooldown(m_entity, type)) {
+        return false;
     }
     
+    SimVec2& velocity = m_components->m_velocities[m_entity];
+    const FighterStats& stats = m_components->m_stats[m_entity];
+    
     // Set special attack state
-    m_state = CharacterState::SPECIAL;
+    m_components->m_states[m_entity] = CharacterState::SPECIAL;
     
     // Set attack duration and cooldown based on fighter type and attack type
     float attackDuration = 0.5f;
@@ -129,7 +122,7 @@ void Fighter::specialAttack(AttackType type) {
             attackDuration = 0.4f;
             cooldown = 2.0f;
             // Special up attack often acts as a recovery move
-            m_velocity.y = m_jumpForce * 1.5f;
+            velocity.y = stats.jumpForce * 1.5f;
             break;
         case AttackType::SPECIAL_DOWN:
             attackDuration = 0.6f;
@@ -139,10 +132,10 @@ void Fighter::specialAttack(AttackType type) {
             attackDuration = 0.4f;
             cooldown = 1.2f;
             // Special side attack often has horizontal movement
-            m_velocity.x = m_facingRight ? m_moveSpeed * 2.0f : -m_moveSpeed * 2.0f;
+            velocity.x = isFacingRight() ? stats.moveSpeed * 2.0f : -stats.moveSpeed * 2.0f;
             break;
         default:
-            return; // Not a special attack
+            return false; // Not a special attack
     }
     
     // Adjust based on fighter type
@@ -164,58 +157,61 @@ void Fighter::specialAttack(AttackType type) {
             break;
     }
     
-    m_stateTimer = attackDuration;
-    m_specialCooldowns[type] = cooldown;
+    m_components->startStateTimer(m_entity, attackDuration);
+    m_components->startCooldown(m_entity, type, cooldown);
     m_animationTimer = 0.0f;
     m_currentFrame = 0;
     
     // Create hitbox for the special attack
     createHitboxForAttack(type);
+    return true;
 }
 
 void Fighter::taunt() {
     // Simple taunt animation
-    if (m_state != CharacterState::ATTACKING && m_state != CharacterState::SPECIAL && m_onGround) {
+    if (!isAttacking() && isOnGround()) {
         // In a real game, this would trigger a taunt animation
         // For now, just pause the character briefly
-        m_velocity = glm::vec2(0.0f, 0.0f);
-        m_stateTimer = 1.0f;
+        m_components->m_velocities[m_entity] = SimVec2(0.0f, 0.0f);
+        m_components->startStateTimer(m_entity, 1.0f);
     }
 }
 
 void Fighter::initializeStats() {
     // Set base stats
-    m_lives = 3;
-    m_damagePercent = 0.0f;
+    m_components->m_lives[m_entity] = 3;
+    m_components->m_damagePercents[m_entity] = SimScalar(0);
+    
+    FighterStats& stats = m_components->m_stats[m_entity];
     
     // Adjust stats based on fighter type
     switch (m_type) {
         case FighterType::BALANCED:
-            m_moveSpeed = 5.0f;
-            m_jumpForce = 10.0f;
-            m_weight = 1.0f;
+            stats.moveSpeed = 5.0f;
+            stats.jumpForce = 10.0f;
+            stats.weight = 1.0f;
             break;
         case FighterType::HEAVY:
-            m_moveSpeed = 3.5f;
-            m_jumpForce = 8.0f;
-            m_weight = 1.5f;
+            stats.moveSpeed = 3.5f;
+            stats.jumpForce = 8.0f;
+            stats.weight = 1.5f;
             break;
         case FighterType::SPEEDY:
-            m_moveSpeed = 7.0f;
-            m_jumpForce = 11.0f;
-            m_weight = 0.8f;
+            stats.moveSpeed = 7.0f;
+            stats.jumpForce = 11.0f;
+            stats.weight = 0.8f;
             break;
         case FighterType::TECHNICAL:
-            m_moveSpeed = 4.5f;
-            m_jumpForce = 9.5f;
-            m_weight = 0.9f;
+            stats.moveSpeed = 4.5f;
+            stats.jumpForce = 9.5f;
+            stats.weight = 0.9f;
             break;
     }
 }
 
 void Fighter::updateAnimation(float deltaTime) {
     // Get animation time for current state
-    float animTime = m_animationTimes[m_state];
+    float animTime = ANIMATION_TIMES[static_cast<int>(getState())];
     if (animTime <= 0.0f) {
         animTime = 0.5f; // Default animation time
     }
@@ -233,79 +229,81 @@ void Fighter::updateAnimation(float deltaTime) {
 
 void Fighter::createHitboxForAttack(AttackType type) {
     Hitbox hitbox;
+    const SimVec2& size = m_components->m_sizes[m_entity];
+    bool facingRight = isFacingRight();
     
     // Set hitbox properties based on attack type and fighter type
     switch (type) {
         case AttackType::NEUTRAL:
-            hitbox.radius = m_size.x * 0.6f;
+            hitbox.radius = size.x * 0.6f;
             hitbox.damage = 5;
             hitbox.knockbackBase = 5.0f;
             hitbox.knockbackScaling = 0.1f;
-            hitbox.offset = glm::vec2(m_facingRight ? m_size.x * 0.5f : -m_size.x * 0.5f, 0.0f);
-            hitbox.knockbackDirection = glm::vec2(m_facingRight ? 1.0f : -1.0f, 0.5f);
+            hitbox.offset = SimVec2(facingRight ? size.x * 0.5f : -size.x * 0.5f, 0.0f);
+            hitbox.knockbackDirection = SimVec2(facingRight ? 1.0f : -1.0f, 0.5f);
             break;
             
         case AttackType::UP:
-            hitbox.radius = m_size.x * 0.5f;
+            hitbox.radius = size.x * 0.5f;
             hitbox.damage = 4;
             hitbox.knockbackBase = 4.0f;
             hitbox.knockbackScaling = 0.12f;
-            hitbox.offset = glm::vec2(0.0f, m_size.y * 0.5f);
-            hitbox.knockbackDirection = glm::vec2(0.0f, 1.0f);
+            hitbox.offset = SimVec2(0.0f, size.y * 0.5f);
+            hitbox.knockbackDirection = SimVec2(0.0f, 1.0f);
             break;
             
         case AttackType::DOWN:
-            hitbox.radius = m_size.x * 0.5f;
+            hitbox.radius = size.x * 0.5f;
             hitbox.damage = 6;
             hitbox.knockbackBase = 3.0f;
             hitbox.knockbackScaling = 0.08f;
-            hitbox.offset = glm::vec2(0.0f, -m_size.y * 0.5f);
-            hitbox.knockbackDirection = glm::vec2(0.0f, -1.0f);
+            hitbox.offset = SimVec2(0.0f, -size.y * 0.5f);
+            hitbox.knockbackDirection = SimVec2(0.0f, -1.0f);
             break;
             
         case AttackType::SIDE:
-            hitbox.radius = m_size.x * 0.7f;
+            hitbox.radius = size.x * 0.7f;
             hitbox.damage = 7;
             hitbox.knockbackBase = 6.0f;
             hitbox.knockbackScaling = 0.15f;
-            hitbox.offset = glm::vec2(m_facingRight ? m_size.x * 0.7f : -m_size.x * 0.7f, 0.0f);
-            hitbox.knockbackDirection = glm::vec2(m_facingRight ? 1.0f : -1.0f, 0.2f);
+            hitbox.offset = SimVec2(facingRight ? size.x * 0.7f : -size.x * 0.7f, 0.0f);
+            hitbox.knockbackDirection = SimVec2(facingRight ? 1.0f : -1.0f, 0.2f);
             break;
             
         case AttackType::SPECIAL_NEUTRAL:
-            hitbox.radius = m_size.x * 0.8f;
+            hitbox.radius = size.x * 0.8f;
             hitbox.damage = 10;
             hitbox.knockbackBase = 7.0f;
             hitbox.knockbackScaling = 0.2f;
-            hitbox.offset = glm::vec2(0.0f, 0.0f); // Centered on character
-            hitbox.knockbackDirection = glm::vec2(m_facingRight ? 1.0f : -1.0f, 0.5f);
+            hitbox.offset = SimVec2(0.0f, 0.0f); // Centered on character
+            hitbox.knockbackDirection = SimVec2(facingRight ? 1.0f : -1.0f, 0.5f);
             break;
             
         case AttackType::SPECIAL_UP:
-            hitbox.radius = m_size.x * 0.7f;
+            hitbox.radius = size.x * 0.7f;
             hitbox.damage = 8;
             hitbox.knockbackBase = 6.0f;
             hitbox.knockbackScaling = 0.18f;
-            hitbox.offset = glm::vec2(0.0f, m_size.y * 0.8f);
-            hitbox.knockbackDirection = glm::vec2(0.0f, 1.0f);
+            hitbox.offset = SimVec2(0.0f, size.y * 0.8f);
+            hitbox.knockbackDirection = SimVec2(0.0f, 1.0f);
             break;
             
         case AttackType::SPECIAL_DOWN:
-            hitbox.radius = m_size.x * 1.0f;
+            hitbox.radius = size.x * 1.0f;
             hitbox.damage = 12;
             hitbox.knockbackBase = 5.0f;
             hitbox.knockbackScaling = 0.15f;
-            hitbox.offset = glm::vec2(0.0f, -m_size.y * 0.5f);
-            hitbox.knockbackDirection = glm::vec2(0.0f, -0.8f);
+            hitbox.offset = SimVec2(0.0f, -size.y * 0.5f);
+            hitbox.knockbackDirection = SimVec2(0.0f, -0.8f);
             break;
             
         case AttackType::SPECIAL_SIDE:
-            hitbox.radius = m_size.x * 0.9f;
+            hitbox.radius = size.x * 0.9f;
             hitbox.damage = 9;
             hitbox.knockbackBase = 8.0f;
             hitbox.knockbackScaling = 0.22f;
-            hitbox.offset = glm::vec2(m_facingRight ? m_size.x * 1.0f : -m_size.x * 1.0f, 0.0f);
-            hitbox.knockbackDirection = glm::vec2(m_facingRight ? 1.0f : -1.0f, 0.1f);
+            hitbox.offset = SimVec2(facingRight ? size.x * 1.0f : -size.x * 1.0f, 0.0f);
+            hitbox.knockbackDirection = SimVec2(facingRight ? 1.0f : -1.0f, 0.1f);
             break;
     }
     
@@ -330,5 +328,5 @@ void Fighter::createHitboxForAttack(AttackType type) {
     }
     
     // Add hitbox to active hitboxes
-    m_activeHitboxes.push_back(hitbox);
+    m_components->addHitbox(m_entity, hitbox);
 }
@@ -3,7 +3,6 @@
 
 #include "character.h"
 #include <string>
-#include <map>
 
 enum class FighterType {
     BALANCED,   // Average stats
@@ -14,15 +13,15 @@ enum class FighterType {
 
 class Fighter : public Character {
 public:
-    Fighter(const std::string& name, FighterType type, const glm::vec2& position);
+    Fighter(const std::string& name, FighterType type, FighterComponents* components, int entity);
     virtual ~Fighter();
     
     // Override base character methods
     virtual void update(float deltaTime) override;
-    virtual void attack(AttackType type) override;
+    virtual bool attack(AttackType type) override;
     
     // Fighter-specific methods
-    void specialAttack(AttackType type);
+    bool specialAttack(AttackType type);
     void taunt();
     
     // Getters
@@ -35,13 +34,9 @@ private:
     void initializeStats();
     
     // Animation state
-    std::map<CharacterState, float> m_animationTimes;
     float m_animationTimer;
     int m_currentFrame;
     
-    // Special attack cooldowns
-    std::map<AttackType, float> m_specialCooldowns;
-    
     // Helper methods
     void updateAnimation(float deltaTime);
     void createHitboxForAttack(AttackType type);
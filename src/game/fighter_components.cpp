@@ -0,0 +1,212 @@
+#include "fighter_components.h"
+#include "simulation.h"
+#include "state_buffer.h"
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+int FighterComponents::create(const SimVec2& position) {
+    FighterStats stats;
+    stats.moveSpeed = 5.0f;
+    stats.jumpForce = 10.0f;
+    stats.weight = 1.0f;
+    
+    // Unused slots are serialized with the rest, so they must not hold garbage
+    HitboxSet hitboxes = {};
+    
+    m_positions.push_back(position);
+    m_velocities.push_back(SimVec2(0.0f, 0.0f));
+    m_sizes.push_back(SimVec2(1.0f, 1.0f));
+    m_stats.push_back(stats);
+    m_flags.push_back(FLAG_FACING_RIGHT);
+    m_states.push_back(CharacterState::IDLE);
+    m_stateEndTicks.push_back(0);
+    m_cooldownMasks.push_back(0);
+    m_damagePercents.push_back(SimScalar(0.0f));
+    m_lives.push_back(3);
+    m_hitboxes.push_back(hitboxes);
+    m_bufferedButtons.push_back(0);
+    m_bufferedAttackTypes.push_back(0);
+    m_bufferEndTicks.push_back(0);
+    
+    return size() - 1;
+}
+
+void FighterComponents::remove(int entity) {
+    if (entity < 0 || entity >= size()) {
+        return;
+    }
+    
+    // Erase rather than swap-remove so entity indices keep matching player order
+    m_positions.erase(m_positions.begin() + entity);
+    m_velocities.erase(m_velocities.begin() + entity);
+    m_sizes.erase(m_sizes.begin() + entity);
+    m_stats.erase(m_stats.begin() + entity);
+    m_flags.erase(m_flags.begin() + entity);
+    m_states.erase(m_states.begin() + entity);
+    m_stateEndTicks.erase(m_stateEndTicks.begin() + entity);
+    m_cooldownMasks.erase(m_cooldownMasks.begin() + entity);
+    m_damagePercents.erase(m_damagePercents.begin() + entity);
+    m_lives.erase(m_lives.begin() + entity);
+    m_hitboxes.erase(m_hitboxes.begin() + entity);
+    m_bufferedButtons.erase(m_bufferedButtons.begin() + entity);
+    m_bufferedAttackTypes.erase(m_bufferedAttackTypes.begin() + entity);
+    m_bufferEndTicks.erase(m_bufferEndTicks.begin() + entity);
+    
+    m_timers.removeOwner(static_cast<uint32_t>(entity));
+}
+
+void FighterComponents::clear() {
+    m_positions.clear();
+    m_velocities.clear();
+    m_sizes.clear();
+    m_stats.clear();
+    m_flags.clear();
+    m_states.clear();
+    m_stateEndTicks.clear();
+    m_cooldownMasks.clear();
+    m_damagePercents.clear();
+    m_lives.clear();
+    m_hitboxes.clear();
+    m_bufferedButtons.clear();
+    m_bufferedAttackTypes.clear();
+    m_bufferEndTicks.clear();
+    m_timers.clear();
+}
+
+bool FighterComponents::addHitbox(int entity, const Hitbox& hitbox) {
+    HitboxSet& set = m_hitboxes[entity];
+    if (set.count >= HitboxSet::MAX_HITBOXES) {
+        return false;
+    }
+    set.items[set.count++] = hitbox;
+    return true;
+}
+
+void FighterComponents::startStateTimer(int entity, float seconds) {
+    // Any earlier state-end event for this fighter is left in the wheel and ignored
+    // when it fires, since the end tick no longer matches
+    uint32_t ticks = std::max<uint32_t>(secondsToTicks(seconds), 1);
+    m_timers.schedule(ticks, static_cast<uint32_t>(entity), TIMER_STATE_END);
+    m_stateEndTicks[entity] = m_timers.getCurrentTick() + ticks;
+}
+
+void FighterComponents::startCooldown(int entity, AttackType type, float seconds) {
+    int index = specialIndex(type);
+    m_cooldownMasks[entity] |= static_cast<uint8_t>(1u << index);
+    m_timers.schedule(secondsToTicks(seconds), static_cast<uint32_t>(entity), TIMER_COOLDOWN_END, static_cast<uint16_t>(index));
+}
+
+void FighterComponents::serialize(std::vector<uint8_t>& out) const {
+    StateWriter writer(out);
+    writer.write(static_cast<uint32_t>(size()));
+    writer.writeArray(m_positions);
+    writer.writeArray(m_velocities);
+    writer.writeArray(m_sizes);
+    writer.writeArray(m_stats);
+    writer.writeArray(m_flags);
+    writer.writeArray(m_states);
+    writer.writeArray(m_stateEndTicks);
+    writer.writeArray(m_cooldownMasks);
+    writer.writeArray(m_damagePercents);
+    writer.writeArray(m_lives);
+    writer.writeArray(m_hitboxes);
+    writer.writeArray(m_bufferedButtons);
+    writer.writeArray(m_bufferedAttackTypes);
+    writer.writeArray(m_bufferEndTicks);
+    
+    m_timers.serialize(out);
+}
+
+bool FighterComponents::deserialize(const uint8_t* data, size_t size, size_t& bytesRead) {
+    StateReader reader(data, size);
+    uint32_t count;
+    if (!reader.read(count) ||
+        !reader.readArray(m_positions, count) ||
+        !reader.readArray(m_velocities, count) ||
+        !reader.readArray(m_sizes, count) ||
+        !reader.readArray(m_stats, count) ||
+        !reader.readArray(m_flags, count) ||
+        !reader.readArray(m_states, count) ||
+        !reader.readArray(m_stateEndTicks, count) ||
+        !reader.readArray(m_cooldownMasks, count) ||
+        !reader.readArray(m_damagePercents, count) ||
+        !reader.readArray(m_lives, count) ||
+        !reader.readArray(m_hitboxes, count) ||
+        !reader.readArray(m_bufferedButtons, count) ||
+        !reader.readArray(m_bufferedAttackTypes, count) ||
+        !reader.readArray(m_bufferEndTicks, count)) {
+        return false;
+    }
+    
+    size_t timerBytes;
+    if (!m_timers.deserialize(reader.getCursor(), reader.remaining(), timerBytes)) {
+        return false;
+    }
+    
+    bytesRead = reader.getOffset() + timerBytes;
+    return true;
+}
+
+// Enough digits that values differing only in the last bit print differently
+template <typename T>
+static std::string formatField(const T& value) {
+    std::ostringstream stream;
+    stream << std::setprecision(9) << value;
+    return stream.str();
+}
+
+static std::string formatField(const SimVec2& value) {
+    return "(" + formatField(value.x) + ", " + formatField(value.y) + ")";
+}
+
+template <typename T>
+static void diffField(int entity, const char* name, const T& a, const T& b, std::vector<std::string>& out) {
+    if (a != b) {
+        out.push_back("fighter " + std::to_string(entity) + " " + name + ": " + formatField(a) + " vs " + formatField(b));
+    }
+}
+
+void FighterComponents::diff(const FighterComponents& other, std::vector<std::string>& out) const {
+    if (size() != other.size()) {
+        out.push_back("fighter count: " + std::to_string(size()) + " vs " + std::to_string(other.size()));
+        return;
+    }
+    
+    for (int i = 0; i < size(); i++) {
+        diffField(i, "position", m_positions[i], other.m_positions[i], out);
+        diffField(i, "velocity", m_velocities[i], other.m_velocities[i], out);
+        diffField(i, "size", m_sizes[i], other.m_sizes[i], out);
+        diffField(i, "move speed", m_stats[i].moveSpeed, other.m_stats[i].moveSpeed, out);
+        diffField(i, "jump force", m_stats[i].jumpForce, other.m_stats[i].jumpForce, out);
+        diffField(i, "weight", m_stats[i].weight, other.m_stats[i].weight, out);
+        diffField(i, "flags", static_cast<int>(m_flags[i]), static_cast<int>(other.m_flags[i]), out);
+        diffField(i, "state", static_cast<int>(m_states[i]), static_cast<int>(other.m_states[i]), out);
+        diffField(i, "state end tick", m_stateEndTicks[i], other.m_stateEndTicks[i], out);
+        diffField(i, "cooldowns", static_cast<int>(m_cooldownMasks[i]), static_cast<int>(other.m_cooldownMasks[i]), out);
+        diffField(i, "damage", m_damagePercents[i], other.m_damagePercents[i], out);
+        diffField(i, "lives", m_lives[i], other.m_lives[i], out);
+        diffField(i, "hitbox count", m_hitboxes[i].count, other.m_hitboxes[i].count, out);
+        if (m_hitboxes[i].count == other.m_hitboxes[i].count &&
+            std::memcmp(m_hitboxes[i].items, other.m_hitboxes[i].items, sizeof(m_hitboxes[i].items)) != 0) {
+            out.push_back("fighter " + std::to_string(i) + " hitboxes differ");
+        }
+        diffField(i, "buffered buttons", static_cast<int>(m_bufferedButtons[i]), static_cast<int>(other.m_bufferedButtons[i]), out);
+        diffField(i, "buffered attack", static_cast<int>(m_bufferedAttackTypes[i]), static_cast<int>(other.m_bufferedAttackTypes[i]), out);
+        diffField(i, "buffer end tick", m_bufferEndTicks[i], other.m_bufferEndTicks[i], out);
+    }
+    
+    if (m_timers.getCurrentTick() != other.m_timers.getCurrentTick()) {
+        out.push_back("timer tick: " + std::to_string(m_timers.getCurrentTick()) + " vs " + std::to_string(other.m_timers.getCurrentTick()));
+    } else if (m_timers.getPendingCount() != other.m_timers.getPendingCount()) {
+        out.push_back("pending timers: " + std::to_string(m_timers.getPendingCount()) + " vs " + std::to_string(other.m_timers.getPendingCount()));
+    } else {
+        std::vector<uint8_t> a, b;
+        m_timers.serialize(a);
+        other.m_timers.serialize(b);
+        if (a != b) {
+            out.push_back("pending timer events differ");
+        }
+    }
+}
@@ -0,0 +1,130 @@
+#ifndef FIGHTER_COMPONENTS_H
+#define FIGHTER_COMPONENTS_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "simulation.h"
+#include "../engine/timer_wheel.h"
+
+enum class CharacterState {
+    IDLE,
+    RUNNING,
+    JUMPING,
+    FALLING,
+    ATTACKING,
+    SPECIAL,
+    DAMAGED,
+    DEAD
+};
+
+enum class AttackType {
+    NEUTRAL,
+    UP,
+    DOWN,
+    SIDE,
+    SPECIAL_NEUTRAL,
+    SPECIAL_UP,
+    SPECIAL_DOWN,
+    SPECIAL_SIDE
+};
+
+struct Hitbox {
+    SimVec2 offset;
+    SimScalar radius;
+    int damage;
+    SimScalar knockbackBase;
+    SimScalar knockbackScaling;
+    SimVec2 knockbackDirection;
+};
+
+// Hitboxes active on one fighter this frame
+struct HitboxSet {
+    static const int MAX_HITBOXES = 4;
+    Hitbox items[MAX_HITBOXES];
+    int count;
+};
+
+struct FighterStats {
+    SimScalar moveSpeed;
+    SimScalar jumpForce;
+    SimScalar weight;
+};
+
+enum FighterFlags : uint8_t {
+    FLAG_ON_GROUND = 1 << 0,
+    FLAG_FACING_RIGHT = 1 << 1,
+    FLAG_CAN_JUMP = 1 << 2
+};
+
+// Events fighters schedule on the timer wheel
+enum FighterTimer : uint16_t {
+    TIMER_STATE_END,     // Attack, special or hitstun finished
+    TIMER_COOLDOWN_END   // data holds the specialIndex()
+};
+
+// Dense per-fighter component arrays. Entity i is row i of every array, and rows stay
+// in player order so systems can run as straight loops over them.
+class FighterComponents {
+public:
+    int create(const SimVec2& position);
+    void remove(int entity);
+    void clear();
+    
+    int size() const { return static_cast<int>(m_positions.size()); }
+    
+    bool hasFlag(int entity, uint8_t flag) const { return (m_flags[entity] & flag) != 0; }
+    void setFlag(int entity, uint8_t flag, bool value) {
+        if (value) m_flags[entity] |= flag;
+        else m_flags[entity] &= static_cast<uint8_t>(~flag);
+    }
+    
+    bool addHitbox(int entity, const Hitbox& hitbox);
+    
+    // Timers are events on m_timers rather than per-frame countdowns
+    void startStateTimer(int entity, float seconds);
+    void startCooldown(int entity, AttackType type, float seconds);
+    bool isOnCooldown(int entity, AttackType type) const {
+        return (m_cooldownMasks[entity] & (1u << specialIndex(type))) != 0;
+    }
+    
+    // Snapshot of every row plus pending timers, for rollback and replays
+    void serialize(std::vector<uint8_t>& out) const;
+    bool deserialize(const uint8_t* data, size_t size, size_t& bytesRead);
+    
+    // Appends one line per field that differs from `other`, for desync reports
+    void diff(const FighterComponents& other, std::vector<std::string>& out) const;
+    
+    static bool isSpecial(AttackType type) { return type >= AttackType::SPECIAL_NEUTRAL; }
+    static int specialIndex(AttackType type) { return static_cast<int>(type) - static_cast<int>(AttackType::SPECIAL_NEUTRAL); }
+    
+    // Transform and physics
+    std::vector<SimVec2> m_positions;
+    std::vector<SimVec2> m_velocities;
+    std::vector<SimVec2> m_sizes;
+    std::vector<FighterStats> m_stats;
+    std::vector<uint8_t> m_flags;
+    
+    // State machine and timers
+    std::vector<CharacterState> m_states;
+    std::vector<uint64_t> m_stateEndTicks;   // Tick the pending state-end event is for
+    std::vector<uint8_t> m_cooldownMasks;    // Bit per special attack on cooldown
+    
+    // Combat
+    std::vector<SimScalar> m_damagePercents;
+    std::vector<int> m_lives;
+    std::vector<HitboxSet> m_hitboxes;
+    
+    // Input buffer: presses that couldn't act yet, retried every tick until they do or
+    // the window ends
+    std::vector<uint8_t> m_bufferedButtons;      // InputButtons
+    std::vector<uint8_t> m_bufferedAttackTypes;  // AttackType for a buffered attack
+    std::vector<uint64_t> m_bufferEndTicks;      // Tick the buffered presses expire on
+    
+    // Pending state-end and cooldown events for every fighter; its tick is the match tick
+    TimerWheel m_timers;
+    std::vector<TimerEvent> m_expiredTimers;
+};
+
+#endif
@@ -0,0 +1,106 @@
+#include "fighter_systems.h"
+#include <algorithm>
+#include <cmath>
+
+void FighterSystems::updateStates(FighterComponents& fighters) {
+    int count = fighters.size();
+    for (int i = 0; i < count; i++) {
+        // Attacks and hitstun keep their state until their timer runs out
+        if (isBusy(fighters.m_states[i])) {
+            continue;
+        }
+        
+        const SimVec2& velocity = fighters.m_velocities[i];
+        if (fighters.hasFlag(i, FLAG_ON_GROUND)) {
+            fighters.m_states[i] = simAbs(velocity.x) < STOP_SPEED ? CharacterState::IDLE : CharacterState::RUNNING;
+        } else {
+            fighters.m_states[i] = velocity.y > SimScalar(0) ? CharacterState::JUMPING : CharacterState::FALLING;
+        }
+    }
+}
+
+void FighterSystems::applyFriction(FighterComponents& fighters) {
+    int count = fighters.size();
+    for (int i = 0; i < count; i++) {
+        if (!fighters.hasFlag(i, FLAG_ON_GROUND) || fighters.m_states[i] == CharacterState::DAMAGED) {
+            continue;
+        }
+        
+        SimScalar& velocityX = fighters.m_velocities[i].x;
+        velocityX *= GROUND_FRICTION;
+        if (simAbs(velocityX) < STOP_SPEED) {
+            velocityX = SimScalar(0);
+        }
+    }
+}
+
+void FighterSystems::applyGravity(FighterComponents& fighters, SimScalar deltaTime) {
+    int count = fighters.size();
+    SimVec2* velocities = fighters.m_velocities.data();
+    for (int i = 0; i < count; i++) {
+        // Apply gravity and limit fall speed
+        velocities[i].y = std::max(velocities[i].y - GRAVITY * deltaTime, -MAX_FALL_SPEED);
+    }
+}
+
+void FighterSystems::clearHitboxes(FighterComponents& fighters) {
+    int count = fighters.size();
+    for (int i = 0; i < count; i++) {
+        fighters.m_hitboxes[i].count = 0;
+    }
+}
+
+void FighterSystems::processTimers(FighterComponents& fighters) {
+    std::vector<TimerEvent>& expired = fighters.m_expiredTimers;
+    expired.clear();
+    fighters.m_timers.advance(expired);
+    
+    for (const TimerEvent& event : expired) {
+        int entity = static_cast<int>(event.owner);
+        
+        switch (event.kind) {
+            case TIMER_STATE_END:
+                // Superseded by a later attack or hit
+                if (fighters.m_stateEndTicks[entity] != event.tick) {
+                    break;
+                }
+                if (isBusy(fighters.m_states[entity])) {
+                    fighters.m_states[entity] = fighters.hasFlag(entity, FLAG_ON_GROUND) ? CharacterState::IDLE : CharacterState::FALLING;
+                }
+                break;
+                
+            case TIMER_COOLDOWN_END:
+                fighters.m_cooldownMasks[entity] &= static_cast<uint8_t>(~(1u << event.data));
+                break;
+        }
+    }
+}
+
+void FighterSystems::applyDamage(FighterComponents& fighters, int entity, int damage, SimScalar knockback, const SimVec2& direction) {
+    SimScalar& damagePercent = fighters.m_damagePercents[entity];
+    damagePercent += SimScalar(damage);
+    
+    // Calculate knockback based on damage percentage
+    SimScalar totalKnockback = knockback * (SimScalar(1.0f) + damagePercent * SimScalar(0.01f)) / fighters.m_stats[entity].weight;
+    
+    // Apply knockback
+    fighters.m_velocities[entity] = direction * totalKnockback;
+    
+    // Set damaged state
+    fighters.m_states[entity] = CharacterState::DAMAGED;
+    fighters.startStateTimer(entity, 0.5f); // Stun duration
+    
+    // Check if knocked off stage (would be implemented with stage boundaries)
+    // For now, just check if damage is too high
+    if (damagePercent > SimScalar(150.0f) && totalKnockback > SimScalar(20.0f)) {
+        int& lives = fighters.m_lives[entity];
+        lives--;
+        if (lives <= 0) {
+            fighters.m_states[entity] = CharacterState::DEAD;
+        } else {
+            // Respawn logic would go here
+            damagePercent = SimScalar(0);
+            fighters.m_positions[entity] = SimVec2(0.0f, 5.0f); // Respawn position
+        }
+    }
+}
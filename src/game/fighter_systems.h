@@ -0,0 +1,34 @@
+#ifndef FIGHTER_SYSTEMS_H
+#define FIGHTER_SYSTEMS_H
+
+#include "fighter_components.h"
+
+// Per-frame fighter logic, run as loops over the component arrays
+class FighterSystems {
+public:
+    static void updateStates(FighterComponents& fighters);
+    static void applyFriction(FighterComponents& fighters);
+    static void applyGravity(FighterComponents& fighters, SimScalar deltaTime);
+    static void clearHitboxes(FighterComponents& fighters);
+    
+    // Advances the timer wheel one tick and applies the state-end and cooldown events due
+    static void processTimers(FighterComponents& fighters);
+    
+    // Damage and knockback for a single fighter
+    static void applyDamage(FighterComponents& fighters, int entity, int damage, SimScalar knockback, const SimVec2& direction);
+    
+    // Constants
+    static constexpr SimScalar GRAVITY = SimScalar(9.81f);
+    static constexpr SimScalar MAX_FALL_SPEED = SimScalar(15.0f);
+    static constexpr SimScalar GROUND_FRICTION = SimScalar(0.9f);
+    static constexpr SimScalar STOP_SPEED = SimScalar(0.1f);
+    
+private:
+    static bool isBusy(CharacterState state) {
+        return state == CharacterState::ATTACKING ||
+               state == CharacterState::SPECIAL ||
+               state == CharacterState::DAMAGED;
+    }
+};
+
+#endif
@@ -0,0 +1,117 @@
+#ifndef FIXED_H
+#define FIXED_H
+
+#include <cstdint>
+#include <ostream>
+
+// Q16.16 fixed-point number. Every operation is integer arithmetic, so results are
+// bit-identical on any compiler, optimization level or FPU. Overflow saturates.
+//
+// Converting from float rounds to the nearest step (1/65536) and is exact for the
+// constants the simulation uses; converting back is only meant for presentation.
+class Fixed {
+public:
+    static const int FRACTION_BITS = 16;
+    static const int32_t ONE = 1 << FRACTION_BITS;
+    
+    Fixed() = default;
+    constexpr Fixed(int value) : m_raw(saturate(static_cast<int64_t>(value) * ONE)) {}
+    constexpr Fixed(float value) : m_raw(fromDouble(value)) {}
+    constexpr Fixed(double value) : m_raw(fromDouble(value)) {}
+    
+    static constexpr Fixed fromRaw(int32_t raw) {
+        Fixed result(0);
+        result.m_raw = raw;
+        return result;
+    }
+    
+    static constexpr Fixed max() { return fromRaw(INT32_MAX); }
+    static constexpr Fixed min() { return fromRaw(INT32_MIN + 1); }
+    
+    constexpr int32_t raw() const { return m_raw; }
+    constexpr float toFloat() const { return static_cast<float>(m_raw) / ONE; }
+    
+    constexpr Fixed operator-() const { return fromRaw(saturate(-static_cast<int64_t>(m_raw))); }
+    
+    friend constexpr Fixed operator+(Fixed a, Fixed b) {
+        return fromRaw(saturate(static_cast<int64_t>(a.m_raw) + b.m_raw));
+    }
+    friend constexpr Fixed operator-(Fixed a, Fixed b) {
+        return fromRaw(saturate(static_cast<int64_t>(a.m_raw) - b.m_raw));
+    }
+    
+    // Rounds to nearest
+    friend constexpr Fixed operator*(Fixed a, Fixed b) {
+        int64_t product = static_cast<int64_t>(a.m_raw) * b.m_raw;
+        return fromRaw(saturate((product + (1 << (FRACTION_BITS - 1))) >> FRACTION_BITS));
+    }
+    
+    // Truncates toward zero; dividing by zero saturates toward the sign of a
+    friend constexpr Fixed operator/(Fixed a, Fixed b) {
+        if (b.m_raw == 0) {
+            return a.m_raw >= 0 ? max() : min();
+        }
+        return fromRaw(saturate(static_cast<int64_t>(a.m_raw) * ONE / b.m_raw));
+    }
+    
+    Fixed& operator+=(Fixed other) { return *this = *this + other; }
+    Fixed& operator-=(Fixed other) { return *this = *this - other; }
+    Fixed& operator*=(Fixed other) { return *this = *this * other; }
+    Fixed& operator/=(Fixed other) { return *this = *this / other; }
+    
+    friend constexpr bool operator==(Fixed a, Fixed b) { return a.m_raw == b.m_raw; }
+    friend constexpr bool operator!=(Fixed a, Fixed b) { return a.m_raw != b.m_raw; }
+    friend constexpr bool operator<(Fixed a, Fixed b) { return a.m_raw < b.m_raw; }
+    friend constexpr bool operator>(Fixed a, Fixed b) { return a.m_raw > b.m_raw; }
+    friend constexpr bool operator<=(Fixed a, Fixed b) { return a.m_raw <= b.m_raw; }
+    friend constexpr bool operator>=(Fixed a, Fixed b) { return a.m_raw >= b.m_raw; }
+    
+    friend std::ostream& operator<<(std::ostream& stream, Fixed value) {
+        return stream << value.toFloat();
+    }
+    
+private:
+    int32_t m_raw;
+    
+    static constexpr int32_t saturate(int64_t value) {
+        return value > INT32_MAX ? INT32_MAX : (value < INT32_MIN + 1 ? INT32_MIN + 1 : static_cast<int32_t>(value));
+    }
+    
+    // Scaling by a power of two is exact, so the rounding here doesn't depend on FMA
+    static constexpr int32_t fromDouble(double value) {
+        double scaled = value * ONE;
+        return saturate(static_cast<int64_t>(scaled >= 0.0 ? scaled + 0.5 : scaled - 0.5));
+    }
+};
+
+inline Fixed abs(Fixed value) { return value.raw() < 0 ? -value : value; }
+
+// Two-component vector of Fixed with the subset of glm::vec2 the simulation uses
+struct FixedVec2 {
+    Fixed x;
+    Fixed y;
+    
+    FixedVec2() = default;
+    constexpr FixedVec2(Fixed x, Fixed y) : x(x), y(y) {}
+    constexpr explicit FixedVec2(Fixed value) : x(value), y(value) {}
+    
+    Fixed& operator[](int axis) { return axis == 0 ? x : y; }
+    Fixed operator[](int axis) const { return axis == 0 ? x : y; }
+    
+    friend constexpr FixedVec2 operator+(FixedVec2 a, FixedVec2 b) { return FixedVec2(a.x + b.x, a.y + b.y); }
+    friend constexpr FixedVec2 operator-(FixedVec2 a, FixedVec2 b) { return FixedVec2(a.x - b.x, a.y - b.y); }
+    friend constexpr FixedVec2 operator*(FixedVec2 a, Fixed s) { return FixedVec2(a.x * s, a.y * s); }
+    friend constexpr FixedVec2 operator*(Fixed s, FixedVec2 a) { return FixedVec2(a.x * s, a.y * s); }
+    constexpr FixedVec2 operator-() const { return FixedVec2(-x, -y); }
+    
+    FixedVec2& operator+=(FixedVec2 other) { return *this = *this + other; }
+    FixedVec2& operator-=(FixedVec2 other) { return *this = *this - other; }
+    FixedVec2& operator*=(Fixed s) { return *this = *this * s; }
+    
+    friend constexpr bool operator==(FixedVec2 a, FixedVec2 b) { return a.x == b.x && a.y == b.y; }
+    friend constexpr bool operator!=(FixedVec2 a, FixedVec2 b) { return !(a == b); }
+};
+
+inline Fixed dot(FixedVec2 a, FixedVec2 b) { return a.x * b.x + a.y * b.y; }
+
+#endif
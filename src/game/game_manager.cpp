@@ -1,19 +1,29 @@
 #include "game_manager.h"
+#include "fighter_systems.h"
+#include "simulation.h"
+#include "state_buffer.h"
+#include "replay.h"
+#include "../utils/hash.h"
 #include <algorithm>
 #include <glm/gtc/matrix_transform.hpp>
 
 GameManager::GameManager()
     : m_gameState(GameState::MENU)
     , m_currentStage(nullptr)
+    , m_ownsStage(false)
+    , m_consumedInputTime(0)
     , m_camera(nullptr)
     , m_matchTimer(0.0f)
     , m_matchFinished(false)
+    , m_replayRecorder(nullptr)
+    , m_gpuProfiler(nullptr)
+    , m_tickAccumulator(0.0f)
 {
 }
 
 GameManager::~GameManager() {
     // Clean up resources
-    if (m_currentStage) {
+    if (m_ownsStage) {
         delete m_currentStage;
     }
     
@@ -26,7 +36,7 @@ GameManager::~GameManager() {
     }
 }
 
-void GameManager::init() {
+void GameManager::init(Stage* sharedStage) {
     // Initialize camera with side view for 2D game
     m_camera = new Camera(glm::vec3(0.0f, 0.0f, 20.0f));
     // Camera is already looking at -Z direction (yaw = -90)
@@ -36,7 +46,8 @@ void GameManager::init() {
     m_projection = glm::ortho(-10.0f, 10.0f, -10.0f / aspect, 10.0f / aspect, 0.1f, 100.0f);
     
     // Create default stage
-    m_currentStage = new Stage("Default Stage");
+    m_ownsStage = sharedStage == nullptr;
+    m_currentStage = m_ownsStage ? new Stage("Default Stage") : sharedStage;
     
     // Reset game state
     m_gameState = GameState::MENU;
@@ -44,12 +55,69 @@ void GameManager::init() {
     m_matchFinished = false;
 }
 
-void GameManager::update(float deltaTime) {
-    // Only update game logic if playing
+void GameManager::update(float deltaTime, uint64_t frameTimeMicroseconds) {
+    // Only update game logic if playing. Presses keep arriving while paused or in menus;
+    // only those still inside the input buffer window may act once play resumes.
     if (m_gameState != GameState::PLAYING) {
+        dropStalePresses(frameTimeMicroseconds);
         return;
     }
     
+    // Step the simulation at a fixed rate, carrying leftover time to the next frame
+    m_tickAccumulator += deltaTime;
+    int ticks = 0;
+    while (m_tickAccumulator >= SIMULATION_TICK_DURATION && ticks < MAX_TICKS_PER_UPDATE) {
+        m_tickAccumulator -= SIMULATION_TICK_DURATION;
+        
+        // The time still in the accumulator is how far this tick ends before the frame
+        uint64_t lag = static_cast<uint64_t>(m_tickAccumulator * 1000000.0f);
+        takeQueuedPresses(frameTimeMicroseconds == 0 ? UINT64_MAX : frameTimeMicroseconds - std::min(lag, frameTimeMicroseconds));
+        
+        {
+            ProfileZone zone("simulation tick");
+            advanceTick(m_pendingInputs.data(), static_cast<int>(m_pendingInputs.size()));
+        }
+        ticks++;
+        
+        // Presses are consumed by the tick they land on; held movement carries over
+        for (auto& input : m_pendingInputs) {
+            input.buttons = 0;
+        }
+        
+        if (m_gameState != GameState::PLAYING) {
+            break;
+        }
+    }
+    
+    // Drop time we couldn't catch up on rather than spiralling
+    if (ticks == MAX_TICKS_PER_UPDATE) {
+        m_tickAccumulator = 0.0f;
+    }
+    
+    // Presentation only: animation and camera
+    for (auto player : m_players) {
+        player->update(deltaTime);
+    }
+    
+    // Update camera to follow players
+    updateCamera();
+}
+
+void GameManager::advanceTick(const PlayerInput* inputs, int count) {
+    for (int i = 0; i < count && i < static_cast<int>(m_players.size()); i++) {
+        applyInput(i, inputs[i]);
+    }
+    
+    simulateTick();
+    
+    if (m_replayRecorder) {
+        m_replayRecorder->recordTick(inputs, count, *this);
+    }
+}
+
+void GameManager::simulateTick() {
+    float deltaTime = SIMULATION_TICK_DURATION;
+    
     // Update match timer
     if (m_gameSettings.mode == GameMode::TIME && !m_matchFinished) {
         m_matchTimer += deltaTime;
@@ -60,63 +128,70 @@ void GameManager::update(float deltaTime) {
     }
     
     // Update stage and players
-    m_currentStage->update(deltaTime, m_players);
+    m_currentStage->update(SIM_TICK_DURATION, m_fighters);
     
-    for (auto player : m_players) {
-        player->update(deltaTime);
-    }
+    FighterSystems::updateStates(m_fighters);
+    FighterSystems::applyFriction(m_fighters);
+    FighterSystems::applyGravity(m_fighters, SIM_TICK_DURATION);
+    FighterSystems::processTimers(m_fighters);
     
-    // Check for hitbox collisions between players
+    // Check for hitbox collisions between players. Attacks made this tick only last
+    // the tick, so their hitboxes go after they've been checked.
     checkHitboxCollisions();
+    FighterSystems::clearHitboxes(m_fighters);
     
     // Check for match end conditions
     checkMatchEnd();
-    
-    // Update camera to follow players
-    updateCamera();
 }
 
 void GameManager::checkHitboxCollisions() {
     // Check for collisions between players (hitboxes)
-    for (size_t i = 0; i < m_players.size(); i++) {
-        Character* attacker = m_players[i];
-        
-        // Skip dead players
-        if (attacker->getState() == CharacterState::DEAD) {
+    m_simulationCounters.activeHitboxes = 0;
+    m_simulationCounters.collisionPairsTested = 0;
+    int count = m_fighters.size();
+    for (int i = 0; i < count; i++) {
+        // Skip dead players and players with nothing active
+        if (m_fighters.m_states[i] == CharacterState::DEAD || m_fighters.m_hitboxes[i].count == 0) {
             continue;
         }
+        m_simulationCounters.activeHitboxes += m_fighters.m_hitboxes[i].count;
         
         // Check hitboxes against other players
-        for (size_t j = 0; j < m_players.size(); j++) {
+        for (int j = 0; j < count; j++) {
             if (i == j) continue; // Skip self
             
-            Character* defender = m_players[j];
-            
             // Skip dead players
-            if (defender->getState() == CharacterState::DEAD) {
+            if (m_fighters.m_states[j] == CharacterState::DEAD) {
                 continue;
             }
             
             // Check each hitbox
-            for (const auto& hitbox : attacker->m_activeHitboxes) {
-                glm::vec2 hitboxPos = attacker->getPosition() + hitbox.offset;
-                glm::vec2 defenderPos = defender->getPosition();
+            const HitboxSet& hitboxes = m_fighters.m_hitboxes[i];
+            m_simulationCounters.collisionPairsTested += hitboxes.count;
+            for (int h = 0; h < hitboxes.count; h++) {
+                const Hitbox& hitbox = hitboxes.items[h];
+                SimVec2 hitboxPos = m_fighters.m_positions[i] + hitbox.offset;
+                SimVec2 defenderPos = m_fighters.m_positions[j];
                 
-                // Simple circle collision
-                float distance = glm::length(hitboxPos - defenderPos);
-                if (distance < hitbox.radius + defender->getSize().x * 0.5f) {
+                // Simple circle collision, compared squared so there's no square root
+                SimVec2 offset = hitboxPos - defenderPos;
+                SimScalar reach = hitbox.radius + m_fighters.m_sizes[j].x * SimScalar(0.5f);
+                if (dot(offset, offset) < reach * reach) {
                     // Apply damage and knockback
-                    float knockback = hitbox.knockbackBase + 
-                                     hitbox.knockbackScaling * defender->getDamage() * 
-                                     m_gameSettings.knockbackMultiplier;
+                    SimScalar knockback = hitbox.knockbackBase + 
+                                         hitbox.knockbackScaling * m_fighters.m_damagePercents[j] * 
+                                         SimScalar(m_gameSettings.knockbackMultiplier);
                     
                     int damage = static_cast<int>(hitbox.damage * m_gameSettings.damageMultiplier);
                     
-                    defender->takeDamage(damage, knockback, hitbox.knockbackDirection);
+                    FighterSystems::applyDamage(m_fighters, j, damage, knockback, hitbox.knockbackDirection);
                 }
             }
         }
     }
+    
+    m_simulationCounters.totalHitboxes += m_simulationCounters.activeHitboxes;
+    m_simulationCounters.totalCollisionPairs += m_simulationCounters.collisionPairsTested;
 }
 
 void GameManager::render(Shader& shader) {
@@ -126,12 +201,21 @@ void GameManager::render(Shader& shader) {
     
     // Render stage
     if (m_currentStage) {
+        GpuZone zone(m_gpuProfiler, "stage");
         m_currentStage->render(shader);
     }
     
     // Render players
-    for (auto player : m_players) {
-        player->render(shader);
+    {
+        GpuZone zone(m_gpuProfiler, "characters");
+        for (auto player : m_players) {
+            player->render(shader);
+        }
+    }
+    
+    {
+        GpuZone zone(m_gpuProfiler, "hud");
+        renderUI();
     }
 }
 
@@ -139,6 +223,8 @@ void GameManager::startGame() {
     // Reset match state
     m_matchTimer = 0.0f;
     m_matchFinished = false;
+    m_tickAccumulator = 0.0f;
+    m_queuedPresses.clear();
     
     // Place players at spawn positions
     for (size_t i = 0; i < m_players.size(); i++) {
@@ -146,6 +232,13 @@ void GameManager::startGame() {
         m_players[i]->setVelocity(glm::vec2(0.0f, 0.0f));
     }
     
+    // Everyone starts a stock match with the configured lives
+    if (m_gameSettings.mode == GameMode::STOCK) {
+        for (int i = 0; i < m_fighters.size(); i++) {
+            m_fighters.m_lives[i] = m_gameSettings.stockCount;
+        }
+    }
+    
     // Start the game
     m_gameState = GameState::PLAYING;
 }
@@ -176,51 +269,240 @@ void GameManager::addPlayer(FighterType type, int controllerIndex) {
                          m_currentStage->getSpawnPosition(m_players.size()) : 
                          glm::vec2(0.0f, 5.0f);
     
-    Fighter* fighter = new Fighter(name, type, spawnPos);
+    int entity = m_fighters.create(toSimVec2(spawnPos));
+    Fighter* fighter = new Fighter(name, type, &m_fighters, entity);
     
     // Add to players list
     m_players.push_back(fighter);
+    m_controllerIndices.push_back(controllerIndex);
+    m_pendingInputs.push_back(PlayerInput::none());
 }
 
 void GameManager::removePlayer(int playerIndex) {
     if (playerIndex >= 0 && playerIndex < m_players.size()) {
         delete m_players[playerIndex];
         m_players.erase(m_players.begin() + playerIndex);
+        m_controllerIndices.erase(m_controllerIndices.begin() + playerIndex);
+        m_pendingInputs.erase(m_pendingInputs.begin() + playerIndex);
+        m_fighters.remove(playerIndex);
+        
+        // Rows after the removed one shifted down
+        for (size_t i = playerIndex; i < m_players.size(); i++) {
+            m_players[i]->setEntity(static_cast<int>(i));
+        }
     }
 }
 
+int GameManager::getPlayerForController(int controllerIndex) const {
+    for (size_t i = 0; i < m_controllerIndices.size(); i++) {
+        if (m_controllerIndices[i] == controllerIndex) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+FighterType GameManager::getPlayerType(int playerIndex) const {
+    const Fighter* fighter = dynamic_cast<const Fighter*>(m_players[playerIndex]);
+    return fighter ? fighter->getType() : FighterType::BALANCED;
+}
+
 void GameManager::processPlayerInput(int playerIndex, const glm::vec2& movement, bool jump, bool attack, AttackType attackType) {
-    if (playerIndex < 0 || playerIndex >= m_players.size()) {
+    if (playerIndex < 0 || playerIndex >= m_pendingInputs.size()) {
+        return;
+    }
+    
+    PlayerInput input = PlayerInput::make(movement, jump, attack, attackType);
+    
+    // Keep presses from frames that didn't run a tick until one consumes them
+    PlayerInput& pending = m_pendingInputs[playerIndex];
+    mergePress(input, pending.buttons, pending.attackType);
+    pending = input;
+}
+
+void GameManager::queuePress(int playerIndex, uint8_t buttons, AttackType attackType, uint64_t timeMicroseconds) {
+    if (playerIndex < 0 || playerIndex >= m_pendingInputs.size()) {
+        return;
+    }
+    
+    // Presses from different sources (keyboard events, the controller thread) arrive
+    // interleaved, so keep the queue sorted rather than trusting arrival order
+    QueuedPress press = {timeMicroseconds, playerIndex, buttons, attackType};
+    auto position = std::upper_bound(m_queuedPresses.begin(), m_queuedPresses.end(), press,
+        [](const QueuedPress& a, const QueuedPress& b) { return a.timeMicroseconds < b.timeMicroseconds; });
+    m_queuedPresses.insert(position, press);
+}
+
+// The earlier attack wins when two land on one tick
+void GameManager::mergePress(PlayerInput& pending, uint8_t buttons, uint8_t attackType) {
+    if ((buttons & INPUT_ATTACK) && !(pending.buttons & INPUT_ATTACK)) {
+        pending.attackType = attackType;
+    }
+    pending.buttons |= buttons;
+}
+
+uint64_t GameManager::takeConsumedInputTime() {
+    uint64_t time = m_consumedInputTime;
+    m_consumedInputTime = 0;
+    return time;
+}
+
+void GameManager::takeQueuedPresses(uint64_t tickEndMicroseconds) {
+    size_t taken = 0;
+    while (taken < m_queuedPresses.size() && m_queuedPresses[taken].timeMicroseconds <= tickEndMicroseconds) {
+        const QueuedPress& press = m_queuedPresses[taken];
+        if (press.player < m_pendingInputs.size()) {
+            mergePress(m_pendingInputs[press.player], press.buttons, static_cast<uint8_t>(press.attackType));
+        }
+        if (m_consumedInputTime == 0) {
+            m_consumedInputTime = press.timeMicroseconds;
+        }
+        taken++;
+    }
+    m_queuedPresses.erase(m_queuedPresses.begin(), m_queuedPresses.begin() + taken);
+}
+
+void GameManager::dropStalePresses(uint64_t nowMicroseconds) {
+    // Without a frame time every queued press would apply on the next tick
+    if (nowMicroseconds == 0) {
+        m_queuedPresses.clear();
         return;
     }
     
+    uint64_t window = static_cast<uint64_t>(INPUT_BUFFER_TICKS * SIMULATION_TICK_DURATION * 1000000.0f);
+    uint64_t oldest = nowMicroseconds - std::min(window, nowMicroseconds);
+    size_t stale = 0;
+    while (stale < m_queuedPresses.size() && m_queuedPresses[stale].timeMicroseconds < oldest) {
+        stale++;
+    }
+    m_queuedPresses.erase(m_queuedPresses.begin(), m_queuedPresses.begin() + stale);
+}
+
+void GameManager::applyInput(int playerIndex, const PlayerInput& input) {
     // Cast to Fighter* to access Fighter-specific methods
     Fighter* player = dynamic_cast<Fighter*>(m_players[playerIndex]);
     if (!player) return; // Safety check
     
     // Process movement
-    if (movement.x < -0.1f) {
-        player->moveLeft(0.016f); // Assuming 60 FPS
-    } else if (movement.x > 0.1f) {
-        player->moveRight(0.016f);
+    if (input.moveX < 0) {
+        player->moveLeft(SIMULATION_TICK_DURATION);
+    } else if (input.moveX > 0) {
+        player->moveRight(SIMULATION_TICK_DURATION);
+    }
+    
+    // Presses from earlier ticks that couldn't act yet get another try. A new press that
+    // has to wait too restarts the window.
+    uint64_t tick = getCurrentTick();
+    uint8_t& buffered = m_fighters.m_bufferedButtons[playerIndex];
+    uint8_t& bufferedAttack = m_fighters.m_bufferedAttackTypes[playerIndex];
+    uint64_t& bufferEnd = m_fighters.m_bufferEndTicks[playerIndex];
+    if (tick >= bufferEnd) {
+        buffered = 0;
+    }
+    if (input.buttons & INPUT_ATTACK) {
+        bufferedAttack = input.attackType;
     }
+    uint8_t pressed = input.buttons | buffered;
+    uint8_t missed = 0;
     
     // Process jump
-    if (jump) {
-        player->jump();
+    if ((pressed & INPUT_JUMP) && !player->jump()) {
+        missed |= INPUT_JUMP;
     }
     
     // Process attack
-    if (attack) {
-        if (attackType == AttackType::SPECIAL_NEUTRAL ||
-            attackType == AttackType::SPECIAL_UP ||
-            attackType == AttackType::SPECIAL_DOWN ||
-            attackType == AttackType::SPECIAL_SIDE) {
-            player->specialAttack(attackType);
-        } else {
-            player->attack(attackType);
+    if (pressed & INPUT_ATTACK) {
+        AttackType attackType = static_cast<AttackType>(bufferedAttack);
+        bool acted = FighterComponents::isSpecial(attackType) ? player->specialAttack(attackType) : player->attack(attackType);
+        if (!acted) {
+            missed |= INPUT_ATTACK;
         }
     }
+    
+    if (missed & input.buttons) {
+        bufferEnd = tick + INPUT_BUFFER_TICKS;
+    }
+    buffered = missed;
+}
+
+void GameManager::saveState(std::vector<uint8_t>& out) const {
+    out.clear();
+    
+    StateWriter writer(out);
+    writer.write(static_cast<uint32_t>(STATE_VERSION));
+    writer.write(m_gameState);
+    writer.write(m_matchTimer);
+    writer.write(static_cast<uint8_t>(m_matchFinished ? 1 : 0));
+    
+    m_fighters.serialize(out);
+}
+
+bool GameManager::loadState(const uint8_t* data, size_t size) {
+    StateReader reader(data, size);
+    uint32_t version;
+    GameState gameState;
+    float matchTimer;
+    uint8_t matchFinished;
+    if (!reader.read(version) || version != STATE_VERSION ||
+        !reader.read(gameState) || !reader.read(matchTimer) || !reader.read(matchFinished)) {
+        return false;
+    }
+    
+    // Snapshots only restore into a match with the same players
+    uint32_t fighterCount;
+    StateReader peek(reader.getCursor(), reader.remaining());
+    if (!peek.read(fighterCount) || fighterCount != m_players.size()) {
+        return false;
+    }
+    
+    size_t fighterBytes;
+    if (!m_fighters.deserialize(reader.getCursor(), reader.remaining(), fighterBytes)) {
+        return false;
+    }
+    
+    m_gameState = gameState;
+    m_matchTimer = matchTimer;
+    m_matchFinished = matchFinished != 0;
+    return true;
+}
+
+uint64_t GameManager::computeStateHash() const {
+    saveState(m_hashScratch);
+    return hash64(m_hashScratch.data(), m_hashScratch.size());
+}
+
+bool GameManager::diffStates(const uint8_t* a, size_t aSize, const uint8_t* b, size_t bSize, std::vector<std::string>& out) {
+    const uint8_t* data[2] = { a, b };
+    size_t sizes[2] = { aSize, bSize };
+    GameState gameStates[2];
+    float matchTimers[2];
+    uint8_t matchFinished[2];
+    FighterComponents fighters[2];
+    
+    for (int i = 0; i < 2; i++) {
+        StateReader reader(data[i], sizes[i]);
+        uint32_t version;
+        size_t fighterBytes;
+        if (!reader.read(version) || version != STATE_VERSION ||
+            !reader.read(gameStates[i]) || !reader.read(matchTimers[i]) || !reader.read(matchFinished[i]) ||
+            !fighters[i].deserialize(reader.getCursor(), reader.remaining(), fighterBytes)) {
+            out.push_back(std::string("state ") + (i == 0 ? "a" : "b") + " is not a valid snapshot");
+            return false;
+        }
+    }
+    
+    if (gameStates[0] != gameStates[1]) {
+        out.push_back("game state: " + std::to_string(static_cast<int>(gameStates[0])) + " vs " + std::to_string(static_cast<int>(gameStates[1])));
+    }
+    if (matchTimers[0] != matchTimers[1]) {
+        out.push_back("match timer: " + std::to_string(matchTimers[0]) + " vs " + std::to_string(matchTimers[1]));
+    }
+    if (matchFinished[0] != matchFinished[1]) {
+        out.push_back("match finished: " + std::to_string(matchFinished[0]) + " vs " + std::to_string(matchFinished[1]));
+    }
+    
+    fighters[0].diff(fighters[1], out);
+    return true;
 }
 
 void GameManager::updateCamera() {
@@ -232,13 +514,13 @@ void GameManager::updateCamera() {
     glm::vec2 minPos(FLT_MAX);
     glm::vec2 maxPos(-FLT_MAX);
     
-    for (auto player : m_players) {
+    for (int i = 0; i < m_fighters.size(); i++) {
         // Skip dead players
-        if (player->getState() == CharacterState::DEAD) {
+        if (m_fighters.m_states[i] == CharacterState::DEAD) {
             continue;
         }
         
-        glm::vec2 pos = player->getPosition();
+        glm::vec2 pos = toVec2(m_fighters.m_positions[i]);
         minPos = glm::min(minPos, pos);
         maxPos = glm::max(maxPos, pos);
     }
@@ -276,8 +558,8 @@ void GameManager::checkMatchEnd() {
     // For stock mode, check if only one player has lives left
     if (m_gameSettings.mode == GameMode::STOCK) {
         int playersAlive = 0;
-        for (auto player : m_players) {
-            if (player->getLives() > 0) {
+        for (int i = 0; i < m_fighters.size(); i++) {
+            if (m_fighters.m_lives[i] > 0) {
                 playersAlive++;
             }
         }
@@ -4,9 +4,12 @@
 #include <vector>
 #include <string>
 #include "fighter.h"
+#include "fighter_components.h"
+#include "player_input.h"
 #include "stage.h"
 #include "../rendering/camera.h"
 #include "../rendering/shader.h"
+#include "../rendering/gpu_profiler.h"
 
 enum class GameState {
     MENU,
@@ -31,15 +34,31 @@ struct GameSettings {
     bool itemsEnabled = true;
     float damageMultiplier = 1.0f;
     float knockbackMultiplier = 1.0f;
+    uint32_t seed = 0;    // For any match randomness; stored in replays
 };
 
+// Collision work done by the most recent simulated tick, and by all of them
+struct SimulationCounters {
+    int activeHitboxes = 0;           // Latest tick
+    int collisionPairsTested = 0;     // Hitbox against fighter checks, latest tick
+    uint64_t totalHitboxes = 0;       // Every tick so far, for rates
+    uint64_t totalCollisionPairs = 0;
+};
+
+class ReplayRecorder;
+
 class GameManager {
 public:
     GameManager();
     ~GameManager();
     
-    void init();
-    void update(float deltaTime);
+    // With a shared stage, the match uses it instead of building its own. It isn't owned
+    // and must outlive the GameManager.
+    void init(Stage* sharedStage = nullptr);
+    
+    // frameTimeMicroseconds is when this frame's input was sampled, on the clock the
+    // queued presses use. 0 applies every queued press on the next tick.
+    void update(float deltaTime, uint64_t frameTimeMicroseconds = 0);
     void render(Shader& shader);
     
     // Game state management
@@ -52,19 +71,80 @@ public:
     void addPlayer(FighterType type, int controllerIndex);
     void removePlayer(int playerIndex);
     
-    // Input handling
+    // Player added with the given controllerIndex, or -1
+    int getPlayerForController(int controllerIndex) const;
+    
+    // Input handling. Input is latched and applied on the next simulation tick.
     void processPlayerInput(int playerIndex, const glm::vec2& movement, bool jump, bool attack, AttackType attackType);
     
+    // A timestamped button press. update() applies it on the tick whose end it falls
+    // before, so taps shorter than a frame, and several presses in one slow frame, each
+    // land on the right tick. Presses may be queued in any order.
+    void queuePress(int playerIndex, uint8_t buttons, AttackType attackType, uint64_t timeMicroseconds);
+    
+    // Ticks a press that can't act yet (mid-attack, in the air) is retried for
+    static const int INPUT_BUFFER_TICKS = 6;
+    
+    // Timestamp of the oldest queued press a tick has consumed since the last call, or 0.
+    // The frame presenting those ticks shows its result, for latency measurement.
+    uint64_t takeConsumedInputTime();
+    
+    // Runs exactly one simulation tick with the given per-player inputs. Used by drivers
+    // that own timing and input themselves, such as rollback.
+    void advanceTick(const PlayerInput* inputs, int count);
+    
+    // Compact snapshot of the simulation state: fighter rows, pending timers and match
+    // state. Stage layout and settings don't change during a match and aren't included.
+    void saveState(std::vector<uint8_t>& out) const;
+    bool loadState(const uint8_t* data, size_t size);
+    
+    // xxHash64 of saveState, cheap enough to take every tick for desync checks
+    uint64_t computeStateHash() const;
+    
+    // Appends a line per field that differs between two saveState buffers
+    static bool diffStates(const uint8_t* a, size_t aSize, const uint8_t* b, size_t bSize, std::vector<std::string>& out);
+    
+    // While set, every tick's applied inputs are passed to the recorder. Not owned.
+    void setReplayRecorder(ReplayRecorder* recorder) { m_replayRecorder = recorder; }
+    
+    // While set, render passes are timed on the GPU. Not owned.
+    void setGpuProfiler(GpuProfiler* profiler) { m_gpuProfiler = profiler; }
+    
+    int getPlayerCount() const { return static_cast<int>(m_players.size()); }
+    
     // Getters
     GameState getGameState() const { return m_gameState; }
     GameSettings& getGameSettings() { return m_gameSettings; }
+    const GameSettings& getGameSettings() const { return m_gameSettings; }
+    FighterType getPlayerType(int playerIndex) const;
+    const FighterComponents& getFighters() const { return m_fighters; }
+    float getMatchTimer() const { return m_matchTimer; }
+    uint64_t getCurrentTick() const { return m_fighters.m_timers.getCurrentTick(); }
+    const SimulationCounters& getSimulationCounters() const { return m_simulationCounters; }
     
 private:
     GameState m_gameState;
     GameSettings m_gameSettings;
     
     Stage* m_currentStage;
+    bool m_ownsStage;
+    
+    // Hot simulation state for every fighter; m_players[i] is a handle to row i
+    FighterComponents m_fighters;
     std::vector<Character*> m_players;
+    std::vector<int> m_controllerIndices;
+    
+    // Latest input per player, waiting for the next tick
+    std::vector<PlayerInput> m_pendingInputs;
+    
+    struct QueuedPress {
+        uint64_t timeMicroseconds;
+        int player;
+        uint8_t buttons;
+        AttackType attackType;
+    };
+    std::vector<QueuedPress> m_queuedPresses;
+    uint64_t m_consumedInputTime;
     
     Camera* m_camera;
     glm::mat4 m_projection;
@@ -72,7 +152,26 @@ private:
     float m_matchTimer;
     bool m_matchFinished;
     
+    // Diagnostics only; not part of the saved state
+    SimulationCounters m_simulationCounters;
+    
+    ReplayRecorder* m_replayRecorder;
+    GpuProfiler* m_gpuProfiler;
+    mutable std::vector<uint8_t> m_hashScratch;
+    
+    // Frame time not yet consumed by fixed simulation ticks
+    float m_tickAccumulator;
+    static const int MAX_TICKS_PER_UPDATE = 8;
+    
+    // Bumped whenever the snapshot layout changes
+    static const uint32_t STATE_VERSION = 2;
+    
     // Helper methods
+    void simulateTick();
+    void applyInput(int playerIndex, const PlayerInput& input);
+    void mergePress(PlayerInput& pending, uint8_t buttons, uint8_t attackType);
+    void takeQueuedPresses(uint64_t tickEndMicroseconds);
+    void dropStalePresses(uint64_t nowMicroseconds);
     void updateCamera();
     void checkHitboxCollisions();
     void checkMatchEnd();
@@ -0,0 +1,227 @@
+#include "lag_compensation.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+LagCompensation::LagCompensation()
+    : m_hasFrames(false)
+    , m_oldestTick(0)
+    , m_newestTick(0)
+    , m_rewound(false)
+    , m_rewoundTick(0)
+    , m_rewoundFraction(0.0f)
+    , m_rewoundMask(0)
+{
+    for (int i = 0; i < HISTORY_TICKS; i++) {
+        Frame& frame = m_frames[i];
+        frame.tick = UINT32_MAX;
+        frame.presentMask = 0;
+        std::fill(frame.x, frame.x + MAX_TARGETS, 0.0f);
+        std::fill(frame.y, frame.y + MAX_TARGETS, 0.0f);
+        std::fill(frame.z, frame.z + MAX_TARGETS, 0.0f);
+    }
+    
+    // Same capsule as the FPS player
+    Capsule shape;
+    shape.radius = 0.5f;
+    shape.halfSegment = 0.375f;
+    for (int i = 0; i < MAX_TARGETS; i++) {
+        m_shapes[i] = shape;
+    }
+}
+
+void LagCompensation::setTargetShape(int target, const Capsule& shape) {
+    if (target >= 0 && target < MAX_TARGETS) {
+        m_shapes[target] = shape;
+    }
+}
+
+void LagCompensation::beginTick(uint32_t tick) {
+    Frame& frame = m_frames[tick % HISTORY_TICKS];
+    frame.tick = tick;
+    frame.presentMask = 0;
+    
+    // Going back in time means a new match; the old frames can't be reached any more
+    if (!m_hasFrames || tick <= m_newestTick) {
+        m_oldestTick = tick;
+    } else if (tick >= HISTORY_TICKS) {
+        m_oldestTick = std::max(m_oldestTick, tick - (HISTORY_TICKS - 1));
+    }
+    m_newestTick = tick;
+    m_hasFrames = true;
+    
+    // The scratch copy may have been built from the frame we just recycled
+    m_rewound = false;
+}
+
+void LagCompensation::record(int target, const glm::vec3& center) {
+    if (!m_hasFrames || target < 0 || target >= MAX_TARGETS) {
+        return;
+    }
+    
+    Frame& frame = m_frames[m_newestTick % HISTORY_TICKS];
+    frame.x[target] = center.x;
+    frame.y[target] = center.y;
+    frame.z[target] = center.z;
+    frame.presentMask |= 1ull << target;
+}
+
+const LagCompensation::Frame* LagCompensation::findFrame(uint32_t tick) const {
+    const Frame& frame = m_frames[tick % HISTORY_TICKS];
+    return frame.tick == tick ? &frame : nullptr;
+}
+
+int LagCompensation::rewind(uint32_t tick, float fraction) {
+    if (!m_hasFrames || std::isnan(fraction)) {
+        m_rewound = false;
+        m_rewoundMask = 0;
+        return 0;
+    }
+    
+    fraction = std::min(std::max(fraction, 0.0f), 1.0f);
+    if (tick < m_oldestTick) {
+        tick = m_oldestTick;
+        fraction = 0.0f;
+    } else if (tick >= m_newestTick) {
+        tick = m_newestTick;
+        fraction = 0.0f;
+    }
+    
+    if (m_rewound && tick == m_rewoundTick && fraction == m_rewoundFraction) {
+        return static_cast<int>(__builtin_popcountll(m_rewoundMask));
+    }
+    m_stats.rewinds++;
+    
+    // Closest recorded frames either side; the newest always exists, so at least one does
+    const Frame* from = nullptr;
+    for (uint32_t t = tick + 1; !from && t-- > m_oldestTick;) {
+        from = findFrame(t);
+    }
+    const Frame* to = nullptr;
+    if (!from || from->tick != tick || fraction > 0.0f) {
+        for (uint32_t t = tick + 1; !to && t <= m_newestTick; t++) {
+            to = findFrame(t);
+        }
+    }
+    if (!from) {
+        from = to;
+    }
+    if (!to) {
+        to = from;
+    }
+    if (!from) {
+        m_rewound = false;
+        m_rewoundMask = 0;
+        return 0;
+    }
+    
+    float weight = 0.0f;
+    if (to != from) {
+        weight = (static_cast<float>(tick - from->tick) + fraction) / static_cast<float>(to->tick - from->tick);
+    }
+    
+    // Interpolate where both ticks have the target; otherwise use whichever does
+    uint64_t both = from->presentMask & to->presentMask;
+    for (int i = 0; i < MAX_TARGETS; i++) {
+        m_rewoundX[i] = from->x[i] + (to->x[i] - from->x[i]) * weight;
+        m_rewoundY[i] = from->y[i] + (to->y[i] - from->y[i]) * weight;
+        m_rewoundZ[i] = from->z[i] + (to->z[i] - from->z[i]) * weight;
+    }
+    
+    uint64_t onlyTo = to->presentMask & ~from->presentMask;
+    uint64_t onlyFrom = from->presentMask & ~to->presentMask;
+    for (uint64_t mask = onlyTo | onlyFrom; mask != 0; mask &= mask - 1) {
+        int i = __builtin_ctzll(mask);
+        const Frame* source = (onlyTo >> i) & 1 ? to : from;
+        m_rewoundX[i] = source->x[i];
+        m_rewoundY[i] = source->y[i];
+        m_rewoundZ[i] = source->z[i];
+    }
+    
+    m_rewoundMask = both | onlyTo | onlyFrom;
+    m_rewound = true;
+    m_rewoundTick = tick;
+    m_rewoundFraction = fraction;
+    return static_cast<int>(__builtin_popcountll(m_rewoundMask));
+}
+
+bool LagCompensation::getRewoundCenter(int target, glm::vec3& center) const {
+    if (target < 0 || target >= MAX_TARGETS || !((m_rewoundMask >> target) & 1)) {
+        return false;
+    }
+    center = glm::vec3(m_rewoundX[target], m_rewoundY[target], m_rewoundZ[target]);
+    return true;
+}
+
+void LagCompensation::validateShots(HitscanBatch& batch) {
+    std::vector<ShotResult>& shots = batch.getMutableResults();
+    
+    // Group shots by view time so each distinct time is rewound once
+    m_order.resize(shots.size());
+    for (size_t i = 0; i < shots.size(); i++) {
+        m_order[i] = static_cast<int>(i);
+    }
+    // NaN fractions sort first so the order stays strict
+    auto fractionKey = [](float fraction) { return std::isnan(fraction) ? -1.0f : fraction; };
+    std::sort(m_order.begin(), m_order.end(), [&shots, &fractionKey](int a, int b) {
+        if (shots[a].viewTick != shots[b].viewTick) {
+            return shots[a].viewTick < shots[b].viewTick;
+        }
+        return fractionKey(shots[a].viewFraction) < fractionKey(shots[b].viewFraction);
+    });
+    
+    for (int index : m_order) {
+        ShotResult& shot = shots[index];
+        m_stats.shotsValidated++;
+        
+        if (shot.viewTick == VIEW_TICK_PRESENT) {
+            rewind(m_newestTick, 0.0f);
+        } else if (rewind(shot.viewTick, shot.viewFraction) == 0) {
+            continue;
+        }
+        
+        // Targets behind the wall the shot already hit are out of reach
+        float maxDistance = shot.hit.hit ? shot.hit.distance : shot.ray.maxDistance;
+        const glm::vec3& origin = shot.ray.origin;
+        const glm::vec3& direction = shot.ray.direction;
+        
+        uint64_t candidates = m_rewoundMask;
+        if (shot.ownerId >= 0 && shot.ownerId < MAX_TARGETS) {
+            candidates &= ~(1ull << shot.ownerId);
+        }
+        
+        for (; candidates != 0; candidates &= candidates - 1) {
+            int target = __builtin_ctzll(candidates);
+            const Capsule& shape = m_shapes[target];
+            m_stats.broadphaseTests++;
+            
+            // Bounding sphere: distance from the center to the ray within reach
+            float cx = m_rewoundX[target] - origin.x;
+            float cy = m_rewoundY[target] - origin.y;
+            float cz = m_rewoundZ[target] - origin.z;
+            float along = cx * direction.x + cy * direction.y + cz * direction.z;
+            float boundRadius = shape.radius + shape.halfSegment;
+            if (along < -boundRadius || along - boundRadius > maxDistance) {
+                continue;
+            }
+            float distanceSq = cx * cx + cy * cy + cz * cz - along * along;
+            if (distanceSq > boundRadius * boundRadius) {
+                continue;
+            }
+            
+            m_stats.narrowphaseTests++;
+            glm::vec3 center(m_rewoundX[target], m_rewoundY[target], m_rewoundZ[target]);
+            glm::vec3 segment(0.0f, shape.halfSegment, 0.0f);
+            float t;
+            if (intersectRayCapsule(origin, direction, maxDistance, center - segment, center + segment, shape.radius, t)) {
+                maxDistance = t;
+                shot.targetHit = target;
+                shot.targetDistance = t;
+            }
+        }
+        
+        if (shot.targetHit >= 0) {
+            m_stats.hits++;
+        }
+    }
+}
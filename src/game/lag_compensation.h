@@ -0,0 +1,85 @@
+#ifndef LAG_COMPENSATION_H
+#define LAG_COMPENSATION_H
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "weapon.h"
+#include "world.h"
+
+struct LagCompensationStats {
+    uint64_t shotsValidated = 0;
+    uint64_t rewinds = 0;            // Scratch rebuilds; shots at the same view time share one
+    uint64_t broadphaseTests = 0;    // Ray vs bounding sphere
+    uint64_t narrowphaseTests = 0;   // Ray vs capsule
+    uint64_t hits = 0;
+};
+
+// Server-side history of where every player's hitbox was over the last ~1 second.
+// Shots carry the tick the client was looking at; validation rewinds targets to that
+// time in a scratch copy, interpolating between recorded ticks, and traces the shot
+// against them. Live state is never touched, and cost per shot is one bounding-sphere
+// test per target plus an exact capsule test for the few that pass.
+class LagCompensation {
+public:
+    static const int MAX_TARGETS = 64;
+    static const int HISTORY_TICKS = 64;   // A little over a second at 60 Hz
+    
+    LagCompensation();
+    
+    void setTargetShape(int target, const Capsule& shape);
+    
+    // Starts the history frame for `tick`. Targets not recorded before the next
+    // beginTick() are absent at that tick (dead, not spawned).
+    void beginTick(uint32_t tick);
+    void record(int target, const glm::vec3& center);
+    
+    // Traces every shot in the batch against targets rewound to the shot's view tick,
+    // clipped by the world hit resolve() already found. A shot never hits its owner;
+    // target ids are the same as owner ids. View ticks outside the history are clamped,
+    // which also bounds how far back a client can claim to have been looking. Shots with
+    // a NaN view fraction hit no one.
+    void validateShots(HitscanBatch& batch);
+    
+    // Rewinds into the scratch copy to `fraction` of the way from `tick` to the next
+    // tick, and returns how many targets were present. Ticks the server never recorded
+    // are interpolated across. A NaN fraction is rejected and leaves no targets.
+    int rewind(uint32_t tick, float fraction);
+    bool getRewoundCenter(int target, glm::vec3& center) const;
+    
+    uint32_t getNewestTick() const { return m_newestTick; }
+    uint32_t getOldestTick() const { return m_oldestTick; }
+    const LagCompensationStats& getStats() const { return m_stats; }
+    
+private:
+    // Structure-of-arrays per tick so rewinding is a straight loop over 64 lanes
+    struct Frame {
+        uint32_t tick;
+        uint64_t presentMask;
+        float x[MAX_TARGETS];
+        float y[MAX_TARGETS];
+        float z[MAX_TARGETS];
+    };
+    
+    Frame m_frames[HISTORY_TICKS];
+    bool m_hasFrames;
+    uint32_t m_oldestTick;             // Ticks may be skipped, so both ends are tracked
+    uint32_t m_newestTick;
+    Capsule m_shapes[MAX_TARGETS];
+    
+    // Scratch copy of the targets at m_rewoundTick + m_rewoundFraction
+    bool m_rewound;
+    uint32_t m_rewoundTick;
+    float m_rewoundFraction;
+    uint64_t m_rewoundMask;
+    float m_rewoundX[MAX_TARGETS];
+    float m_rewoundY[MAX_TARGETS];
+    float m_rewoundZ[MAX_TARGETS];
+    
+    std::vector<int> m_order;
+    LagCompensationStats m_stats;
+    
+    const Frame* findFrame(uint32_t tick) const;
+};
+
+#endif
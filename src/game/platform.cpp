@@ -1,14 +1,15 @@
 #include "platform.h"
+#include <algorithm>
 #include <glm/gtc/matrix_transform.hpp>
 
 Platform::Platform(const glm::vec2& position, const glm::vec2& size, PlatformType type)
-    : m_position(position)
-    , m_size(size)
+    : m_position(toSimVec2(position))
+    , m_size(toSimVec2(size))
     , m_type(type)
     , m_mesh(nullptr)
     , m_texture(nullptr)
 {
-    createMesh();
+    // The mesh is created on first render so headless servers never touch GL
 }
 
 Platform::~Platform() {
@@ -19,11 +20,15 @@ Platform::~Platform() {
 }
 
 void Platform::render(Shader& shader) {
-    if (!m_mesh) return;
+    if (!m_mesh) {
+        createMesh();
+    }
     
     glm::mat4 model = glm::mat4(1.0f);
-    model = glm::translate(model, glm::vec3(m_position.x, m_position.y, 0.0f));
-    model = glm::scale(model, glm::vec3(m_size.x, m_size.y, 1.0f));
+    glm::vec2 position = toVec2(m_position);
+    glm::vec2 size = toVec2(m_size);
+    model = glm::translate(model, glm::vec3(position.x, position.y, 0.0f));
+    model = glm::scale(model, glm::vec3(size.x, size.y, 1.0f));
     
     shader.setMat4("model", model);
     
@@ -36,7 +41,7 @@ void Platform::render(Shader& shader) {
     m_mesh->draw(shader);
 }
 
-bool Platform::checkCollision(const glm::vec2& position, const glm::vec2& size) const {
+bool Platform::checkCollision(const SimVec2& position, const SimVec2& size) const {
     // For PASS_THROUGH platforms, no collision
     if (m_type == PlatformType::PASS_THROUGH) {
         return false;
@@ -52,7 +57,7 @@ bool Platform::checkCollision(const glm::vec2& position, const glm::vec2& size)
     return collisionX && collisionY;
 }
 
-bool Platform::checkCollisionFromAbove(const glm::vec2& position, const glm::vec2& size, const glm::vec2& velocity) const {
+bool Platform::checkCollisionFromAbove(const SimVec2& position, const SimVec2& size, const SimVec2& velocity) const {
     // For PASS_THROUGH platforms, no collision
     if (m_type == PlatformType::PASS_THROUGH) {
         return false;
@@ -61,7 +66,7 @@ bool Platform::checkCollisionFromAbove(const glm::vec2& position, const glm::vec
     // For SEMI_SOLID platforms, only collide if coming from above
     if (m_type == PlatformType::SEMI_SOLID) {
         // Check if the character is above the platform and moving downward
-        if (position.y - size.y/2 >= m_position.y + m_size.y && velocity.y < 0) {
+        if (position.y - size.y/2 >= m_position.y + m_size.y && velocity.y < SimScalar(0)) {
             // Check if the character would intersect with the platform in the next frame
             bool collisionX = m_position.x + m_size.x >= position.x - size.x/2 && 
                              m_position.x <= position.x + size.x/2;
@@ -78,6 +83,93 @@ bool Platform::checkCollisionFromAbove(const glm::vec2& position, const glm::vec
     return checkCollision(position, size);
 }
 
+bool Platform::sweepCollision(const SimVec2& position, const SimVec2& size, const SimVec2& displacement,
+                              SimScalar& timeOfImpact, SimVec2& normal) const {
+    // For PASS_THROUGH platforms, no collision
+    if (m_type == PlatformType::PASS_THROUGH) {
+        return false;
+    }
+    
+    // Tolerance for boxes resting exactly on a surface
+    const SimScalar EPSILON = SimScalar(0.0001f);
+    const SimScalar ZERO = SimScalar(0);
+    const SimScalar ONE = SimScalar(1);
+    
+    // Expand the platform by the character's half size so the character becomes a point
+    SimVec2 halfSize = size * SimScalar(0.5f);
+    SimVec2 expandedMin = m_position - halfSize;
+    SimVec2 expandedMax = m_position + m_size + halfSize;
+    
+    // SEMI_SOLID platforms only block a character falling onto their top surface
+    if (m_type == PlatformType::SEMI_SOLID) {
+        if (displacement.y >= ZERO || position.y < expandedMax.y - EPSILON) {
+            return false;
+        }
+    }
+    
+    // Already overlapping: let the character move out instead of pinning it in place
+    if (position.x > expandedMin.x + EPSILON && position.x < expandedMax.x - EPSILON &&
+        position.y > expandedMin.y + EPSILON && position.y < expandedMax.y - EPSILON) {
+        return false;
+    }
+    
+    // Slab test of the movement segment against the expanded box
+    SimScalar tEnter = SIM_SCALAR_MIN;
+    SimScalar tExit = SIM_SCALAR_MAX;
+    SimVec2 enterNormal(ZERO);
+    
+    for (int axis = 0; axis < 2; axis++) {
+        if (displacement[axis] == ZERO) {
+            // Not moving on this axis, so it must already be within the slab
+            if (position[axis] < expandedMin[axis] || position[axis] > expandedMax[axis]) {
+                return false;
+            }
+            continue;
+        }
+        
+        // Divide rather than multiply by a reciprocal, which would lose most of its
+        // precision in fixed point for large displacements
+        SimScalar tNear = (expandedMin[axis] - position[axis]) / displacement[axis];
+        SimScalar tFar = (expandedMax[axis] - position[axis]) / displacement[axis];
+        SimScalar side = -ONE;
+        if (tNear > tFar) {
+            std::swap(tNear, tFar);
+            side = ONE;
+        }
+        
+        if (tNear > tEnter) {
+            tEnter = tNear;
+            enterNormal = SimVec2(ZERO);
+            enterNormal[axis] = side;
+        }
+        tExit = std::min(tExit, tFar);
+    }
+    
+    if (tEnter > tExit || tExit < ZERO || tEnter > ONE) {
+        return false;
+    }
+    
+    // Starting within the contact tolerance counts as an immediate hit
+    tEnter = std::max(tEnter, ZERO);
+    
+    // Touching but not moving into the surface
+    if (enterNormal.x == ZERO && enterNormal.y == ZERO) {
+        return false;
+    }
+    if (dot(enterNormal, displacement) >= ZERO) {
+        return false;
+    }
+    
+    // SEMI_SOLID platforms can only be landed on from above
+    if (m_type == PlatformType::SEMI_SOLID && enterNormal.y <= ZERO) {
+        return false;
+    }
+    
+    timeOfImpact = tEnter;
+    normal = enterNormal;
+    return true;
+}
+
 void Platform::createMesh() {
     // Create a simple quad mesh for the platform
     std::vector<Vertex> vertices = {
@@ -2,6 +2,7 @@
 #define PLATFORM_H
 
 #include <glm/glm.hpp>
+#include "simulation.h"
 #include "../rendering/mesh.h"
 #include "../rendering/shader.h"
 #include "../rendering/texture.h"
@@ -20,23 +21,29 @@ public:
     void render(Shader& shader);
     
     // Collision detection
-    bool checkCollision(const glm::vec2& position, const glm::vec2& size) const;
-    bool checkCollisionFromAbove(const glm::vec2& position, const glm::vec2& size, const glm::vec2& velocity) const;
+    bool checkCollision(const SimVec2& position, const SimVec2& size) const;
+    bool checkCollisionFromAbove(const SimVec2& position, const SimVec2& size, const SimVec2& velocity) const;
+    
+    // Swept AABB collision: moves a box of the given size by displacement and reports the
+    // fraction of the move (0..1) at which it first touches the platform, plus the contact normal
+    bool sweepCollision(const SimVec2& position, const SimVec2& size, const SimVec2& displacement,
+                        SimScalar& timeOfImpact, SimVec2& normal) const;
     
     // Getters
-    glm::vec2 getPosition() const { return m_position; }
-    glm::vec2 getSize() const { return m_size; }
+    glm::vec2 getPosition() const { return toVec2(m_position); }
+    glm::vec2 getSize() const { return toVec2(m_size); }
     PlatformType getType() const { return m_type; }
     
     // Setters
-    void setPosition(const glm::vec2& position) { m_position = position; }
-    void setSize(const glm::vec2& size) { m_size = size; }
+    void setPosition(const glm::vec2& position) { m_position = toSimVec2(position); }
+    void setSize(const glm::vec2& size) { m_size = toSimVec2(size); }
     void setType(PlatformType type) { m_type = type; }
     void setTexture(Texture* texture) { m_texture = texture; }
     
 private:
-    glm::vec2 m_position;
-    glm::vec2 m_size;
+    // Kept in simulation numbers since collision runs every tick
+    SimVec2 m_position;
+    SimVec2 m_size;
     PlatformType m_type;
     
     Mesh* m_mesh;
@@ -1,52 +1,145 @@
 #include "player.h"
+#include "simulation.h"
 #include "../engine/input.h"
+#include <cmath>
 
 Player::Player(glm::vec3 position) :
-    m_position(position),
-    m_velocity(0.0f),
-    m_speed(5.0f),
-    m_jumpForce(5.0f),
-    m_onGround(false) {
+    m_previousPosition(position),
+    m_tickAccumulator(0.0f),
+    m_nextSequence(0),
+    m_ackedSequence(0),
+    m_hasAck(false),
+    m_heldForward(0),
+    m_heldRight(0),
+    m_jumpQueued(false),
+    m_correctionOffset(0.0f),
+    m_renderPosition(position) {
+    
+    m_state.position = position;
+    m_state.velocity = glm::vec3(0.0f);
+    m_state.onGround = false;
+    
+    for (int i = 0; i < COMMAND_BUFFER_SIZE; i++) {
+        // No sequence maps to this slot yet
+        m_moves[i].command.sequence = static_cast<uint32_t>(i + 1);
+    }
     
     m_camera = new Camera(position);
 }
 
+Player::~Player() {
+    delete m_camera;
+}
+
+MoveCommand Player::sampleCommand() {
+    MoveCommand command;
+    command.sequence = m_nextSequence++;
+    command.forward = m_heldForward;
+    command.right = m_heldRight;
+    command.buttons = m_jumpQueued ? MOVE_JUMP : 0;
+    command.yaw = m_camera->Yaw;
+    
+    m_jumpQueued = false;
+    return command;
+}
+
 void Player::update(float deltaTime, World* world) {
-    m_velocity.y -= GRAVITY * deltaTime;
+    // Predict one fixed tick per command, exactly as the server will run it
+    m_tickAccumulator += deltaTime;
+    while (m_tickAccumulator >= SIMULATION_TICK_DURATION) {
+        m_tickAccumulator -= SIMULATION_TICK_DURATION;
+        
+        MoveCommand command = sampleCommand();
+        m_previousPosition = m_state.position;
+        PlayerMovement::simulate(m_state, command, SIMULATION_TICK_DURATION, world);
+        
+        PredictedMove& move = m_moves[command.sequence % COMMAND_BUFFER_SIZE];
+        move.command = command;
+        move.result = m_state;
+    }
+    
+    m_heldForward = 0;
+    m_heldRight = 0;
     
-    glm::vec3 newPosition = m_position + m_velocity * deltaTime;
+    m_correctionOffset *= std::exp(-deltaTime / CORRECTION_SMOOTHING);
     
-    newPosition = world->resolveCollision(m_position, newPosition, PLAYER_RADIUS);
+    float alpha = m_tickAccumulator / SIMULATION_TICK_DURATION;
+    m_renderPosition = glm::mix(m_previousPosition, m_state.position, alpha) + m_correctionOffset;
+    
+    m_camera->Position = m_renderPosition;
+}
+
+void Player::applyServerState(uint32_t sequence, const PlayerMoveState& state, World* world) {
+    // Acks can arrive out of order; anything older than what we have is stale
+    if (m_hasAck && static_cast<int32_t>(sequence - m_ackedSequence) <= 0) {
+        return;
+    }
+    if (static_cast<int32_t>(m_nextSequence - sequence) <= 0) {
+        return;  // Acknowledges a command we never sent
+    }
+    m_ackedSequence = sequence;
+    m_hasAck = true;
     
-    m_onGround = (m_position.y > newPosition.y && 
-                 abs(m_position.y - newPosition.y) < 0.01f);
+    // Prediction was right: nothing to do
+    const PredictedMove& acked = m_moves[sequence % COMMAND_BUFFER_SIZE];
+    if (acked.command.sequence == sequence &&
+        glm::length(acked.result.position - state.position) < CORRECTION_EPSILON &&
+        glm::length(acked.result.velocity - state.velocity) < CORRECTION_EPSILON &&
+        acked.result.onGround == state.onGround) {
+        return;
+    }
     
-    m_position = newPosition;
+    // Rewind to the server's state and replay every command it hasn't seen yet
+    glm::vec3 predictedPosition = m_state.position;
+    PlayerMoveState corrected = state;
+    for (uint32_t s = sequence + 1; s != m_nextSequence; s++) {
+        PredictedMove& move = m_moves[s % COMMAND_BUFFER_SIZE];
+        if (move.command.sequence != s) {
+            break;  // Older than the buffer holds
+        }
+        PlayerMovement::simulate(corrected, move.command, SIMULATION_TICK_DURATION, world);
+        move.result = corrected;
+    }
+    m_state = corrected;
     
-    m_camera->Position = m_position;
+    // Keep drawing where we were and blend toward the corrected path
+    glm::vec3 error = predictedPosition - m_state.position;
+    m_previousPosition -= error;
+    m_correctionOffset += error;
+    if (glm::length(m_correctionOffset) > SNAP_DISTANCE) {
+        m_correctionOffset = glm::vec3(0.0f);
+        m_previousPosition = m_state.position;
+    }
 }
 
-void Player::processKeyboard(int direction, float deltaTime) {
-    float velocity = m_speed * deltaTime;
-    glm::vec3 movement(0.0f);
+int Player::getUnacknowledgedCommands(MoveCommand* out, int maxCount) const {
+    uint32_t first = m_hasAck ? m_ackedSequence + 1 : 0;
+    uint32_t pending = m_nextSequence - first;
+    if (pending > static_cast<uint32_t>(maxCount)) {
+        first = m_nextSequence - maxCount;
+    }
     
+    int count = 0;
+    for (uint32_t s = first; s != m_nextSequence; s++) {
+        const PredictedMove& move = m_moves[s % COMMAND_BUFFER_SIZE];
+        if (move.command.sequence == s) {
+            out[count++] = move.command;
+        }
+    }
+    return count;
+}
+
+// Movement is simulated per tick from the held directions, so the frame time isn't needed
+void Player::processKeyboard(int direction, float /*deltaTime*/) {
+    // Summed so opposite keys held together (A+D, W+S) cancel out
     if (direction == FORWARD)
-        movement += glm::vec3(m_camera->Front.x, 0.0f, m_camera->Front.z);
+        m_heldForward++;
     if (direction == BACKWARD)
-        movement -= glm::vec3(m_camera->Front.x, 0.0f, m_camera->Front.z);
+        m_heldForward--;
     if (direction == LEFT)
-        movement -= m_camera->Right;
+        m_heldRight--;
     if (direction == RIGHT)
-        movement += m_camera->Right;
-    
-    if (glm::length(movement) > 0.0f) {
-        movement = glm::normalize(movement) * velocity;
-        m_velocity.x = movement.x;
-        m_velocity.z = movement.z;
-    } else {
-        m_velocity.x *= 0.9f;
-        m_velocity.z *= 0.9f;
-    }
+        m_heldRight++;
 }
 
 void Player::processMouseMovement(float xoffset, float yoffset) {
@@ -54,8 +147,6 @@ void Player::processMouseMovement(float xoffset, float yoffset) {
 }
 
 void Player::jump() {
-    if (m_onGround) {
-        m_velocity.y = m_jumpForce;
-        m_onGround = false;
-    }
-}
\ No newline at end of file
+    // Consumed by the next command; whether it lifts off is up to the simulation
+    m_jumpQueued = true;
+}
@@ -3,35 +3,77 @@
 
 #include <glm/glm.hpp>
 #include "../rendering/camera.h"
+#include "player_movement.h"
 #include "world.h"
 
+// First-person player with client-side prediction. Input is sampled into one
+// MoveCommand per simulation tick and applied locally right away, so movement responds
+// within a frame whatever the round trip. When the server reports where it put us
+// after a command, the local state is rewound to that, the unacknowledged commands are
+// replayed on top, and the visible difference is smoothed out instead of snapping.
 class Player {
 public:
     Player(glm::vec3 position = glm::vec3(0.0f, 1.75f, 0.0f));
+    ~Player();
     
     void update(float deltaTime, World* world);
     
+    // Directions are held for the current frame; call once per frame for each key that's
+    // down. Opposite directions held together cancel out.
     void processKeyboard(int direction, float deltaTime);
     
     void processMouseMovement(float xoffset, float yoffset);
     
     void jump();
     
+    // Authoritative state after the server applied command `sequence`
+    void applyServerState(uint32_t sequence, const PlayerMoveState& state, World* world);
+    
+    // Commands the server hasn't acknowledged yet, oldest first, for (re)sending.
+    // Returns how many were written.
+    int getUnacknowledgedCommands(MoveCommand* out, int maxCount) const;
+    
     Camera* getCamera() { return m_camera; }
     
-    glm::vec3 getPosition() const { return m_position; }
+    // Smoothed position for rendering; the predicted simulation state is separate
+    glm::vec3 getPosition() const { return m_renderPosition; }
+    const PlayerMoveState& getPredictedState() const { return m_state; }
+    uint32_t getNextSequence() const { return m_nextSequence; }
+    uint32_t getAcknowledgedSequence() const { return m_ackedSequence; }
     
 private:
-    glm::vec3 m_position;
-    glm::vec3 m_velocity;
-    float m_speed;
-    float m_jumpForce;
-    bool m_onGround;
+    static const int COMMAND_BUFFER_SIZE = 128;
+    
+    struct PredictedMove {
+        MoveCommand command;
+        PlayerMoveState result;   // Predicted state after the command
+    };
+    
+    PlayerMoveState m_state;
+    glm::vec3 m_previousPosition;     // State before the last tick, for interpolation
+    float m_tickAccumulator;
+    
+    PredictedMove m_moves[COMMAND_BUFFER_SIZE];
+    uint32_t m_nextSequence;
+    uint32_t m_ackedSequence;
+    bool m_hasAck;
+    
+    int8_t m_heldForward;
+    int8_t m_heldRight;
+    bool m_jumpQueued;
+    
+    glm::vec3 m_correctionOffset;     // Rendered minus simulated position, decays to zero
+    glm::vec3 m_renderPosition;
     Camera* m_camera;
     
-    const float GRAVITY = 9.81f;
-    const float PLAYER_RADIUS = 0.5f;
-    const float PLAYER_HEIGHT = 1.75f;
+    // Errors below this are float noise, not a misprediction
+    const float CORRECTION_EPSILON = 0.001f;
+    // Corrections larger than this are teleports and snap immediately
+    const float SNAP_DISTANCE = 2.0f;
+    // Time constant of the exponential correction blend, in seconds
+    const float CORRECTION_SMOOTHING = 0.1f;
+    
+    MoveCommand sampleCommand();
 };
 
-#endif
\ No newline at end of file
+#endif
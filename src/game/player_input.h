@@ -0,0 +1,39 @@
+#ifndef PLAYER_INPUT_H
+#define PLAYER_INPUT_H
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "fighter_components.h"
+
+enum InputButtons : uint8_t {
+    INPUT_JUMP = 1 << 0,
+    INPUT_ATTACK = 1 << 1
+};
+
+// One player's controls for one simulation tick, small enough to send and store per tick
+struct PlayerInput {
+    int8_t moveX;        // -1 left, 0 none, 1 right
+    uint8_t buttons;     // InputButtons pressed this tick
+    uint8_t attackType;  // AttackType used if INPUT_ATTACK is set
+    uint8_t reserved;
+    
+    static PlayerInput make(const glm::vec2& movement, bool jump, bool attack, AttackType attackType) {
+        PlayerInput input;
+        input.moveX = movement.x < -0.1f ? -1 : (movement.x > 0.1f ? 1 : 0);
+        input.buttons = (jump ? INPUT_JUMP : 0) | (attack ? INPUT_ATTACK : 0);
+        input.attackType = attack ? static_cast<uint8_t>(attackType) : 0;
+        input.reserved = 0;
+        return input;
+    }
+    
+    static PlayerInput none() {
+        return make(glm::vec2(0.0f), false, false, AttackType::NEUTRAL);
+    }
+    
+    bool operator==(const PlayerInput& other) const {
+        return moveX == other.moveX && buttons == other.buttons && attackType == other.attackType;
+    }
+    bool operator!=(const PlayerInput& other) const { return !(*this == other); }
+};
+
+#endif
@@ -0,0 +1,41 @@
+#include "player_movement.h"
+#include <cmath>
+
+void PlayerMovement::simulate(PlayerMoveState& state, const MoveCommand& command, float deltaTime, World* world) {
+    // Movement stays on the ground plane whatever the pitch
+    float yaw = glm::radians(command.yaw);
+    glm::vec3 front(std::cos(yaw), 0.0f, std::sin(yaw));
+    glm::vec3 right = glm::normalize(glm::cross(front, glm::vec3(0.0f, 1.0f, 0.0f)));
+    
+    glm::vec3 wish = front * static_cast<float>(command.forward) + right * static_cast<float>(command.right);
+    if (glm::length(wish) > 0.0f) {
+        wish = glm::normalize(wish) * MOVE_SPEED;
+        state.velocity.x = wish.x;
+        state.velocity.z = wish.z;
+    } else {
+        state.velocity.x *= AIR_DAMPING;
+        state.velocity.z *= AIR_DAMPING;
+    }
+    
+    if ((command.buttons & MOVE_JUMP) && state.onGround) {
+        state.velocity.y = JUMP_FORCE;
+        state.onGround = false;
+    }
+    
+    state.velocity.y -= GRAVITY * deltaTime;
+    
+    // The capsule hangs below the eye position
+    Capsule capsule;
+    capsule.radius = RADIUS;
+    capsule.halfSegment = HEIGHT * 0.5f - RADIUS;
+    glm::vec3 eyeOffset(0.0f, HEIGHT * 0.5f, 0.0f);
+    
+    CapsuleMoveResult move = world->moveCapsule(state.position - eyeOffset, state.velocity * deltaTime, capsule);
+    
+    state.onGround = move.onGround;
+    if ((move.onGround && state.velocity.y < 0.0f) || (move.hitCeiling && state.velocity.y > 0.0f)) {
+        state.velocity.y = 0.0f;
+    }
+    
+    state.position = move.position + eyeOffset;
+}
@@ -0,0 +1,43 @@
+#ifndef PLAYER_MOVEMENT_H
+#define PLAYER_MOVEMENT_H
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "world.h"
+
+enum MoveButtons : uint8_t {
+    MOVE_JUMP = 1 << 0
+};
+
+// One simulation tick of FPS controls. The view yaw travels with the command so the
+// server moves the player in the same direction the client predicted.
+struct MoveCommand {
+    uint32_t sequence;
+    int8_t forward;     // -1 back, 0, 1 forward
+    int8_t right;       // -1 left, 0, 1 right
+    uint8_t buttons;    // MoveButtons
+    float yaw;          // Degrees, as in Camera::Yaw
+};
+
+// Everything a movement tick reads and writes. The eye position is what the camera uses.
+struct PlayerMoveState {
+    glm::vec3 position;
+    glm::vec3 velocity;
+    bool onGround;
+};
+
+// Deterministic FPS movement shared by client prediction and the authoritative server:
+// the same state and command against the same World always give the same result
+class PlayerMovement {
+public:
+    static void simulate(PlayerMoveState& state, const MoveCommand& command, float deltaTime, World* world);
+    
+    static constexpr float MOVE_SPEED = 5.0f;
+    static constexpr float JUMP_FORCE = 5.0f;
+    static constexpr float GRAVITY = 9.81f;
+    static constexpr float AIR_DAMPING = 0.9f;   // Horizontal speed kept per tick with no input
+    static constexpr float RADIUS = 0.5f;
+    static constexpr float HEIGHT = 1.75f;
+};
+
+#endif
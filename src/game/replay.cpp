@@ -0,0 +1,557 @@
+#include "replay.h"
+#include "simulation.h"
+#include "state_buffer.h"
+#include "../utils/hash.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static void writeVarint(std::vector<uint8_t>& out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+static bool readVarint(const uint8_t* in, uint32_t size, uint32_t& offset, uint32_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (offset >= size) {
+            return false;
+        }
+        uint8_t byte = in[offset++];
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Replay::save(const std::string& path) const {
+    std::vector<uint8_t> data;
+    StateWriter writer(data);
+    writer.write(MAGIC);
+    writer.write(VERSION);
+    writer.write(static_cast<uint16_t>(SIMULATION_TICK_RATE));
+    writer.write(static_cast<uint8_t>(SIMULATION_NUMBERS));
+    
+    // Field by field so padding never ends up in the file
+    writer.write(static_cast<uint8_t>(settings.mode));
+    writer.write(static_cast<int32_t>(settings.timeLimit));
+    writer.write(static_cast<int32_t>(settings.stockCount));
+    writer.write(static_cast<int32_t>(settings.staminaAmount));
+    writer.write(static_cast<uint8_t>(settings.itemsEnabled ? 1 : 0));
+    writer.write(settings.damageMultiplier);
+    writer.write(settings.knockbackMultiplier);
+    writer.write(settings.seed);
+    
+    writer.write(static_cast<uint8_t>(players.size()));
+    for (FighterType type : players) {
+        writer.write(static_cast<uint8_t>(type));
+    }
+    
+    std::vector<ReplayIndexEntry> index(keyframes.size());
+    for (size_t i = 0; i < keyframes.size(); i++) {
+        const ReplayKeyframe& keyframe = keyframes[i];
+        ReplayIndexEntry& entry = index[i];
+        entry.offset = data.size();
+        entry.hash = keyframe.hash;
+        entry.tick = keyframe.tick;
+        entry.stateSize = static_cast<uint32_t>(keyframe.state.size());
+        entry.tickHashCount = static_cast<uint32_t>(keyframe.tickHashes.size());
+        entry.recordSize = static_cast<uint32_t>(keyframe.records.size());
+        
+        writer.writeArray(keyframe.state);
+        writer.writeArray(keyframe.inputs);
+        writer.writeArray(keyframe.tickHashes);
+        writer.writeArray(keyframe.records);
+    }
+    
+    // The index is read in place from the mapping, so it has to be aligned
+    data.resize((data.size() + alignof(ReplayIndexEntry) - 1) & ~(alignof(ReplayIndexEntry) - 1), 0);
+    
+    ReplayFooter footer;
+    footer.indexOffset = data.size();
+    footer.keyframeCount = static_cast<uint32_t>(index.size());
+    footer.tickCount = tickCount;
+    footer.magic = FOOTER_MAGIC;
+    footer.reserved = 0;
+    
+    writer.writeArray(index);
+    writer.write(footer);
+    
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Failed to open replay file for writing: " << path << std::endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    return file.good();
+}
+
+ReplayRecorder::ReplayRecorder()
+    : m_recording(false)
+    , m_lastRecordTick(0)
+{
+}
+
+void ReplayRecorder::begin(const GameManager& game) {
+    m_replay = Replay();
+    m_replay.settings = game.getGameSettings();
+    
+    int playerCount = std::min(game.getPlayerCount(), Replay::MAX_PLAYERS);
+    for (int i = 0; i < playerCount; i++) {
+        m_replay.players.push_back(game.getPlayerType(i));
+    }
+    
+    // Every player starts from "no input", so only the first real input is stored
+    for (int i = 0; i < Replay::MAX_PLAYERS; i++) {
+        m_lastInputs[i] = PlayerInput::none();
+    }
+    m_recording = true;
+    
+    addKeyframe(game);
+}
+
+void ReplayRecorder::addKeyframe(const GameManager& game) {
+    m_replay.keyframes.emplace_back();
+    ReplayKeyframe& keyframe = m_replay.keyframes.back();
+    keyframe.tick = m_replay.tickCount;
+    game.saveState(keyframe.state);
+    keyframe.hash = hash64(keyframe.state.data(), keyframe.state.size());
+    keyframe.inputs.assign(m_lastInputs, m_lastInputs + m_replay.players.size());
+    
+    // Record deltas restart from each keyframe so chunks decode on their own
+    m_lastRecordTick = keyframe.tick;
+}
+
+void ReplayRecorder::recordTick(const PlayerInput* inputs, int count, const GameManager& game) {
+    if (!m_recording) {
+        return;
+    }
+    
+    uint32_t tick = m_replay.tickCount;
+    int playerCount = static_cast<int>(m_replay.players.size());
+    for (int i = 0; i < playerCount; i++) {
+        PlayerInput input = i < count ? inputs[i] : PlayerInput::none();
+        if (input != m_lastInputs[i]) {
+            writeRecord(tick, i, input);
+            m_lastInputs[i] = input;
+        }
+    }
+    
+    m_replay.keyframes.back().tickHashes.push_back(static_cast<uint32_t>(game.computeStateHash()));
+    
+    m_replay.tickCount++;
+    if (m_replay.tickCount % Replay::KEYFRAME_INTERVAL == 0) {
+        addKeyframe(game);
+    }
+}
+
+void ReplayRecorder::writeRecord(uint32_t tick, int player, const PlayerInput& input) {
+    std::vector<uint8_t>& records = m_replay.keyframes.back().records;
+    writeVarint(records, tick - m_lastRecordTick);
+    m_lastRecordTick = tick;
+    
+    bool hasAttackType = input.attackType != 0;
+    uint8_t packed = static_cast<uint8_t>(player & 0x7) |
+                     static_cast<uint8_t>((input.moveX + 1) & 0x3) << 3 |
+                     static_cast<uint8_t>(input.buttons & 0x3) << 5 |
+                     (hasAttackType ? 0x80 : 0);
+    records.push_back(packed);
+    if (hasAttackType) {
+        records.push_back(input.attackType);
+    }
+}
+
+bool ReplayRecorder::save(const std::string& path, const GameManager& game) {
+    if (!m_recording) {
+        return false;
+    }
+    
+    // Always end on a keyframe so playback verifies the final state
+    if (m_replay.keyframes.back().tick != m_replay.tickCount) {
+        addKeyframe(game);
+    }
+    
+    if (!m_replay.save(path)) {
+        return false;
+    }
+    
+    std::cout << "Saved replay " << path << ": " << m_replay.tickCount << " ticks, "
+              << m_replay.keyframes.size() << " keyframes" << std::endl;
+    return true;
+}
+
+ReplayFile::ReplayFile()
+    : m_data(nullptr)
+    , m_size(0)
+    , m_index(nullptr)
+    , m_keyframeCount(0)
+    , m_tickCount(0)
+{
+}
+
+ReplayFile::~ReplayFile() {
+    close();
+}
+
+bool ReplayFile::open(const std::string& path) {
+    close();
+    
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Failed to open replay file: " << path << std::endl;
+        return false;
+    }
+    
+    struct stat info;
+    if (fstat(fd, &info) < 0 || info.st_size < static_cast<off_t>(sizeof(ReplayFooter))) {
+        std::cerr << "Replay file is too small: " << path << std::endl;
+        ::close(fd);
+        return false;
+    }
+    
+    // The mapping stays valid after the descriptor is closed
+    void* mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Failed to map replay file: " << path << std::endl;
+        return false;
+    }
+    m_data = static_cast<const uint8_t*>(mapping);
+    m_size = static_cast<size_t>(info.st_size);
+    
+    StateReader reader(m_data, m_size);
+    uint32_t magic;
+    uint16_t version, tickRate;
+    if (!reader.read(magic) || magic != Replay::MAGIC || !reader.read(version) || version != Replay::VERSION) {
+        std::cerr << "Not a replay file or unsupported version: " << path << std::endl;
+        close();
+        return false;
+    }
+    if (!reader.read(tickRate) || tickRate != SIMULATION_TICK_RATE) {
+        std::cerr << "Replay was recorded at a different tick rate: " << path << std::endl;
+        close();
+        return false;
+    }
+    uint8_t numbers;
+    if (!reader.read(numbers) || numbers != static_cast<uint8_t>(SIMULATION_NUMBERS)) {
+        std::cerr << "Replay was recorded with a different FIXED_POINT_SIMULATION setting: " << path << std::endl;
+        close();
+        return false;
+    }
+    
+    uint8_t mode, itemsEnabled, playerCount;
+    int32_t timeLimit, stockCount, staminaAmount;
+    bool ok = reader.read(mode) && reader.read(timeLimit) && reader.read(stockCount) &&
+              reader.read(staminaAmount) && reader.read(itemsEnabled) &&
+              reader.read(m_settings.damageMultiplier) && reader.read(m_settings.knockbackMultiplier) &&
+              reader.read(m_settings.seed) && reader.read(playerCount) && playerCount <= Replay::MAX_PLAYERS;
+    
+    m_settings.mode = static_cast<GameMode>(mode);
+    m_settings.timeLimit = timeLimit;
+    m_settings.stockCount = stockCount;
+    m_settings.staminaAmount = staminaAmount;
+    m_settings.itemsEnabled = itemsEnabled != 0;
+    
+    m_players.clear();
+    for (int i = 0; ok && i < playerCount; i++) {
+        uint8_t type;
+        ok = reader.read(type);
+        m_players.push_back(static_cast<FighterType>(type));
+    }
+    
+    // Everything else is found through the footer; chunks are only checked when used
+    ReplayFooter footer;
+    std::memcpy(&footer, m_data + m_size - sizeof(footer), sizeof(footer));
+    size_t indexEnd = m_size - sizeof(footer);
+    ok = ok && footer.magic == Replay::FOOTER_MAGIC && footer.keyframeCount > 0 &&
+         footer.indexOffset % alignof(ReplayIndexEntry) == 0 && footer.indexOffset <= indexEnd &&
+         footer.keyframeCount <= (indexEnd - footer.indexOffset) / sizeof(ReplayIndexEntry);
+    
+    if (!ok) {
+        std::cerr << "Replay file is truncated or corrupt: " << path << std::endl;
+        close();
+        return false;
+    }
+    
+    m_index = reinterpret_cast<const ReplayIndexEntry*>(m_data + footer.indexOffset);
+    m_keyframeCount = footer.keyframeCount;
+    m_tickCount = footer.tickCount;
+    return true;
+}
+
+void ReplayFile::close() {
+    if (m_data) {
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_index = nullptr;
+    m_keyframeCount = 0;
+    m_tickCount = 0;
+    m_players.clear();
+}
+
+bool ReplayFile::getKeyframe(int index, ReplayKeyframeView& out) const {
+    if (index < 0 || index >= static_cast<int>(m_keyframeCount)) {
+        return false;
+    }
+    
+    const ReplayIndexEntry& entry = m_index[index];
+    size_t inputBytes = m_players.size() * sizeof(PlayerInput);
+    size_t hashBytes = static_cast<size_t>(entry.tickHashCount) * sizeof(uint32_t);
+    size_t chunkSize = static_cast<size_t>(entry.stateSize) + inputBytes + hashBytes + entry.recordSize;
+    if (entry.offset > m_size || chunkSize > m_size - entry.offset) {
+        return false;
+    }
+    
+    const uint8_t* chunk = m_data + entry.offset;
+    out.tick = entry.tick;
+    out.hash = entry.hash;
+    out.state = chunk;
+    out.stateSize = entry.stateSize;
+    out.inputs = reinterpret_cast<const PlayerInput*>(chunk + entry.stateSize);
+    out.tickHashes = chunk + entry.stateSize + inputBytes;
+    out.tickHashCount = entry.tickHashCount;
+    out.records = chunk + entry.stateSize + inputBytes + hashBytes;
+    out.recordSize = entry.recordSize;
+    return true;
+}
+
+int ReplayFile::findKeyframe(uint32_t tick) const {
+    const ReplayIndexEntry* end = m_index + m_keyframeCount;
+    const ReplayIndexEntry* after = std::upper_bound(m_index, end, tick,
+        [](uint32_t value, const ReplayIndexEntry& entry) { return value < entry.tick; });
+    return std::max(static_cast<int>(after - m_index) - 1, 0);
+}
+
+ReplayPlayer::ReplayPlayer(const ReplayFile& file)
+    : m_file(file)
+    , m_chunkIndex(-1)
+    , m_offset(0)
+    , m_tick(0)
+    , m_nextRecordTick(0)
+    , m_chunkEndTick(0)
+    , m_corrupt(false)
+{
+    std::memset(&m_chunk, 0, sizeof(m_chunk));
+    for (int i = 0; i < Replay::MAX_PLAYERS; i++) {
+        m_current[i] = PlayerInput::none();
+    }
+}
+
+bool ReplayPlayer::setup(GameManager& game) {
+    if (game.getPlayerCount() != 0) {
+        std::cerr << "Replay playback needs a GameManager without players" << std::endl;
+        return false;
+    }
+    
+    const std::vector<FighterType>& players = m_file.getPlayers();
+    game.getGameSettings() = m_file.getSettings();
+    for (size_t i = 0; i < players.size(); i++) {
+        game.addPlayer(players[i], static_cast<int>(i));
+    }
+    game.startGame();
+    
+    return enterChunk(0) && m_tick == 0;
+}
+
+bool ReplayPlayer::seek(GameManager& game, uint32_t tick) {
+    tick = std::min(tick, m_file.getTickCount());
+    if (!enterChunk(m_file.findKeyframe(tick)) ||
+        !game.loadState(m_chunk.state, m_chunk.stateSize)) {
+        m_corrupt = true;
+        return false;
+    }
+    
+    PlayerInput inputs[Replay::MAX_PLAYERS];
+    int playerCount = static_cast<int>(m_file.getPlayers().size());
+    while (m_tick < tick) {
+        if (!nextTick(inputs)) {
+            return false;
+        }
+        game.advanceTick(inputs, playerCount);
+    }
+    return true;
+}
+
+bool ReplayPlayer::enterChunk(int index) {
+    if (!m_file.getKeyframe(index, m_chunk)) {
+        m_corrupt = true;
+        return false;
+    }
+    
+    ReplayKeyframeView next;
+    m_chunkEndTick = m_file.getKeyframe(index + 1, next) ? next.tick : m_file.getTickCount();
+    m_chunkIndex = index;
+    
+    for (size_t i = 0; i < m_file.getPlayers().size(); i++) {
+        std::memcpy(&m_current[i], &m_chunk.inputs[i], sizeof(PlayerInput));
+    }
+    m_tick = m_chunk.tick;
+    m_offset = 0;
+    m_nextRecordTick = m_chunk.tick;
+    m_corrupt = false;
+    return readRecordTick();
+}
+
+bool ReplayPlayer::readRecordTick() {
+    if (m_offset == m_chunk.recordSize) {
+        m_nextRecordTick = UINT32_MAX;
+        return true;
+    }
+    
+    uint32_t delta;
+    if (!readVarint(m_chunk.records, m_chunk.recordSize, m_offset, delta)) {
+        m_corrupt = true;
+        return false;
+    }
+    m_nextRecordTick += delta;
+    return true;
+}
+
+bool ReplayPlayer::nextTick(PlayerInput* inputs) {
+    if (m_corrupt || m_chunkIndex < 0 || m_tick >= m_file.getTickCount()) {
+        return false;
+    }
+    
+    if (m_tick >= m_chunkEndTick && !enterChunk(m_chunkIndex + 1)) {
+        return false;
+    }
+    
+    const uint8_t* records = m_chunk.records;
+    int playerCount = static_cast<int>(m_file.getPlayers().size());
+    while (m_nextRecordTick == m_tick) {
+        if (m_offset >= m_chunk.recordSize) {
+            m_corrupt = true;
+            return false;
+        }
+        
+        uint8_t packed = records[m_offset++];
+        int player = packed & 0x7;
+        PlayerInput input;
+        input.moveX = static_cast<int8_t>(((packed >> 3) & 0x3) - 1);
+        input.buttons = (packed >> 5) & 0x3;
+        input.attackType = 0;
+        input.reserved = 0;
+        if (packed & 0x80) {
+            if (m_offset >= m_chunk.recordSize) {
+                m_corrupt = true;
+                return false;
+            }
+            input.attackType = records[m_offset++];
+        }
+        
+        if (player >= playerCount) {
+            m_corrupt = true;
+            return false;
+        }
+        m_current[player] = input;
+        
+        if (!readRecordTick()) {
+            return false;
+        }
+    }
+    
+    // Records are written in tick order within a chunk, so one behind us or past the
+    // chunk means the stream is damaged
+    if (m_nextRecordTick < m_tick || (m_nextRecordTick != UINT32_MAX && m_nextRecordTick >= m_chunkEndTick)) {
+        m_corrupt = true;
+        return false;
+    }
+    
+    for (int i = 0; i < playerCount; i++) {
+        inputs[i] = m_current[i];
+    }
+    m_tick++;
+    return true;
+}
+
+bool ReplayPlayer::getRecordedHash(uint32_t& hash) const {
+    // The last tick of a chunk was recorded at its end, before the next keyframe
+    uint32_t index = m_tick - m_chunk.tick - 1;
+    if (m_tick <= m_chunk.tick || index >= m_chunk.tickHashCount) {
+        return false;
+    }
+    std::memcpy(&hash, m_chunk.tickHashes + index * sizeof(uint32_t), sizeof(hash));
+    return true;
+}
+
+bool ReplayPlayer::playHeadless(const ReplayFile& file, ReplayPlaybackResult& result) {
+    result = ReplayPlaybackResult();
+    
+    GameManager game;
+    game.init();
+    
+    ReplayPlayer player(file);
+    if (!player.setup(game)) {
+        return false;
+    }
+    
+    PlayerInput inputs[Replay::MAX_PLAYERS];
+    int playerCount = static_cast<int>(file.getPlayers().size());
+    std::vector<uint8_t> state;
+    
+    // Keyframe 0 is the starting state, checked before anything runs
+    int nextKeyframe = 0;
+    ReplayKeyframeView keyframe;
+    bool haveKeyframe = file.getKeyframe(nextKeyframe, keyframe);
+    
+    auto start = std::chrono::steady_clock::now();
+    while (true) {
+        uint64_t hash = game.computeStateHash();
+        
+        uint32_t recorded;
+        if (player.getRecordedHash(recorded)) {
+            if (static_cast<uint32_t>(hash) == recorded) {
+                result.ticksVerified++;
+            } else if (result.firstMismatchTick < 0) {
+                result.firstMismatchTick = player.getTick();
+            }
+        }
+        
+        while (haveKeyframe && keyframe.tick == player.getTick()) {
+            if (hash == keyframe.hash) {
+                result.keyframesVerified++;
+            } else {
+                if (result.firstMismatchTick < 0) {
+                    result.firstMismatchTick = keyframe.tick;
+                }
+                if (result.mismatchDiff.empty()) {
+                    game.saveState(state);
+                    GameManager::diffStates(keyframe.state, keyframe.stateSize, state.data(), state.size(), result.mismatchDiff);
+                }
+            }
+            haveKeyframe = file.getKeyframe(++nextKeyframe, keyframe);
+        }
+        
+        if (!player.nextTick(inputs)) {
+            break;
+        }
+        game.advanceTick(inputs, playerCount);
+    }
+    auto end = std::chrono::steady_clock::now();
+    
+    result.ticksPlayed = player.getTick();
+    result.seconds = std::chrono::duration<double>(end - start).count();
+    if (result.seconds > 0.0) {
+        result.ticksPerSecond = result.ticksPlayed / result.seconds;
+        result.realtimeFactor = result.ticksPerSecond / SIMULATION_TICK_RATE;
+    }
+    
+    if (player.isCorrupt()) {
+        std::cerr << "Replay input stream is corrupt at tick " << player.getTick() << std::endl;
+        return false;
+    }
+    return result.ticksPlayed == file.getTickCount() && result.firstMismatchTick < 0;
+}
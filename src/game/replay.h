@@ -0,0 +1,202 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "game_manager.h"
+#include "player_input.h"
+
+// Replay files hold everything needed to re-run a match: starting settings, the
+// fighters in join order, and every tick's inputs. The simulation is deterministic for
+// a given build, so these reproduce the match exactly. Builds with FIXED_POINT_SIMULATION
+// can play each other's replays whatever compiler or flags they were built with.
+//
+// Layout:
+//   header   magic, version, tick rate, SimNumbers, settings, fighter types
+//   chunks   one per keyframe: full simulation state, each player's input in effect at
+//            the keyframe tick, the low 32 bits of the state hash after every tick up
+//            to the next keyframe, then the input change records for those ticks
+//   index    one ReplayIndexEntry per keyframe, 8-byte aligned
+//   footer   ReplayFooter, fixed size at the very end of the file
+//
+// Input change records are a varint tick delta from the previous record (the first from
+// the keyframe tick) followed by one packed byte: player (3 bits), moveX + 1 (2 bits),
+// buttons (2 bits) and a flag for a trailing attack type byte.
+//
+// The last keyframe always sits on the final tick, so playback can check the end state.
+
+struct ReplayIndexEntry {
+    uint64_t offset;      // Start of the chunk
+    uint64_t hash;        // GameManager::computeStateHash at this keyframe
+    uint32_t tick;
+    uint32_t stateSize;
+    uint32_t tickHashCount;
+    uint32_t recordSize;  // Bytes of change records at the end of the chunk
+};
+
+struct ReplayFooter {
+    uint64_t indexOffset;
+    uint32_t keyframeCount;
+    uint32_t tickCount;
+    uint32_t magic;
+    uint32_t reserved;
+};
+
+struct ReplayKeyframe {
+    uint32_t tick;
+    uint64_t hash;
+    std::vector<uint8_t> state;
+    std::vector<PlayerInput> inputs;
+    std::vector<uint32_t> tickHashes;
+    std::vector<uint8_t> records;
+};
+
+// A replay being built in memory, written out in one go by save()
+struct Replay {
+    static constexpr uint32_t MAGIC = 0x50524653;         // "SFRP"
+    static constexpr uint32_t FOOTER_MAGIC = 0x58444e49;  // "INDX"
+    static constexpr uint16_t VERSION = 5;
+    static constexpr int MAX_PLAYERS = 8;
+    
+    // Bounds how far a seek has to resimulate
+    static constexpr uint32_t KEYFRAME_INTERVAL = 120;
+    
+    GameSettings settings;
+    std::vector<FighterType> players;
+    uint32_t tickCount = 0;
+    std::vector<ReplayKeyframe> keyframes;
+    
+    bool save(const std::string& path) const;
+};
+
+// Fed by GameManager::advanceTick while attached, so it sees exactly the inputs the
+// simulation applied regardless of who produced them
+class ReplayRecorder {
+public:
+    ReplayRecorder();
+    
+    // Captures settings, fighters and the first keyframe; call once the match has started
+    void begin(const GameManager& game);
+    void recordTick(const PlayerInput* inputs, int count, const GameManager& game);
+    
+    // Closes the replay on a keyframe and writes the file
+    bool save(const std::string& path, const GameManager& game);
+    
+    bool isRecording() const { return m_recording; }
+    const Replay& getReplay() const { return m_replay; }
+    
+private:
+    Replay m_replay;
+    bool m_recording;
+    PlayerInput m_lastInputs[Replay::MAX_PLAYERS];
+    uint32_t m_lastRecordTick;
+    
+    void addKeyframe(const GameManager& game);
+    void writeRecord(uint32_t tick, int player, const PlayerInput& input);
+};
+
+// Points into a mapped replay file; valid while the ReplayFile stays open
+struct ReplayKeyframeView {
+    uint32_t tick;
+    uint64_t hash;
+    const uint8_t* state;
+    uint32_t stateSize;
+    const PlayerInput* inputs;
+    const uint8_t* tickHashes;  // Unaligned uint32_t, the first for tick + 1
+    uint32_t tickHashCount;
+    const uint8_t* records;
+    uint32_t recordSize;
+};
+
+// Read-only view of a replay file through mmap. Opening reads only the header and footer,
+// so it costs the same for any length of replay; chunks are paged in as they're used.
+class ReplayFile {
+public:
+    ReplayFile();
+    ~ReplayFile();
+    
+    bool open(const std::string& path);
+    void close();
+    
+    bool isOpen() const { return m_data != nullptr; }
+    const GameSettings& getSettings() const { return m_settings; }
+    const std::vector<FighterType>& getPlayers() const { return m_players; }
+    uint32_t getTickCount() const { return m_tickCount; }
+    int getKeyframeCount() const { return static_cast<int>(m_keyframeCount); }
+    size_t getFileSize() const { return m_size; }
+    
+    // False if the entry points outside the file
+    bool getKeyframe(int index, ReplayKeyframeView& out) const;
+    
+    // Last keyframe at or before `tick`
+    int findKeyframe(uint32_t tick) const;
+    
+private:
+    const uint8_t* m_data;
+    size_t m_size;
+    const ReplayIndexEntry* m_index;
+    uint32_t m_keyframeCount;
+    uint32_t m_tickCount;
+    GameSettings m_settings;
+    std::vector<FighterType> m_players;
+    
+    ReplayFile(const ReplayFile&) = delete;
+    ReplayFile& operator=(const ReplayFile&) = delete;
+};
+
+struct ReplayPlaybackResult {
+    uint32_t ticksPlayed = 0;
+    uint32_t ticksVerified = 0;
+    uint32_t keyframesVerified = 0;
+    int64_t firstMismatchTick = -1;  // -1 when every hash matched
+    std::vector<std::string> mismatchDiff;  // Fields that differ at the first bad keyframe
+    double seconds = 0.0;
+    double ticksPerSecond = 0.0;
+    double realtimeFactor = 0.0;
+};
+
+// Steps a GameManager through a replay one tick at a time
+class ReplayPlayer {
+public:
+    ReplayPlayer(const ReplayFile& file);
+    
+    // Applies settings and fighters to a GameManager that has had init() called, then
+    // starts the match at tick 0
+    bool setup(GameManager& game);
+    
+    // Restores the nearest keyframe at or before `tick` and resimulates the rest, so no
+    // seek runs more than KEYFRAME_INTERVAL - 1 ticks. `game` must have been set up.
+    bool seek(GameManager& game, uint32_t tick);
+    
+    // Fills one input per replay player for the next tick. Returns false at the end of
+    // the replay or if the stream is corrupt.
+    bool nextTick(PlayerInput* inputs);
+    
+    uint32_t getTick() const { return m_tick; }
+    bool isCorrupt() const { return m_corrupt; }
+    
+    // Recorded hash of the state after the most recent nextTick()
+    bool getRecordedHash(uint32_t& hash) const;
+    
+    // Re-runs the whole match without rendering or frame pacing, checking the state hash
+    // after every tick and diffing against the recorded state at the first bad keyframe.
+    // Returns false if the replay couldn't be played to the end or diverged.
+    static bool playHeadless(const ReplayFile& file, ReplayPlaybackResult& result);
+    
+private:
+    const ReplayFile& m_file;
+    ReplayKeyframeView m_chunk;
+    int m_chunkIndex;
+    PlayerInput m_current[Replay::MAX_PLAYERS];
+    uint32_t m_offset;
+    uint32_t m_tick;
+    uint32_t m_nextRecordTick;
+    uint32_t m_chunkEndTick;
+    bool m_corrupt;
+    
+    bool enterChunk(int index);
+    bool readRecordTick();
+};
+
+#endif
@@ -0,0 +1,264 @@
+#include "rollback_session.h"
+#include "../utils/hash.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+static double microsecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+RollbackSession::RollbackSession(GameManager* game)
+    : m_game(game)
+    , m_playerCount(std::min(game->getPlayerCount(), static_cast<int>(MAX_PLAYERS)))
+    , m_currentFrame(0)
+    , m_rollbackFrame(-1)
+    , m_hashedThrough(0)
+{
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        m_confirmedThrough[i] = 0;
+        m_lastConfirmed[i] = PlayerInput::none();
+    }
+    
+    for (int i = 0; i < RING_SIZE; i++) {
+        m_frames[i].frame = UINT32_MAX;
+        m_frames[i].confirmedMask = 0;
+    }
+    
+    for (int i = 0; i < HASH_HISTORY; i++) {
+        m_hashes[i].frame = UINT32_MAX;
+        m_hashes[i].hasLocal = false;
+        m_hashes[i].hasRemote = false;
+    }
+}
+
+RollbackSession::FrameSlot& RollbackSession::slotFor(uint32_t frame) {
+    FrameSlot& slot = m_frames[frame % RING_SIZE];
+    if (slot.frame != frame) {
+        // Recycling a slot from RING_SIZE frames ago; its snapshot buffer is kept
+        slot.frame = frame;
+        slot.confirmedMask = 0;
+        for (int i = 0; i < MAX_PLAYERS; i++) {
+            slot.inputs[i] = PlayerInput::none();
+        }
+    }
+    return slot;
+}
+
+PlayerInput RollbackSession::predictInput(int player, uint32_t frame) const {
+    // Most recent confirmed input at or before this frame that's still in the ring
+    uint32_t oldest = frame >= RING_SIZE - 1 ? frame - (RING_SIZE - 1) : 0;
+    for (uint32_t f = frame + 1; f-- > oldest;) {
+        const FrameSlot& slot = m_frames[f % RING_SIZE];
+        if (slot.frame == f && (slot.confirmedMask & (1u << player))) {
+            return slot.inputs[player];
+        }
+    }
+    return m_lastConfirmed[player];
+}
+
+void RollbackSession::fillPredictions(FrameSlot& slot) {
+    for (int player = 0; player < m_playerCount; player++) {
+        if (!(slot.confirmedMask & (1u << player))) {
+            slot.inputs[player] = predictInput(player, slot.frame);
+        }
+    }
+}
+
+void RollbackSession::addLocalInput(int player, const PlayerInput& input) {
+    addRemoteInput(player, m_currentFrame, input);
+}
+
+bool RollbackSession::addRemoteInput(int player, uint32_t frame, const PlayerInput& input) {
+    if (player < 0 || player >= m_playerCount) {
+        return false;
+    }
+    
+    // Its snapshot has already been recycled
+    if (frame + MAX_ROLLBACK_FRAMES < m_currentFrame) {
+        m_stats.lateInputs++;
+        return false;
+    }
+    
+    // Storing it would overwrite history we may still need
+    if (frame >= m_currentFrame + (RING_SIZE - MAX_ROLLBACK_FRAMES - 1)) {
+        return false;
+    }
+    
+    FrameSlot& slot = slotFor(frame);
+    uint8_t bit = static_cast<uint8_t>(1u << player);
+    if (slot.confirmedMask & bit) {
+        return true;  // Duplicate
+    }
+    
+    // Already simulated with a guess; roll back if the guess was wrong
+    if (frame < m_currentFrame && slot.inputs[player] != input) {
+        if (m_rollbackFrame < 0 || frame < m_rollbackFrame) {
+            m_rollbackFrame = frame;
+        }
+    }
+    
+    slot.inputs[player] = input;
+    slot.confirmedMask |= bit;
+    
+    // Advance the contiguous confirmed range for this player
+    while (true) {
+        const FrameSlot& next = m_frames[m_confirmedThrough[player] % RING_SIZE];
+        if (next.frame != m_confirmedThrough[player] || !(next.confirmedMask & bit)) {
+            break;
+        }
+        m_lastConfirmed[player] = next.inputs[player];
+        m_confirmedThrough[player]++;
+    }
+    
+    return true;
+}
+
+bool RollbackSession::canAdvance() const {
+    for (int player = 0; player < m_playerCount; player++) {
+        if (m_currentFrame >= m_confirmedThrough[player] + MAX_ROLLBACK_FRAMES) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void RollbackSession::rollback() {
+    auto start = std::chrono::steady_clock::now();
+    uint32_t firstFrame = static_cast<uint32_t>(m_rollbackFrame);
+    m_rollbackFrame = -1;
+    
+    FrameSlot& first = m_frames[firstFrame % RING_SIZE];
+    if (first.frame != firstFrame || !m_game->loadState(first.state.data(), first.state.size())) {
+        return;
+    }
+    
+    for (uint32_t frame = firstFrame; frame < m_currentFrame; frame++) {
+        FrameSlot& slot = m_frames[frame % RING_SIZE];
+        fillPredictions(slot);
+        
+        // The restored snapshot is already correct for the first frame
+        if (frame != firstFrame) {
+            m_game->saveState(slot.state);
+        }
+        m_game->advanceTick(slot.inputs, m_playerCount);
+    }
+    
+    int frames = static_cast<int>(m_currentFrame - firstFrame);
+    m_stats.rollbacks++;
+    m_stats.framesResimulated += frames;
+    m_stats.lastRollbackFrames = frames;
+    m_stats.lastRollbackMicroseconds = microsecondsSince(start);
+    m_stats.maxRollbackMicroseconds = std::max(m_stats.maxRollbackMicroseconds, m_stats.lastRollbackMicroseconds);
+}
+
+void RollbackSession::advanceFrame() {
+    if (m_rollbackFrame >= 0) {
+        rollback();
+    }
+    
+    FrameSlot& slot = slotFor(m_currentFrame);
+    fillPredictions(slot);
+    
+    auto start = std::chrono::steady_clock::now();
+    m_game->saveState(slot.state);
+    m_stats.lastSaveMicroseconds = microsecondsSince(start);
+    
+    hashConfirmedFrames();
+    
+    m_game->advanceTick(slot.inputs, m_playerCount);
+    m_stats.framesSimulated++;
+    m_currentFrame++;
+}
+
+void RollbackSession::hashConfirmedFrames() {
+    // The state at the start of a frame is final once every input before it is confirmed.
+    // Any rollback has already run, so snapshots up to the current frame are correct.
+    uint32_t confirmed = m_currentFrame;
+    for (int player = 0; player < m_playerCount; player++) {
+        confirmed = std::min(confirmed, m_confirmedThrough[player]);
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    bool hashed = false;
+    while (m_hashedThrough <= confirmed) {
+        const FrameSlot& slot = m_frames[m_hashedThrough % RING_SIZE];
+        HashEntry* entry = hashEntryFor(m_hashedThrough);
+        if (slot.frame == m_hashedThrough && entry) {
+            entry->local = hash64(slot.state.data(), slot.state.size());
+            entry->state = slot.state;
+            entry->hasLocal = true;
+            if (entry->hasRemote) {
+                compareHashes(*entry);
+            }
+            hashed = true;
+        }
+        m_hashedThrough++;
+    }
+    
+    if (hashed) {
+        m_stats.lastHashMicroseconds = microsecondsSince(start);
+    }
+}
+
+RollbackSession::HashEntry* RollbackSession::hashEntryFor(uint32_t frame) {
+    HashEntry& entry = m_hashes[frame % HASH_HISTORY];
+    if (entry.frame != frame) {
+        // Never let an old frame evict a newer one
+        if (entry.frame != UINT32_MAX && entry.frame > frame) {
+            return nullptr;
+        }
+        entry.frame = frame;
+        entry.hasLocal = false;
+        entry.hasRemote = false;
+    }
+    return &entry;
+}
+
+bool RollbackSession::compareHashes(const HashEntry& entry) {
+    m_stats.hashesCompared++;
+    if (entry.local == entry.remote) {
+        return true;
+    }
+    
+    m_stats.desyncs++;
+    if (m_stats.firstDesyncFrame < 0) {
+        m_stats.firstDesyncFrame = entry.frame;
+        std::cerr << "Desync at frame " << entry.frame << ": local hash " << std::hex << entry.local
+                  << " remote " << entry.remote << std::dec << std::endl;
+    }
+    return false;
+}
+
+bool RollbackSession::getConfirmedHash(uint32_t frame, uint64_t& hash) const {
+    const HashEntry& entry = m_hashes[frame % HASH_HISTORY];
+    if (entry.frame != frame || !entry.hasLocal) {
+        return false;
+    }
+    hash = entry.local;
+    return true;
+}
+
+const std::vector<uint8_t>* RollbackSession::getConfirmedState(uint32_t frame) const {
+    const HashEntry& entry = m_hashes[frame % HASH_HISTORY];
+    if (entry.frame != frame || !entry.hasLocal) {
+        return nullptr;
+    }
+    return &entry.state;
+}
+
+bool RollbackSession::checkRemoteHash(uint32_t frame, uint64_t hash) {
+    // Too old to still have our side, or too far ahead to hold without evicting it
+    if (frame + HASH_HISTORY <= m_hashedThrough || frame >= m_hashedThrough + HASH_HISTORY) {
+        return true;
+    }
+    
+    HashEntry* entry = hashEntryFor(frame);
+    if (!entry || entry->hasRemote) {
+        return true;
+    }
+    
+    entry->remote = hash;
+    entry->hasRemote = true;
+    return !entry->hasLocal || compareHashes(*entry);
+}
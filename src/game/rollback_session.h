@@ -0,0 +1,105 @@
+#ifndef ROLLBACK_SESSION_H
+#define ROLLBACK_SESSION_H
+
+#include <vector>
+#include <cstdint>
+#include "game_manager.h"
+#include "player_input.h"
+
+struct RollbackStats {
+    uint64_t framesSimulated = 0;
+    uint64_t rollbacks = 0;
+    uint64_t framesResimulated = 0;
+    uint64_t lateInputs = 0;          // Arrived after leaving the rollback window
+    int lastRollbackFrames = 0;
+    double lastRollbackMicroseconds = 0.0;
+    double maxRollbackMicroseconds = 0.0;
+    double lastSaveMicroseconds = 0.0;
+    double lastHashMicroseconds = 0.0;
+    uint64_t hashesCompared = 0;
+    uint64_t desyncs = 0;
+    int64_t firstDesyncFrame = -1;
+};
+
+// GGPO-style rollback driver around a GameManager. Every frame is simulated right away
+// with predicted input for players we haven't heard from (their last known input).
+// When a real input turns out to differ from the prediction, the session restores the
+// snapshot taken at that frame and re-simulates up to the present.
+class RollbackSession {
+public:
+    static const int MAX_PLAYERS = 8;
+    static const int MAX_ROLLBACK_FRAMES = 8;
+    
+    RollbackSession(GameManager* game);
+    
+    // Input for the frame about to be simulated, from a player on this machine
+    void addLocalInput(int player, const PlayerInput& input);
+    
+    // Input from the network for any frame inside the window; returns false if too late
+    // or too far ahead to use
+    bool addRemoteInput(int player, uint32_t frame, const PlayerInput& input);
+    
+    // False while some player's confirmed input is a full rollback window behind,
+    // in which case the caller should wait instead of predicting further
+    bool canAdvance() const;
+    
+    // Applies any pending rollback, then simulates the current frame
+    void advanceFrame();
+    
+    // Hash of the state at the start of `frame`, available once every input before it is
+    // confirmed. Peers send these to each other and compare them with checkRemoteHash.
+    bool getConfirmedHash(uint32_t frame, uint64_t& hash) const;
+    
+    // Compares a peer's hash for a frame, now or once we've confirmed it ourselves.
+    // Returns false on a desync. Frames outside the hash history are ignored.
+    bool checkRemoteHash(uint32_t frame, uint64_t hash);
+    
+    // The confirmed snapshot behind getConfirmedHash, so peers can exchange states after
+    // a desync and GameManager::diffStates them. Null once the frame has been forgotten.
+    const std::vector<uint8_t>* getConfirmedState(uint32_t frame) const;
+    
+    uint32_t getCurrentFrame() const { return m_currentFrame; }
+    const RollbackStats& getStats() const { return m_stats; }
+    
+private:
+    static const int RING_SIZE = 16;
+    static const int HASH_HISTORY = 64;
+    
+    struct FrameSlot {
+        uint32_t frame;
+        uint8_t confirmedMask;
+        PlayerInput inputs[MAX_PLAYERS];
+        std::vector<uint8_t> state;  // Snapshot taken before simulating this frame
+    };
+    
+    // Confirmed frames outlive the input ring so late hashes from peers can be checked
+    struct HashEntry {
+        uint32_t frame;
+        bool hasLocal;
+        bool hasRemote;
+        uint64_t local;
+        uint64_t remote;
+        std::vector<uint8_t> state;
+    };
+    
+    GameManager* m_game;
+    int m_playerCount;
+    uint32_t m_currentFrame;
+    int64_t m_rollbackFrame;                  // Earliest mispredicted frame, or -1
+    uint32_t m_confirmedThrough[MAX_PLAYERS]; // First frame without confirmed input
+    PlayerInput m_lastConfirmed[MAX_PLAYERS];
+    FrameSlot m_frames[RING_SIZE];
+    uint32_t m_hashedThrough;                 // First frame without a confirmed hash
+    HashEntry m_hashes[HASH_HISTORY];
+    RollbackStats m_stats;
+    
+    FrameSlot& slotFor(uint32_t frame);
+    PlayerInput predictInput(int player, uint32_t frame) const;
+    void fillPredictions(FrameSlot& slot);
+    void rollback();
+    void hashConfirmedFrames();
+    HashEntry* hashEntryFor(uint32_t frame);
+    bool compareHashes(const HashEntry& entry);
+};
+
+#endif
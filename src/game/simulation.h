@@ -0,0 +1,60 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <cstdint>
+#include <cmath>
+#include <cfloat>
+#include <glm/glm.hpp>
+#include "fixed.h"
+
+// Fixed rate the match simulation steps at. Timers, input and networking all count in
+// these ticks.
+const int SIMULATION_TICK_RATE = 60;
+const float SIMULATION_TICK_DURATION = 1.0f / SIMULATION_TICK_RATE;
+
+// Rounds up so a timer never ends before the requested duration
+inline uint32_t secondsToTicks(float seconds) {
+    return static_cast<uint32_t>(std::ceil(seconds * SIMULATION_TICK_RATE - 0.001f));
+}
+
+// Number types for fighter and stage physics. Float by default. Building with
+// FIXED_POINT_SIMULATION switches to Q16.16, whose results don't depend on the
+// compiler, its flags (FMA contraction, x87 vs SSE) or the CPU, so differently built
+// clients can share a lockstep or rollback match. toVec2/toFloat convert for rendering,
+// networking and other code outside the simulation.
+enum class SimNumbers : uint8_t {
+    FLOAT,
+    FIXED
+};
+
+#ifdef FIXED_POINT_SIMULATION
+const SimNumbers SIMULATION_NUMBERS = SimNumbers::FIXED;
+
+typedef Fixed SimScalar;
+typedef FixedVec2 SimVec2;
+
+inline float toFloat(Fixed value) { return value.toFloat(); }
+inline glm::vec2 toVec2(const FixedVec2& value) { return glm::vec2(value.x.toFloat(), value.y.toFloat()); }
+inline FixedVec2 toSimVec2(const glm::vec2& value) { return FixedVec2(Fixed(value.x), Fixed(value.y)); }
+
+const Fixed SIM_SCALAR_MAX = Fixed::max();
+const Fixed SIM_SCALAR_MIN = Fixed::min();
+#else
+const SimNumbers SIMULATION_NUMBERS = SimNumbers::FLOAT;
+
+typedef float SimScalar;
+typedef glm::vec2 SimVec2;
+
+inline float toFloat(float value) { return value; }
+inline const glm::vec2& toVec2(const glm::vec2& value) { return value; }
+inline const glm::vec2& toSimVec2(const glm::vec2& value) { return value; }
+
+const float SIM_SCALAR_MAX = FLT_MAX;
+const float SIM_SCALAR_MIN = -FLT_MAX;
+#endif
+
+inline SimScalar simAbs(SimScalar value) { return value < SimScalar(0) ? -value : value; }
+
+const SimScalar SIM_TICK_DURATION = SimScalar(SIMULATION_TICK_DURATION);
+
+#endif
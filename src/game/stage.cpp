@@ -1,4 +1,5 @@
 #include "stage.h"
+#include "fighter_systems.h"
 #include <algorithm>
 #include <glm/gtc/matrix_transform.hpp>
 
@@ -34,23 +35,24 @@ Stage::~Stage() {
     // Texture is managed by ResourceManager
 }
 
-void Stage::update(float deltaTime, std::vector<Character*>& characters) {
+void Stage::update(SimScalar deltaTime, FighterComponents& fighters) const {
     // Update all characters based on stage physics
-    for (auto character : characters) {
-        resolveCharacterCollisions(character, deltaTime);
+    int count = fighters.size();
+    for (int i = 0; i < count; i++) {
+        resolveCharacterCollisions(fighters, i, deltaTime);
         
         // Check if character is on ground
-        character->setOnGround(isCharacterOnGround(character));
+        fighters.setFlag(i, FLAG_ON_GROUND, isCharacterOnGround(fighters.m_positions[i], fighters.m_sizes[i]));
         
         // Check if character is out of bounds
-        if (isCharacterOutOfBounds(character)) {
+        if (isCharacterOutOfBounds(fighters.m_positions[i])) {
             // Character lost a life
-            character->takeDamage(0, 0, glm::vec2(0.0f)); // Just to trigger life loss logic
+            FighterSystems::applyDamage(fighters, i, 0, SimScalar(0), SimVec2(0.0f, 0.0f)); // Just to trigger life loss logic
             
             // Respawn character if they have lives left
-            if (character->getLives() > 0) {
-                character->setPosition(getSpawnPosition(0)); // Use player index in a real game
-                character->setVelocity(glm::vec2(0.0f, 0.0f));
+            if (fighters.m_lives[i] > 0) {
+                fighters.m_positions[i] = toSimVec2(getSpawnPosition(0)); // Use player index in a real game
+                fighters.m_velocities[i] = SimVec2(0.0f, 0.0f);
             }
         }
     }
@@ -74,65 +76,70 @@ void Stage::addPlatform(const glm::vec2& position, const glm::vec2& size, Platfo
     m_platforms.push_back(platform);
 }
 
-void Stage::resolveCharacterCollisions(Character* character, float deltaTime) {
-    glm::vec2 position = character->getPosition();
-    glm::vec2 velocity = character->getVelocity();
-    glm::vec2 size = character->getSize();
+void Stage::resolveCharacterCollisions(FighterComponents& fighters, int entity, SimScalar deltaTime) const {
+    const SimScalar ZERO = SimScalar(0);
+    SimVec2 position = fighters.m_positions[entity];
+    SimVec2 velocity = fighters.m_velocities[entity];
+    SimVec2 size = fighters.m_sizes[entity];
     
-    // Apply velocity to get new position
-    glm::vec2 newPosition = position + velocity * deltaTime;
+    // Sweep the character along its movement for this frame so fast knockback can't
+    // skip over thin platforms. Each hit stops the motion into the surface and the
+    // remaining displacement slides along it.
+    SimVec2 remaining = velocity * deltaTime;
     
-    // Check for platform collisions
-    for (auto platform : m_platforms) {
-        // For semi-solid platforms, only check collision if character is falling
-        if (platform->getType() == PlatformType::SEMI_SOLID && velocity.y >= 0) {
-            continue;
+    for (int iteration = 0; iteration < MAX_SWEEP_ITERATIONS; iteration++) {
+        if (remaining.x == ZERO && remaining.y == ZERO) {
+            break;
         }
         
-        // Check if character would collide with platform
-        if (platform->checkCollision(newPosition, size)) {
-            // Resolve collision
-            
-            // Try horizontal movement only
-            glm::vec2 horizontalPos = position + glm::vec2(velocity.x * deltaTime, 0.0f);
-            if (!platform->checkCollision(horizontalPos, size)) {
-                newPosition.x = horizontalPos.x;
-                velocity.x = velocity.x; // Keep horizontal velocity
-                velocity.y = 0.0f;       // Reset vertical velocity
-            }
-            // Try vertical movement only
-            else {
-                glm::vec2 verticalPos = position + glm::vec2(0.0f, velocity.y * deltaTime);
-                if (!platform->checkCollision(verticalPos, size)) {
-                    newPosition.y = verticalPos.y;
-                    velocity.y = velocity.y; // Keep vertical velocity
-                    velocity.x = 0.0f;       // Reset horizontal velocity
-                }
-                // If both fail, don't move
-                else {
-                    newPosition = position;
-                    velocity = glm::vec2(0.0f);
-                }
+        // Find the earliest platform hit along the remaining displacement
+        SimScalar earliestImpact = SimScalar(1);
+        SimVec2 hitNormal(ZERO);
+        bool hit = false;
+        
+        for (auto platform : m_platforms) {
+            SimScalar timeOfImpact;
+            SimVec2 normal;
+            if (platform->sweepCollision(position, size, remaining, timeOfImpact, normal) &&
+                timeOfImpact < earliestImpact) {
+                earliestImpact = timeOfImpact;
+                hitNormal = normal;
+                hit = true;
             }
         }
+        
+        position += remaining * earliestImpact;
+        if (!hit) {
+            break;
+        }
+        
+        // Keep a small gap so the next sweep starts outside the platform
+        position += hitNormal * CONTACT_SKIN;
+        
+        // Remove the blocked component and slide with what's left
+        remaining *= (SimScalar(1) - earliestImpact);
+        if (hitNormal.x != ZERO) {
+            remaining.x = ZERO;
+            velocity.x = ZERO;
+        } else {
+            remaining.y = ZERO;
+            velocity.y = ZERO;
+        }
     }
     
     // Update character position and velocity
-    character->setPosition(newPosition);
-    character->setVelocity(velocity);
+    fighters.m_positions[entity] = position;
+    fighters.m_velocities[entity] = velocity;
 }
 
-bool Stage::isCharacterOnGround(Character* character) {
-    glm::vec2 position = character->getPosition();
-    glm::vec2 size = character->getSize();
-    
+bool Stage::isCharacterOnGround(const SimVec2& position, const SimVec2& size) const {
     // Check position slightly below the character
-    glm::vec2 groundCheckPos = position - glm::vec2(0.0f, 0.1f);
+    SimVec2 groundCheckPos = position - SimVec2(0.0f, 0.1f);
     
     for (auto platform : m_platforms) {
         // For semi-solid platforms, check if character is above the platform
         if (platform->getType() == PlatformType::SEMI_SOLID) {
-            if (platform->checkCollisionFromAbove(position, size, glm::vec2(0.0f, -0.1f))) {
+            if (platform->checkCollisionFromAbove(position, size, SimVec2(0.0f, -0.1f))) {
                 return true;
             }
         }
@@ -147,16 +154,14 @@ bool Stage::isCharacterOnGround(Character* character) {
     return false;
 }
 
-bool Stage::isCharacterOutOfBounds(Character* character) {
-    glm::vec2 position = character->getPosition();
-    
-    return position.x < m_blastZone.left ||
-           position.x > m_blastZone.right ||
-           position.y < m_blastZone.bottom ||
-           position.y > m_blastZone.top;
+bool Stage::isCharacterOutOfBounds(const SimVec2& position) const {
+    return position.x < SimScalar(m_blastZone.left) ||
+           position.x > SimScalar(m_blastZone.right) ||
+           position.y < SimScalar(m_blastZone.bottom) ||
+           position.y > SimScalar(m_blastZone.top);
 }
 
-glm::vec2 Stage::getSpawnPosition(int playerIndex) {
+glm::vec2 Stage::getSpawnPosition(int playerIndex) const {
     if (playerIndex >= 0 && playerIndex < m_spawnPositions.size()) {
         return m_spawnPositions[playerIndex];
     }
@@ -2,9 +2,10 @@
 #define STAGE_H
 
 #include <vector>
+#include <string>
 #include <glm/glm.hpp>
 #include "platform.h"
-#include "character.h"
+#include "fighter_components.h"
 #include "../rendering/shader.h"
 
 // Represents the boundaries of the stage
@@ -20,17 +21,18 @@ public:
     Stage(const std::string& name = "Default Stage");
     ~Stage();
     
-    void update(float deltaTime, std::vector<Character*>& characters);
+    // Only reads the stage, so one Stage can back any number of matches on any threads
+    void update(SimScalar deltaTime, FighterComponents& fighters) const;
     void render(Shader& shader);
     
     // Platform management
     void addPlatform(const glm::vec2& position, const glm::vec2& size, PlatformType type = PlatformType::SOLID);
     
     // Character interaction
-    void resolveCharacterCollisions(Character* character, float deltaTime);
-    bool isCharacterOnGround(Character* character);
-    bool isCharacterOutOfBounds(Character* character);
-    glm::vec2 getSpawnPosition(int playerIndex);
+    void resolveCharacterCollisions(FighterComponents& fighters, int entity, SimScalar deltaTime) const;
+    bool isCharacterOnGround(const SimVec2& position, const SimVec2& size) const;
+    bool isCharacterOutOfBounds(const SimVec2& position) const;
+    glm::vec2 getSpawnPosition(int playerIndex) const;
     
     // Getters
     std::string getName() const { return m_name; }
@@ -49,6 +51,10 @@ private:
     // Spawn positions for different players
     std::vector<glm::vec2> m_spawnPositions;
     
+    // Swept collision limits
+    static constexpr int MAX_SWEEP_ITERATIONS = 4;
+    static constexpr SimScalar CONTACT_SKIN = SimScalar(0.001f);
+    
     void setupDefaultStage();
 };
 
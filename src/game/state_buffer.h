@@ -0,0 +1,89 @@
+#ifndef STATE_BUFFER_H
+#define STATE_BUFFER_H
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Appends plain-old-data values to a byte buffer. Used for simulation snapshots, so
+// only trivially copyable types without padding should go through it.
+class StateWriter {
+public:
+    StateWriter(std::vector<uint8_t>& buffer) : m_buffer(buffer) {}
+    
+    template <typename T>
+    void write(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot values must be POD");
+        append(&value, sizeof(T));
+    }
+    
+    template <typename T>
+    void writeArray(const std::vector<T>& values) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot values must be POD");
+        if (!values.empty()) {
+            append(values.data(), values.size() * sizeof(T));
+        }
+    }
+    
+    void append(const void* data, size_t size) {
+        size_t offset = m_buffer.size();
+        m_buffer.resize(offset + size);
+        std::memcpy(m_buffer.data() + offset, data, size);
+    }
+    
+    std::vector<uint8_t>& getBuffer() { return m_buffer; }
+    
+private:
+    std::vector<uint8_t>& m_buffer;
+};
+
+// Reads back what StateWriter wrote; every read fails once the data runs out
+class StateReader {
+public:
+    StateReader(const uint8_t* data, size_t size) : m_data(data), m_size(size), m_offset(0) {}
+    
+    template <typename T>
+    bool read(T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot values must be POD");
+        if (remaining() < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, m_data + m_offset, sizeof(T));
+        m_offset += sizeof(T);
+        return true;
+    }
+    
+    template <typename T>
+    bool readArray(std::vector<T>& values, size_t count) {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot values must be POD");
+        if (remaining() < count * sizeof(T)) {
+            return false;
+        }
+        values.resize(count);
+        if (count > 0) {
+            std::memcpy(values.data(), m_data + m_offset, count * sizeof(T));
+        }
+        m_offset += count * sizeof(T);
+        return true;
+    }
+    
+    bool skip(size_t size) {
+        if (remaining() < size) {
+            return false;
+        }
+        m_offset += size;
+        return true;
+    }
+    
+    const uint8_t* getCursor() const { return m_data + m_offset; }
+    size_t remaining() const { return m_size - m_offset; }
+    size_t getOffset() const { return m_offset; }
+    
+private:
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_offset;
+};
+
+#endif
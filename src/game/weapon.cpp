@@ -0,0 +1,103 @@
+#include "weapon.h"
+#include <cmath>
+
+void HitscanBatch::addShot(int ownerId, const Ray& ray, float damage, uint32_t viewTick, float viewFraction) {
+    ShotResult shot;
+    shot.ownerId = ownerId;
+    shot.damage = damage;
+    shot.viewTick = viewTick;
+    shot.viewFraction = viewFraction;
+    shot.ray = ray;
+    shot.targetHit = -1;
+    shot.targetDistance = 0.0f;
+    m_results.push_back(shot);
+}
+
+void HitscanBatch::resolve(World* world) {
+    m_rays.resize(m_results.size());
+    m_hits.resize(m_results.size());
+    for (size_t i = 0; i < m_results.size(); i++) {
+        m_rays[i] = m_results[i].ray;
+    }
+    
+    world->raycastBatch(m_rays.data(), m_hits.data(), m_rays.size());
+    
+    for (size_t i = 0; i < m_results.size(); i++) {
+        m_results[i].hit = m_hits[i];
+    }
+}
+
+void HitscanBatch::clear() {
+    // Keep capacity so steady-state ticks don't allocate
+    m_results.clear();
+}
+
+Weapon::Weapon(const WeaponStats& stats)
+    : m_stats(stats)
+    , m_cooldown(0.0f)
+{
+}
+
+void Weapon::update(float deltaTime) {
+    if (m_cooldown > 0.0f) {
+        m_cooldown -= deltaTime;
+        if (m_cooldown < 0.0f) {
+            m_cooldown = 0.0f;
+        }
+    }
+}
+
+bool Weapon::fire(int ownerId, const glm::vec3& origin, const glm::vec3& direction, HitscanBatch& batch,
+                  uint32_t viewTick, float viewFraction) {
+    if (!canFire()) {
+        return false;
+    }
+    m_cooldown = m_stats.fireInterval;
+    
+    glm::vec3 forward = glm::normalize(direction);
+    
+    // Basis around the aim direction for spreading pellets
+    glm::vec3 up = std::abs(forward.y) < 0.99f ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+    glm::vec3 right = glm::normalize(glm::cross(forward, up));
+    up = glm::cross(right, forward);
+    
+    float spread = std::tan(glm::radians(m_stats.spreadAngle));
+    
+    for (int i = 0; i < m_stats.pelletsPerShot; i++) {
+        // Fixed golden-angle spiral so the pattern is deterministic across clients
+        glm::vec3 pelletDirection = forward;
+        if (i > 0 && m_stats.pelletsPerShot > 1) {
+            float radius = spread * std::sqrt(static_cast<float>(i) / (m_stats.pelletsPerShot - 1));
+            float angle = i * 2.39996323f;
+            pelletDirection = glm::normalize(forward + right * (std::cos(angle) * radius) + up * (std::sin(angle) * radius));
+        }
+        
+        Ray ray;
+        ray.origin = origin;
+        ray.direction = pelletDirection;
+        ray.maxDistance = m_stats.range;
+        batch.addShot(ownerId, ray, m_stats.damage, viewTick, viewFraction);
+    }
+    
+    return true;
+}
+
+WeaponStats Weapon::rifle() {
+    WeaponStats stats;
+    stats.damage = 25.0f;
+    stats.range = 200.0f;
+    stats.fireInterval = 0.1f;
+    stats.pelletsPerShot = 1;
+    stats.spreadAngle = 0.0f;
+    return stats;
+}
+
+WeaponStats Weapon::shotgun() {
+    WeaponStats stats;
+    stats.damage = 8.0f;
+    stats.range = 40.0f;
+    stats.fireInterval = 0.8f;
+    stats.pelletsPerShot = 12;
+    stats.spreadAngle = 6.0f;
+    return stats;
+}
@@ -0,0 +1,75 @@
+#ifndef WEAPON_H
+#define WEAPON_H
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "world.h"
+
+struct WeaponStats {
+    float damage;         // Per pellet
+    float range;
+    float fireInterval;   // Seconds between shots
+    int pelletsPerShot;
+    float spreadAngle;    // Cone half-angle in degrees
+};
+
+// View tick of a shot fired at the present rather than at an interpolated past
+const uint32_t VIEW_TICK_PRESENT = UINT32_MAX;
+
+// One traced pellet
+struct ShotResult {
+    int ownerId;
+    float damage;
+    uint32_t viewTick;     // Tick the shooter was seeing, or VIEW_TICK_PRESENT
+    float viewFraction;    // How far the shooter was between viewTick and the next, 0 to 1
+    Ray ray;
+    RayHit hit;            // Nearest wall
+    int targetHit;         // Player hit before the wall, set by lag compensation
+    float targetDistance;
+};
+
+// Collects hitscan shots from any number of weapons during a tick and traces them
+// against the world in a single batched BVH query
+class HitscanBatch {
+public:
+    void addShot(int ownerId, const Ray& ray, float damage, uint32_t viewTick = VIEW_TICK_PRESENT,
+                 float viewFraction = 0.0f);
+    void resolve(World* world);
+    void clear();
+    
+    const std::vector<ShotResult>& getResults() const { return m_results; }
+    std::vector<ShotResult>& getMutableResults() { return m_results; }
+    size_t getShotCount() const { return m_results.size(); }
+    
+private:
+    std::vector<ShotResult> m_results;
+    std::vector<Ray> m_rays;
+    std::vector<RayHit> m_hits;
+};
+
+class Weapon {
+public:
+    Weapon(const WeaponStats& stats);
+    
+    void update(float deltaTime);
+    
+    // Queues the weapon's pellets into the batch; returns false while on cooldown.
+    // On a server, viewTick and viewFraction are the interpolated time the shooting
+    // client was seeing.
+    bool fire(int ownerId, const glm::vec3& origin, const glm::vec3& direction, HitscanBatch& batch,
+              uint32_t viewTick = VIEW_TICK_PRESENT, float viewFraction = 0.0f);
+    
+    bool canFire() const { return m_cooldown <= 0.0f; }
+    const WeaponStats& getStats() const { return m_stats; }
+    
+    // Preset weapons
+    static WeaponStats rifle();
+    static WeaponStats shotgun();
+    
+private:
+    WeaponStats m_stats;
+    float m_cooldown;
+};
+
+#endif
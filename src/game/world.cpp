@@ -1,7 +1,9 @@
 #include "world.h"
+#include <algorithm>
+#include <cfloat>
 #include <glm/gtc/matrix_transform.hpp>
 
-World::World() {
+World::World() : m_bvhDirty(true) {
     m_wallTexture = new Texture("assets/textures/wall.jpg");
     
     addWall(glm::vec3(0.0f, -0.5f, 0.0f), glm::vec3(20.0f, 1.0f, 20.0f));
@@ -28,6 +30,18 @@ void World::addWall(const glm::vec3& position, const glm::vec3& size) {
     wall.size = size;
     wall.mesh = createWallMesh(size);
     m_walls.push_back(wall);
+    m_bvhDirty = true;
+}
+
+void World::rebuildBVH() {
+    std::vector<AABB> bounds;
+    bounds.reserve(m_walls.size());
+    for (auto& wall : m_walls) {
+        bounds.push_back(AABB(wall.position - wall.size * 0.5f, wall.position + wall.size * 0.5f));
+    }
+    
+    m_bvh.build(bounds);
+    m_bvhDirty = false;
 }
 
 Mesh* World::createWallMesh(const glm::vec3& size) {
@@ -129,4 +143,248 @@ glm::vec3 World::resolveCollision(const glm::vec3& oldPosition, const glm::vec3&
     }
     
     return resolved;
-}
\ No newline at end of file
+}
+
+bool World::raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, RayHit& hit) {
+    if (m_bvhDirty) {
+        rebuildBVH();
+    }
+    
+    Ray ray;
+    ray.origin = origin;
+    ray.direction = glm::normalize(direction);
+    ray.maxDistance = maxDistance;
+    return m_bvh.raycast(ray, hit);
+}
+
+bool World::segmentCast(const glm::vec3& start, const glm::vec3& end, RayHit& hit) {
+    glm::vec3 delta = end - start;
+    float length = glm::length(delta);
+    if (length <= 0.0f) {
+        hit = RayHit();
+        return false;
+    }
+    
+    return raycast(start, delta / length, length, hit);
+}
+
+bool World::isSegmentBlocked(const glm::vec3& start, const glm::vec3& end) {
+    if (m_bvhDirty) {
+        rebuildBVH();
+    }
+    
+    glm::vec3 delta = end - start;
+    float length = glm::length(delta);
+    if (length <= 0.0f) {
+        return false;
+    }
+    
+    Ray ray;
+    ray.origin = start;
+    ray.direction = delta / length;
+    ray.maxDistance = length;
+    return m_bvh.occluded(ray);
+}
+
+void World::raycastBatch(const Ray* rays, RayHit* hits, size_t count) {
+    if (m_bvhDirty) {
+        rebuildBVH();
+    }
+    
+    m_bvh.raycastBatch(rays, hits, count);
+}
+
+float World::capsuleWallDistance(const glm::vec3& position, const Capsule& capsule, const Wall& wall, glm::vec3& normal) const {
+    glm::vec3 boxMin = wall.position - wall.size * 0.5f;
+    glm::vec3 boxMax = wall.position + wall.size * 0.5f;
+    
+    // The capsule is vertical and the wall axis-aligned, so the closest points separate
+    // per axis: horizontally it's a point against a rectangle, vertically two intervals
+    float segmentBottom = position.y - capsule.halfSegment;
+    float segmentTop = position.y + capsule.halfSegment;
+    
+    float segmentY, boxY;
+    if (segmentTop < boxMin.y) {
+        segmentY = segmentTop;
+        boxY = boxMin.y;
+    } else if (segmentBottom > boxMax.y) {
+        segmentY = segmentBottom;
+        boxY = boxMax.y;
+    } else {
+        segmentY = glm::clamp(position.y, std::max(boxMin.y, segmentBottom), std::min(boxMax.y, segmentTop));
+        boxY = segmentY;
+    }
+    
+    glm::vec3 onSegment(position.x, segmentY, position.z);
+    glm::vec3 onBox(glm::clamp(position.x, boxMin.x, boxMax.x), boxY, glm::clamp(position.z, boxMin.z, boxMax.z));
+    
+    glm::vec3 separation = onSegment - onBox;
+    float distance = glm::length(separation);
+    normal = distance > 1e-6f ? separation / distance : glm::vec3(0.0f);
+    return distance;
+}
+
+bool World::sweepCapsule(const glm::vec3& position, const glm::vec3& displacement, const Capsule& capsule,
+                         float& timeOfImpact, glm::vec3& normal) const {
+    bool hit = false;
+    timeOfImpact = 1.0f;
+    
+    for (int wallIndex : m_candidateWalls) {
+        const Wall& wall = m_walls[wallIndex];
+        
+        // Conservative advancement. The distance along a straight move is convex, so
+        // stepping by its linear extrapolation never passes the contact point.
+        float t = 0.0f;
+        glm::vec3 wallNormal;
+        int step = 0;
+        for (; step < MAX_ADVANCE_STEPS; step++) {
+            float gap = capsuleWallDistance(position + displacement * t, capsule, wall, wallNormal) - capsule.radius;
+            
+            // Segment inside the wall; leave it to depenetration
+            if (wallNormal == glm::vec3(0.0f)) {
+                break;
+            }
+            
+            float approachRate = glm::dot(displacement, wallNormal);
+            if (approachRate >= 0.0f) {
+                break;  // Moving along or away from this wall
+            }
+            
+            if (gap <= CONTACT_SKIN) {
+                if (t < timeOfImpact) {
+                    timeOfImpact = t;
+                    normal = wallNormal;
+                    hit = true;
+                }
+                break;
+            }
+            
+            t += (gap - CONTACT_SKIN * 0.5f) / -approachRate;
+            if (t >= timeOfImpact) {
+                break;  // Can't beat the hit we already have
+            }
+        }
+        
+        // Ran out of steps while still closing in (grazing approach): every t we stepped
+        // to is safe, so stop there rather than letting the move tunnel into the wall
+        if (step == MAX_ADVANCE_STEPS && t < timeOfImpact) {
+            timeOfImpact = t;
+            normal = wallNormal;
+            hit = true;
+        }
+    }
+    
+    return hit;
+}
+
+glm::vec3 World::depenetrateCapsule(const glm::vec3& position, const Capsule& capsule) const {
+    glm::vec3 resolved = position;
+    
+    for (int wallIndex : m_candidateWalls) {
+        const Wall& wall = m_walls[wallIndex];
+        glm::vec3 normal;
+        float distance = capsuleWallDistance(resolved, capsule, wall, normal);
+        if (distance >= capsule.radius) {
+            continue;
+        }
+        
+        if (normal != glm::vec3(0.0f)) {
+            resolved += normal * (capsule.radius - distance + CONTACT_SKIN);
+            continue;
+        }
+        
+        // Segment is inside the wall: push out along the axis of least penetration
+        glm::vec3 boxMin = wall.position - wall.size * 0.5f;
+        glm::vec3 boxMax = wall.position + wall.size * 0.5f;
+        glm::vec3 extent(capsule.radius, capsule.halfSegment + capsule.radius, capsule.radius);
+        float bestPush = FLT_MAX;
+        glm::vec3 push(0.0f);
+        for (int axis = 0; axis < 3; axis++) {
+            float pushNegative = (resolved[axis] + extent[axis]) - boxMin[axis];
+            float pushPositive = boxMax[axis] - (resolved[axis] - extent[axis]);
+            if (pushNegative < bestPush) {
+                bestPush = pushNegative;
+                push = glm::vec3(0.0f);
+                push[axis] = -(pushNegative + CONTACT_SKIN);
+            }
+            if (pushPositive < bestPush) {
+                bestPush = pushPositive;
+                push = glm::vec3(0.0f);
+                push[axis] = pushPositive + CONTACT_SKIN;
+            }
+        }
+        resolved += push;
+    }
+    
+    return resolved;
+}
+
+CapsuleMoveResult World::moveCapsule(const glm::vec3& position, const glm::vec3& displacement, const Capsule& capsule) {
+    if (m_bvhDirty) {
+        rebuildBVH();
+    }
+    
+    CapsuleMoveResult result;
+    result.position = position;
+    result.onGround = false;
+    result.hitCeiling = false;
+    result.collisions = 0;
+    
+    // Broadphase: gather walls touching the bounds of the whole move once
+    glm::vec3 extent(capsule.radius, capsule.halfSegment + capsule.radius, capsule.radius);
+    extent += glm::vec3(CONTACT_SKIN * 2.0f);
+    AABB moveBounds(position - extent, position + extent);
+    moveBounds.expand(AABB(position + displacement - extent, position + displacement + extent));
+    
+    m_candidateWalls.clear();
+    m_bvh.queryOverlaps(moveBounds, m_candidateWalls);
+    if (m_candidateWalls.empty()) {
+        result.position = position + displacement;
+        return result;
+    }
+    
+    glm::vec3 current = depenetrateCapsule(position, capsule);
+    glm::vec3 remaining = displacement;
+    glm::vec3 previousNormal(0.0f);
+    
+    for (int iteration = 0; iteration < MAX_SLIDE_ITERATIONS; iteration++) {
+        if (glm::dot(remaining, remaining) < 1e-12f) {
+            break;
+        }
+        
+        float timeOfImpact;
+        glm::vec3 normal;
+        if (!sweepCapsule(current, remaining, capsule, timeOfImpact, normal)) {
+            current += remaining;
+            break;
+        }
+        
+        current += remaining * timeOfImpact;
+        result.collisions++;
+        
+        if (normal.y > GROUND_NORMAL_Y) {
+            result.onGround = true;
+        } else if (normal.y < -GROUND_NORMAL_Y) {
+            result.hitCeiling = true;
+        }
+        
+        // Slide: drop the part of the remaining move that goes into the surface
+        remaining *= (1.0f - timeOfImpact);
+        remaining -= normal * glm::dot(remaining, normal);
+        
+        // In a crease between two surfaces, slide along their intersection line
+        if (iteration > 0 && glm::dot(remaining, previousNormal) < 0.0f) {
+            glm::vec3 crease = glm::cross(previousNormal, normal);
+            float creaseLength = glm::length(crease);
+            if (creaseLength < 1e-6f) {
+                break;
+            }
+            crease /= creaseLength;
+            remaining = crease * glm::dot(remaining, crease);
+        }
+        previousNormal = normal;
+    }
+    
+    result.position = current;
+    return result;
+}
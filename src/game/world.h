@@ -5,6 +5,7 @@
 #include <glm/glm.hpp>
 #include "../rendering/mesh.h"
 #include "../rendering/shader.h"
+#include "../utils/bvh.h"
 
 struct Wall {
     glm::vec3 position;
@@ -12,6 +13,19 @@ struct Wall {
     Mesh* mesh;
 };
 
+// Vertical capsule: a segment of halfSegment above and below the center, inflated by radius
+struct Capsule {
+    float radius;
+    float halfSegment;
+};
+
+struct CapsuleMoveResult {
+    glm::vec3 position;
+    bool onGround;
+    bool hitCeiling;
+    int collisions;
+};
+
 class World {
 public:
     World();
@@ -25,11 +39,41 @@ public:
     
     glm::vec3 resolveCollision(const glm::vec3& oldPosition, const glm::vec3& newPosition, float radius = 0.5f);
     
+    // Ray queries against the walls, accelerated by a BVH
+    bool raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, RayHit& hit);
+    bool segmentCast(const glm::vec3& start, const glm::vec3& end, RayHit& hit);
+    bool isSegmentBlocked(const glm::vec3& start, const glm::vec3& end);
+    void raycastBatch(const Ray* rays, RayHit* hits, size_t count);
+    
+    // Collide-and-slide movement of a capsule centered at position
+    CapsuleMoveResult moveCapsule(const glm::vec3& position, const glm::vec3& displacement, const Capsule& capsule);
+    
+    int getWallCount() const { return static_cast<int>(m_walls.size()); }
+    
 private:
     std::vector<Wall> m_walls;
     Texture* m_wallTexture;
     
+    // Rebuilt lazily after walls are added
+    BVH m_bvh;
+    bool m_bvhDirty;
+    
+    // Walls near the current capsule move, reused between calls
+    std::vector<int> m_candidateWalls;
+    
+    // Capsule movement limits
+    static const int MAX_SLIDE_ITERATIONS = 4;
+    static const int MAX_ADVANCE_STEPS = 16;
+    static constexpr float CONTACT_SKIN = 0.001f;
+    static constexpr float GROUND_NORMAL_Y = 0.7f;
+    
     Mesh* createWallMesh(const glm::vec3& size);
+    void rebuildBVH();
+    
+    float capsuleWallDistance(const glm::vec3& position, const Capsule& capsule, const Wall& wall, glm::vec3& normal) const;
+    bool sweepCapsule(const glm::vec3& position, const glm::vec3& displacement, const Capsule& capsule,
+                      float& timeOfImpact, glm::vec3& normal) const;
+    glm::vec3 depenetrateCapsule(const glm::vec3& position, const Capsule& capsule) const;
 };
 
 #endif
\ No newline at end of file
@@ -1,7 +1,38 @@
 #include "engine/application.h"
+#include <cstdlib>
+#include <cstring>
+#include <vector>
 
 int main(int argc, char* argv[]) {
     Application app("Smash Bros Style Game", 1280, 720);
+    VsyncMode vsync = VsyncMode::ADAPTIVE;
+    int targetFps = 0;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            app.recordReplay(argv[++i]);
+        } else if (strcmp(argv[i], "--vsync") == 0 && i + 1 < argc) {
+            const char* mode = argv[++i];
+            vsync = strcmp(mode, "off") == 0 ? VsyncMode::OFF : (strcmp(mode, "on") == 0 ? VsyncMode::ON : VsyncMode::ADAPTIVE);
+        } else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            targetFps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--frame-stats") == 0 && i + 1 < argc) {
+            app.exportFrameStats(argv[++i]);
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            app.captureTrace(argv[++i]);
+        } else if (strcmp(argv[i], "--gl-debug") == 0) {
+            app.enableGlDebug();
+        } else if (strcmp(argv[i], "--hitch-ms") == 0 && i + 1 < argc) {
+            // Comma-separated thresholds, e.g. 20,33.3,100
+            std::vector<double> thresholds;
+            for (char* value = strtok(argv[++i], ","); value; value = strtok(nullptr, ",")) {
+                thresholds.push_back(atof(value));
+            }
+            app.getFrameStats().setHitchThresholds(thresholds);
+        }
+    }
+    
+    app.setFramePacing(vsync, targetFps);
     app.run();
     return 0;
 }
@@ -0,0 +1,87 @@
+#include "bit_stream.h"
+#include <algorithm>
+#include <cmath>
+
+BitWriter::BitWriter(std::vector<uint8_t>& buffer)
+    : m_buffer(buffer)
+    , m_scratch(0)
+    , m_scratchBits(0)
+    , m_bitsWritten(0)
+{
+}
+
+void BitWriter::writeBits(uint32_t value, int bits) {
+    if (bits < 32) {
+        value &= (1u << bits) - 1;
+    }
+    
+    m_scratch |= static_cast<uint64_t>(value) << m_scratchBits;
+    m_scratchBits += bits;
+    m_bitsWritten += bits;
+    
+    while (m_scratchBits >= 8) {
+        m_buffer.push_back(static_cast<uint8_t>(m_scratch & 0xFF));
+        m_scratch >>= 8;
+        m_scratchBits -= 8;
+    }
+}
+
+void BitWriter::writeSigned(int32_t value, int bits) {
+    // Zig-zag so small negative numbers stay small
+    uint32_t zigzag = (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+    writeBits(zigzag, bits);
+}
+
+void BitWriter::writeQuantized(float value, float min, float max, int bits) {
+    uint32_t maxValue = bits < 32 ? (1u << bits) - 1 : 0xFFFFFFFFu;
+    float normalized = (std::min(std::max(value, min), max) - min) / (max - min);
+    writeBits(static_cast<uint32_t>(std::lround(normalized * maxValue)), bits);
+}
+
+void BitWriter::flush() {
+    if (m_scratchBits > 0) {
+        m_buffer.push_back(static_cast<uint8_t>(m_scratch & 0xFF));
+        m_bitsWritten += 8 - m_scratchBits;
+        m_scratch = 0;
+        m_scratchBits = 0;
+    }
+}
+
+BitReader::BitReader(const uint8_t* data, size_t size)
+    : m_data(data)
+    , m_size(size)
+    , m_bitsRead(0)
+    , m_overflow(false)
+{
+}
+
+uint32_t BitReader::readBits(int bits) {
+    if (m_bitsRead + bits > m_size * 8) {
+        m_overflow = true;
+        m_bitsRead = m_size * 8;
+        return 0;
+    }
+    
+    uint32_t value = 0;
+    int written = 0;
+    while (written < bits) {
+        size_t byteIndex = m_bitsRead >> 3;
+        int bitOffset = static_cast<int>(m_bitsRead & 7);
+        int take = std::min(8 - bitOffset, bits - written);
+        uint32_t chunk = (m_data[byteIndex] >> bitOffset) & ((1u << take) - 1);
+        value |= chunk << written;
+        written += take;
+        m_bitsRead += take;
+    }
+    return value;
+}
+
+int32_t BitReader::readSigned(int bits) {
+    uint32_t zigzag = readBits(bits);
+    return static_cast<int32_t>((zigzag >> 1) ^ (0u - (zigzag & 1)));
+}
+
+float BitReader::readQuantized(float min, float max, int bits) {
+    uint32_t maxValue = bits < 32 ? (1u << bits) - 1 : 0xFFFFFFFFu;
+    return min + (max - min) * (static_cast<float>(readBits(bits)) / maxValue);
+}
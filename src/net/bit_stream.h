@@ -0,0 +1,53 @@
+#ifndef BIT_STREAM_H
+#define BIT_STREAM_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Packs values LSB-first into a byte buffer using only as many bits as each needs
+class BitWriter {
+public:
+    BitWriter(std::vector<uint8_t>& buffer);
+    
+    void writeBits(uint32_t value, int bits);
+    void writeBool(bool value) { writeBits(value ? 1 : 0, 1); }
+    void writeSigned(int32_t value, int bits);
+    
+    // Maps [min, max] onto an unsigned range of the given width, clamping outliers
+    void writeQuantized(float value, float min, float max, int bits);
+    
+    // Pads to the next byte so the buffer can be sent
+    void flush();
+    
+    size_t getBitsWritten() const { return m_bitsWritten; }
+    
+private:
+    std::vector<uint8_t>& m_buffer;
+    uint64_t m_scratch;
+    int m_scratchBits;
+    size_t m_bitsWritten;
+};
+
+// Reads what a BitWriter wrote. Reading past the end returns zeros and sets the
+// overflow flag, so a truncated packet can be rejected after decoding.
+class BitReader {
+public:
+    BitReader(const uint8_t* data, size_t size);
+    
+    uint32_t readBits(int bits);
+    bool readBool() { return readBits(1) != 0; }
+    int32_t readSigned(int bits);
+    float readQuantized(float min, float max, int bits);
+    
+    bool hasOverflowed() const { return m_overflow; }
+    size_t getBitsRemaining() const { return m_size * 8 - m_bitsRead; }
+    
+private:
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_bitsRead;
+    bool m_overflow;
+};
+
+#endif
@@ -0,0 +1,196 @@
+#include "match_client.h"
+#include <iostream>
+
+MatchClient::MatchClient()
+    : m_transport(&m_socket)
+    , m_fighterType(FighterType::BALANCED)
+    , m_connecting(false)
+    , m_connected(false)
+    , m_playerIndex(-1)
+    , m_connectRetry(0)
+    , m_latestTick(NO_TICK)
+    , m_inputTick(0)
+    , m_leadSettleTick(0)
+    , m_snapshotsReceived(0)
+    , m_bytesReceived(0)
+    , m_decodeFailures(0)
+{
+    for (int i = 0; i < INPUT_REDUNDANCY; i++) {
+        m_recentInputs[i] = PlayerInput::none();
+        m_recentTicks[i] = NO_TICK;
+    }
+    m_packet.reserve(MAX_PACKET_SIZE);
+}
+
+MatchClient::~MatchClient() {
+    disconnect();
+}
+
+bool MatchClient::connect(const NetAddress& server, FighterType type) {
+    if (!m_socket.open(0)) {
+        return false;
+    }
+    
+    m_server = server;
+    m_fighterType = type;
+    m_connecting = true;
+    m_connected = false;
+    m_connectRetry = 0;
+    m_latestTick = NO_TICK;
+    sendConnect();
+    return true;
+}
+
+void MatchClient::disconnect() {
+    if (m_connected) {
+        m_packet.clear();
+        BitWriter writer(m_packet);
+        writePacketHeader(writer, PACKET_DISCONNECT);
+        writer.flush();
+        m_transport->send(m_server, m_packet.data(), m_packet.size());
+    }
+    
+    m_connecting = false;
+    m_connected = false;
+    m_playerIndex = -1;
+    m_socket.close();
+}
+
+void MatchClient::sendConnect() {
+    m_packet.clear();
+    BitWriter writer(m_packet);
+    writePacketHeader(writer, PACKET_CONNECT);
+    writer.writeBits(static_cast<uint32_t>(m_fighterType), 2);
+    writer.flush();
+    m_transport->send(m_server, m_packet.data(), m_packet.size());
+}
+
+void MatchClient::update() {
+    if (m_connecting && ++m_connectRetry >= CONNECT_RETRY_UPDATES) {
+        m_connectRetry = 0;
+        sendConnect();
+    }
+    
+    NetAddress from;
+    int size;
+    while ((size = m_transport->receive(from, m_receiveBuffer, sizeof(m_receiveBuffer))) >= 0) {
+        if (from != m_server) {
+            continue;
+        }
+        
+        BitReader reader(m_receiveBuffer, size);
+        PacketType type;
+        if (!readPacketHeader(reader, type)) {
+            continue;
+        }
+        m_bytesReceived += size;
+        
+        if (type == PACKET_ACCEPT) {
+            int playerIndex = static_cast<int>(reader.readBits(4));
+            uint32_t serverTick = reader.readBits(32);
+            if (reader.hasOverflowed() || !m_connecting) {
+                continue;
+            }
+            
+            m_connecting = false;
+            m_connected = true;
+            m_playerIndex = playerIndex;
+            m_inputTick = serverTick + INPUT_LEAD_TICKS;
+            m_leadSettleTick = m_inputTick;
+        } else if (type == PACKET_REJECT) {
+            std::cerr << "Server " << m_server.toString() << " rejected the connection: match is full" << std::endl;
+            m_connecting = false;
+        } else if (type == PACKET_DISCONNECT) {
+            m_connected = false;
+            m_playerIndex = -1;
+        } else if (type == PACKET_SNAPSHOT && m_connected) {
+            handleSnapshot(reader);
+        }
+    }
+}
+
+void MatchClient::handleSnapshot(BitReader& reader) {
+    uint32_t baselineTick = reader.readBits(32);
+    uint32_t newestInputTick = reader.readBits(32);
+    
+    // Late duplicates and reordered packets are dropped before decoding; their baseline
+    // may already be gone
+    BitReader peek = reader;
+    uint32_t tick = peek.readBits(32);
+    if (m_latestTick != NO_TICK && static_cast<int32_t>(tick - m_latestTick) <= 0) {
+        return;
+    }
+    
+    const NetSnapshot* baseline = nullptr;
+    if (baselineTick != NO_TICK) {
+        const NetSnapshot& stored = m_snapshots[baselineTick % SNAPSHOT_HISTORY];
+        if (stored.tick != baselineTick) {
+            // We no longer have what the delta is against; wait for a newer ack to land
+            m_decodeFailures++;
+            return;
+        }
+        baseline = &stored;
+    }
+    
+    NetSnapshot snapshot;
+    if (!NetSnapshot::read(reader, snapshot, baseline)) {
+        m_decodeFailures++;
+        return;
+    }
+    
+    m_snapshots[snapshot.tick % SNAPSHOT_HISTORY] = snapshot;
+    m_latestTick = snapshot.tick;
+    m_snapshotsReceived++;
+    
+    // Latency grew or we started too close: skip the input clock ahead. Feedback about
+    // inputs sent before the last adjustment is stale, so wait for newer ones to land.
+    if (newestInputTick != NO_TICK && newestInputTick >= m_leadSettleTick) {
+        int32_t margin = static_cast<int32_t>(newestInputTick - snapshot.tick);
+        if (margin < INPUT_MIN_MARGIN) {
+            m_inputTick += INPUT_MIN_MARGIN - margin;
+            m_leadSettleTick = m_inputTick;
+        }
+    }
+}
+
+const NetSnapshot* MatchClient::getLatestSnapshot() const {
+    if (m_latestTick == NO_TICK) {
+        return nullptr;
+    }
+    return &m_snapshots[m_latestTick % SNAPSHOT_HISTORY];
+}
+
+void MatchClient::sendInput(const PlayerInput& input) {
+    if (!m_connected) {
+        return;
+    }
+    
+    int slot = m_inputTick % INPUT_REDUNDANCY;
+    m_recentInputs[slot] = input;
+    m_recentTicks[slot] = m_inputTick;
+    
+    // Resend the run of consecutive recent ticks ending at this one
+    int count = 1;
+    while (count < INPUT_REDUNDANCY) {
+        uint32_t tick = m_inputTick - count;
+        if (m_recentTicks[tick % INPUT_REDUNDANCY] != tick) {
+            break;
+        }
+        count++;
+    }
+    uint32_t firstTick = m_inputTick - (count - 1);
+    
+    m_packet.clear();
+    BitWriter writer(m_packet);
+    writePacketHeader(writer, PACKET_INPUT);
+    writer.writeBits(m_latestTick, 32);
+    writer.writeBits(firstTick, 32);
+    writer.writeBits(count, 3);
+    for (int i = 0; i < count; i++) {
+        writePlayerInput(writer, m_recentInputs[(firstTick + i) % INPUT_REDUNDANCY]);
+    }
+    writer.flush();
+    m_transport->send(m_server, m_packet.data(), m_packet.size());
+    
+    m_inputTick++;
+}
@@ -0,0 +1,75 @@
+#ifndef MATCH_CLIENT_H
+#define MATCH_CLIENT_H
+
+#include <cstdint>
+#include "udp_socket.h"
+#include "transport.h"
+#include "snapshot.h"
+#include "protocol.h"
+#include "../game/fighter.h"
+
+// Client side of the match protocol: connects to a MatchServer, streams inputs with
+// redundancy and rebuilds full snapshots from the server's deltas
+class MatchClient {
+public:
+    MatchClient();
+    ~MatchClient();
+    
+    bool connect(const NetAddress& server, FighterType type);
+    void disconnect();
+    
+    // Receives pending packets; retries the connect handshake until accepted
+    void update();
+    
+    // Input for the next tick. Call once per simulation tick once connected.
+    void sendInput(const PlayerInput& input);
+    
+    // Routes traffic through a shim such as NetworkSimulator; nullptr goes back to the
+    // socket. The shim must wrap getSocket().
+    void setTransport(Transport* transport) { m_transport = transport ? transport : &m_socket; }
+    UdpSocket& getSocket() { return m_socket; }
+    
+    bool isConnected() const { return m_connected; }
+    int getPlayerIndex() const { return m_playerIndex; }
+    uint32_t getInputTick() const { return m_inputTick; }
+    
+    // Newest fully decoded snapshot, or nullptr before the first one arrives
+    const NetSnapshot* getLatestSnapshot() const;
+    
+    uint64_t getSnapshotsReceived() const { return m_snapshotsReceived; }
+    uint64_t getBytesReceived() const { return m_bytesReceived; }
+    uint64_t getDecodeFailures() const { return m_decodeFailures; }
+    
+private:
+    static const int SNAPSHOT_HISTORY = 64;
+    static const int CONNECT_RETRY_UPDATES = 30;
+    
+    UdpSocket m_socket;
+    Transport* m_transport;   // m_socket, or a shim wrapping it
+    NetAddress m_server;
+    FighterType m_fighterType;
+    bool m_connecting;
+    bool m_connected;
+    int m_playerIndex;
+    int m_connectRetry;
+    
+    NetSnapshot m_snapshots[SNAPSHOT_HISTORY];
+    uint32_t m_latestTick;
+    
+    uint32_t m_inputTick;   // Server tick the next input is for
+    uint32_t m_leadSettleTick;
+    PlayerInput m_recentInputs[INPUT_REDUNDANCY];
+    uint32_t m_recentTicks[INPUT_REDUNDANCY];
+    
+    uint64_t m_snapshotsReceived;
+    uint64_t m_bytesReceived;
+    uint64_t m_decodeFailures;
+    
+    std::vector<uint8_t> m_packet;
+    uint8_t m_receiveBuffer[MAX_PACKET_SIZE];
+    
+    void sendConnect();
+    void handleSnapshot(BitReader& reader);
+};
+
+#endif
@@ -0,0 +1,170 @@
+#include "match_host.h"
+#include "../game/simulation.h"
+#include <algorithm>
+#include <iostream>
+
+MatchHost::MatchHost(const MatchHostConfig& config)
+    : m_config(config)
+    , m_stage(nullptr)
+    , m_tickPeriod(std::chrono::duration_cast<Clock::duration>(std::chrono::microseconds(1000000 / SIMULATION_TICK_RATE)))
+    , m_running(false)
+{
+}
+
+MatchHost::~MatchHost() {
+    stop();
+}
+
+bool MatchHost::start() {
+    m_stage = new Stage("Default Stage");
+    
+    for (int i = 0; i < m_config.matches; i++) {
+        ServerConfig server = m_config.server;
+        server.port = server.port == 0 ? 0 : static_cast<uint16_t>(server.port + i);
+        server.sharedStage = m_stage;
+        
+        MatchServer* match = new MatchServer(server);
+        m_matches.push_back(match);
+        if (m_config.metrics) {
+            match->setMetricsShard(m_config.metrics->createShard());
+        }
+        if (!match->start()) {
+            std::cerr << "Failed to start match " << i << std::endl;
+            stop();
+            return false;
+        }
+        m_ports.push_back(match->getPort());
+    }
+    
+    m_metrics.assign(m_matches.size(), MatchTickMetrics());
+    
+    // Stagger the first deadlines across one period so matches don't all wake at once
+    Clock::time_point now = Clock::now();
+    int count = static_cast<int>(m_matches.size());
+    for (int i = 0; i < count; i++) {
+        m_queue.push({now + m_tickPeriod * i / count, i});
+    }
+    
+    int threads = m_config.threads > 0 ? m_config.threads : static_cast<int>(std::thread::hardware_concurrency());
+    threads = std::max(std::min(threads, count), 1);
+    
+    m_running = true;
+    for (int i = 0; i < threads; i++) {
+        m_workers.emplace_back(&MatchHost::workerLoop, this);
+    }
+    
+    std::cout << "Match host running " << count << " matches on " << threads << " threads" << std::endl;
+    return true;
+}
+
+void MatchHost::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_wake.notify_all();
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+    
+    for (MatchServer* match : m_matches) {
+        delete match;
+    }
+    m_matches.clear();
+    m_ports.clear();
+    m_queue = std::priority_queue<Deadline>();
+    
+    // Only once no GameManager refers to it
+    if (m_stage) {
+        delete m_stage;
+        m_stage = nullptr;
+    }
+}
+
+void MatchHost::workerLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_running) {
+        if (m_queue.empty()) {
+            m_wake.wait(lock);
+            continue;
+        }
+        
+        // Wait for the earliest deadline. An earlier one can only appear after another
+        // worker finishes a tick, and that worker notifies.
+        Deadline next = m_queue.top();
+        if (Clock::now() < next.time) {
+            m_wake.wait_until(lock, next.time);
+            continue;
+        }
+        m_queue.pop();
+        
+        lock.unlock();
+        m_matches[next.match]->tick();
+        Clock::time_point end = Clock::now();
+        lock.lock();
+        
+        finishTick(next.match, next.time, end);
+        m_wake.notify_one();
+    }
+}
+
+void MatchHost::finishTick(int match, Clock::time_point deadline, Clock::time_point end) {
+    MatchTickMetrics& metrics = m_metrics[match];
+    double microseconds = std::chrono::duration<double, std::micro>(end - deadline).count();
+    metrics.ticks++;
+    metrics.lastLatencyMicroseconds = microseconds;
+    metrics.maxLatencyMicroseconds = std::max(metrics.maxLatencyMicroseconds, microseconds);
+    metrics.averageLatencyMicroseconds = metrics.ticks == 1 ? microseconds :
+        metrics.averageLatencyMicroseconds + (microseconds - metrics.averageLatencyMicroseconds) * 0.05;
+    
+    Clock::time_point nextDeadline = deadline + m_tickPeriod;
+    if (end > nextDeadline) {
+        metrics.missedDeadlines++;
+    }
+    
+    // Far behind (e.g. the host is overloaded): drop the backlog rather than running a
+    // burst of catch-up ticks that would delay every other match
+    if (end - nextDeadline > m_tickPeriod * MAX_TICKS_BEHIND) {
+        uint64_t behind = static_cast<uint64_t>((end - nextDeadline) / m_tickPeriod);
+        metrics.skippedTicks += behind;
+        nextDeadline += m_tickPeriod * behind;
+    }
+    
+    m_queue.push({nextDeadline, match});
+}
+
+MatchTickMetrics MatchHost::getMatchMetrics(int match) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_metrics[match];
+}
+
+MatchHostMetrics MatchHost::getMetrics() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    MatchHostMetrics result;
+    result.matches = static_cast<int>(m_metrics.size());
+    
+    for (int i = 0; i < result.matches; i++) {
+        const MatchTickMetrics& metrics = m_metrics[i];
+        result.ticks += metrics.ticks;
+        result.missedDeadlines += metrics.missedDeadlines;
+        result.skippedTicks += metrics.skippedTicks;
+        result.averageLatencyMicroseconds += metrics.averageLatencyMicroseconds;
+        if (result.worstMatch < 0 || metrics.maxLatencyMicroseconds > result.maxLatencyMicroseconds) {
+            result.maxLatencyMicroseconds = metrics.maxLatencyMicroseconds;
+            result.worstMatch = i;
+        }
+    }
+    
+    if (result.matches > 0) {
+        result.averageLatencyMicroseconds /= result.matches;
+    }
+    return result;
+}
+
+void MatchHost::resetPeakMetrics() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (MatchTickMetrics& metrics : m_metrics) {
+        metrics.maxLatencyMicroseconds = 0.0;
+    }
+}
@@ -0,0 +1,101 @@
+#ifndef MATCH_HOST_H
+#define MATCH_HOST_H
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+#include "match_server.h"
+#include "../game/stage.h"
+
+struct MatchHostConfig {
+    int matches = 1;
+    int threads = 0;        // 0 uses one per hardware thread
+    ServerConfig server;    // Match i listens on server.port + i, or an ephemeral port if 0
+    MetricsExporter* metrics = nullptr;  // Each match gets a shard of it; not owned
+};
+
+// Tick latency is measured from a tick's deadline to the end of that tick, so it covers
+// both time spent waiting for a worker and the tick itself
+struct MatchTickMetrics {
+    uint64_t ticks = 0;
+    uint64_t missedDeadlines = 0;     // Ticks that finished after the next tick was due
+    uint64_t skippedTicks = 0;        // Dropped when a match fell too far behind
+    double lastLatencyMicroseconds = 0.0;
+    double averageLatencyMicroseconds = 0.0;   // Exponential moving average
+    double maxLatencyMicroseconds = 0.0;
+};
+
+struct MatchHostMetrics {
+    int matches = 0;
+    uint64_t ticks = 0;
+    uint64_t missedDeadlines = 0;
+    uint64_t skippedTicks = 0;
+    double averageLatencyMicroseconds = 0.0;   // Mean of the per-match averages
+    double maxLatencyMicroseconds = 0.0;
+    int worstMatch = -1;                        // Match with the highest max latency
+};
+
+// Runs many independent MatchServers in one process on a pool of worker threads. The
+// stage is built once and shared by every match. Each match is due once per tick period,
+// and workers always take the match with the earliest deadline, so under overload every
+// match falls behind by the same amount instead of some being starved.
+class MatchHost {
+public:
+    MatchHost(const MatchHostConfig& config);
+    ~MatchHost();
+    
+    bool start();
+    void stop();
+    
+    int getMatchCount() const { return static_cast<int>(m_matches.size()); }
+    int getThreadCount() const { return static_cast<int>(m_workers.size()); }
+    
+    // A MatchServer is only touched by one worker at a time but isn't safe to read
+    // while the host is running; use the copies below
+    uint16_t getPort(int match) const { return m_ports[match]; }
+    MatchTickMetrics getMatchMetrics(int match) const;
+    MatchHostMetrics getMetrics() const;
+    
+    void resetPeakMetrics();
+    
+private:
+    typedef std::chrono::steady_clock Clock;
+    
+    // A match waiting for its next tick
+    struct Deadline {
+        Clock::time_point time;
+        int match;
+        
+        // Reversed so std::priority_queue yields the earliest deadline
+        bool operator<(const Deadline& other) const { return time > other.time; }
+    };
+    
+    // Behind by more than this many ticks, a match drops them instead of bursting
+    static constexpr int MAX_TICKS_BEHIND = 8;
+    
+    MatchHostConfig m_config;
+    Stage* m_stage;
+    std::vector<MatchServer*> m_matches;
+    std::vector<uint16_t> m_ports;
+    std::vector<std::thread> m_workers;
+    Clock::duration m_tickPeriod;
+    
+    // Guards everything below
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::priority_queue<Deadline> m_queue;
+    std::vector<MatchTickMetrics> m_metrics;
+    bool m_running;
+    
+    void workerLoop();
+    void finishTick(int match, Clock::time_point deadline, Clock::time_point end);
+    
+    MatchHost(const MatchHost&) = delete;
+    MatchHost& operator=(const MatchHost&) = delete;
+};
+
+#endif
@@ -0,0 +1,350 @@
+#include "match_server.h"
+#include "../game/simulation.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+// Stock matches end as soon as one fighter is left, so wait for an opponent
+static const int MIN_PLAYERS_TO_START = 2;
+
+MatchServer::MatchServer(const ServerConfig& config)
+    : m_config(config)
+    , m_transport(&m_socket)
+    , m_game(nullptr)
+    , m_clients(std::min(std::max(config.maxClients, 1), static_cast<int>(NetSnapshot::MAX_FIGHTERS)))
+    , m_serverTick(0)
+    , m_metricsShard(nullptr)
+    , m_tickBytesSent(0)
+    , m_tickBytesReceived(0)
+{
+    m_packet.reserve(MAX_PACKET_SIZE);
+}
+
+MatchServer::~MatchServer() {
+    stop();
+}
+
+bool MatchServer::start() {
+    if (!m_socket.open(m_config.port, m_config.loopbackOnly)) {
+        return false;
+    }
+    
+    // init() only builds the camera and stage data; meshes are created on first render
+    m_game = new GameManager();
+    m_game->init(m_config.sharedStage);
+    m_serverTick = 0;
+    
+    std::cout << "Match server listening on port " << m_socket.getPort() << std::endl;
+    return true;
+}
+
+void MatchServer::stop() {
+    for (int i = 0; i < static_cast<int>(m_clients.size()); i++) {
+        if (m_clients[i].connected) {
+            m_packet.clear();
+            BitWriter writer(m_packet);
+            writePacketHeader(writer, PACKET_DISCONNECT);
+            writer.flush();
+            sendPacket(i);
+            m_clients[i].connected = false;
+        }
+    }
+    
+    m_socket.close();
+    
+    if (m_game) {
+        delete m_game;
+        m_game = nullptr;
+    }
+}
+
+int MatchServer::getClientCount() const {
+    int count = 0;
+    for (const Client& client : m_clients) {
+        if (client.connected) {
+            count++;
+        }
+    }
+    return count;
+}
+
+const NetSnapshot* MatchServer::getSnapshot(uint32_t tick) const {
+    const NetSnapshot& snapshot = m_history[tick % SNAPSHOT_HISTORY];
+    return snapshot.tick == tick ? &snapshot : nullptr;
+}
+
+void MatchServer::tick() {
+    if (!m_game) {
+        return;
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    uint64_t packetsReceived = m_metrics.packetsReceived;
+    uint64_t packetsRejected = m_metrics.packetsRejected;
+    
+    receivePackets();
+    dropTimedOutClients();
+    
+    bool simulated = m_game->getGameState() == GameState::PLAYING;
+    if (simulated) {
+        gatherInputs();
+        m_game->advanceTick(m_tickInputs, m_game->getPlayerCount());
+    }
+    
+    m_serverTick++;
+    m_history[m_serverTick % SNAPSHOT_HISTORY].capture(*m_game, m_serverTick);
+    sendSnapshots();
+    
+    double microseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    m_metrics.ticks++;
+    m_metrics.lastTickMicroseconds = microseconds;
+    m_metrics.maxTickMicroseconds = std::max(m_metrics.maxTickMicroseconds, microseconds);
+    m_metrics.averageTickMicroseconds = m_metrics.ticks == 1 ? microseconds :
+        m_metrics.averageTickMicroseconds + (microseconds - m_metrics.averageTickMicroseconds) * 0.05;
+    
+    if (m_metricsShard) {
+        m_metricsShard->recordTick(static_cast<uint64_t>(microseconds),
+                                   simulated ? m_game->getSimulationCounters().collisionPairsTested : 0,
+                                   m_tickBytesSent, m_tickBytesReceived,
+                                   m_metrics.packetsReceived - packetsReceived, m_metrics.packetsRejected - packetsRejected,
+                                   getClientCount(), m_game->getGameState() == GameState::PLAYING);
+    }
+    m_tickBytesSent = 0;
+    m_tickBytesReceived = 0;
+}
+
+void MatchServer::receivePackets() {
+    NetAddress from;
+    int size;
+    while ((size = m_transport->receive(from, m_receiveBuffer, sizeof(m_receiveBuffer))) >= 0) {
+        m_metrics.packetsReceived++;
+        
+        BitReader reader(m_receiveBuffer, size);
+        PacketType type;
+        if (!readPacketHeader(reader, type)) {
+            m_metrics.packetsRejected++;
+            continue;
+        }
+        
+        int client = findClient(from);
+        if (type == PACKET_CONNECT) {
+            handleConnect(from, reader);
+            continue;
+        }
+        
+        if (client < 0) {
+            m_metrics.packetsRejected++;
+            continue;
+        }
+        
+        m_clients[client].lastHeardTick = m_serverTick;
+        m_clients[client].metrics.bytesReceived += size;
+        m_tickBytesReceived += size;
+        
+        if (type == PACKET_INPUT) {
+            handleInput(client, reader);
+        } else if (type == PACKET_DISCONNECT) {
+            std::cout << "Client " << client << " (" << from.toString() << ") disconnected" << std::endl;
+            m_clients[client].connected = false;
+        }
+    }
+}
+
+void MatchServer::handleConnect(const NetAddress& from, BitReader& reader) {
+    FighterType type = static_cast<FighterType>(reader.readBits(2));
+    if (reader.hasOverflowed()) {
+        m_metrics.packetsRejected++;
+        return;
+    }
+    
+    // A repeated connect (our accept was lost) gets the same slot back
+    int client = findClient(from);
+    if (client < 0) {
+        for (int i = 0; i < static_cast<int>(m_clients.size()); i++) {
+            if (!m_clients[i].connected) {
+                client = i;
+                break;
+            }
+        }
+    }
+    
+    if (client < 0) {
+        m_packet.clear();
+        BitWriter writer(m_packet);
+        writePacketHeader(writer, PACKET_REJECT);
+        writer.flush();
+        m_transport->send(from, m_packet.data(), m_packet.size());
+        return;
+    }
+    
+    Client& slot = m_clients[client];
+    if (!slot.connected) {
+        bool hadFighter = slot.hasFighter;
+        slot = Client();
+        slot.connected = true;
+        slot.hasFighter = hadFighter;
+        slot.address = from;
+        slot.lastInput = PlayerInput::none();
+        slot.windowStartTick = m_serverTick;
+        for (int i = 0; i < INPUT_BUFFER_SIZE; i++) {
+            slot.inputTicks[i] = NO_TICK;
+        }
+        
+        // Slots fill in order, so the new fighter is always row `client`
+        if (!slot.hasFighter) {
+            m_game->addPlayer(type, client);
+            slot.hasFighter = true;
+        }
+        
+        std::cout << "Client " << client << " connected from " << from.toString() << std::endl;
+        
+        if (m_game->getGameState() != GameState::PLAYING && getClientCount() >= MIN_PLAYERS_TO_START) {
+            m_game->startGame();
+        }
+    }
+    slot.lastHeardTick = m_serverTick;
+    
+    m_packet.clear();
+    BitWriter writer(m_packet);
+    writePacketHeader(writer, PACKET_ACCEPT);
+    writer.writeBits(client, 4);
+    writer.writeBits(m_serverTick, 32);
+    writer.flush();
+    sendPacket(client);
+}
+
+void MatchServer::handleInput(int client, BitReader& reader) {
+    Client& slot = m_clients[client];
+    
+    uint32_t ackedTick = reader.readBits(32);
+    uint32_t firstTick = reader.readBits(32);
+    int count = static_cast<int>(reader.readBits(3));
+    if (reader.hasOverflowed() || count > INPUT_REDUNDANCY) {
+        m_metrics.packetsRejected++;
+        return;
+    }
+    
+    // Only move the ack forward; packets can arrive out of order
+    if (ackedTick != NO_TICK && ackedTick <= m_serverTick &&
+        (slot.ackedTick == NO_TICK || ackedTick > slot.ackedTick)) {
+        slot.ackedTick = ackedTick;
+    }
+    
+    for (int i = 0; i < count; i++) {
+        PlayerInput input = readPlayerInput(reader);
+        uint32_t tick = firstTick + i;
+        if (reader.hasOverflowed()) {
+            break;
+        }
+        
+        // Reported back even when too late to use, so the client can move its clock ahead
+        if (slot.newestInputTick == NO_TICK || static_cast<int32_t>(tick - slot.newestInputTick) > 0) {
+            slot.newestInputTick = tick;
+        }
+        
+        // Too late to apply, or so far ahead it would overwrite inputs we still need
+        if (tick <= m_serverTick || tick > m_serverTick + INPUT_BUFFER_SIZE / 2) {
+            continue;
+        }
+        
+        slot.inputs[tick % INPUT_BUFFER_SIZE] = input;
+        slot.inputTicks[tick % INPUT_BUFFER_SIZE] = tick;
+    }
+}
+
+void MatchServer::dropTimedOutClients() {
+    uint32_t timeoutTicks = secondsToTicks(m_config.clientTimeout);
+    for (int i = 0; i < static_cast<int>(m_clients.size()); i++) {
+        Client& client = m_clients[i];
+        if (client.connected && m_serverTick - client.lastHeardTick > timeoutTicks) {
+            std::cout << "Client " << i << " (" << client.address.toString() << ") timed out" << std::endl;
+            client.connected = false;
+        }
+    }
+}
+
+void MatchServer::gatherInputs() {
+    // The tick being simulated is the one the next snapshot will carry
+    uint32_t tick = m_serverTick + 1;
+    int count = std::min(m_game->getPlayerCount(), static_cast<int>(m_clients.size()));
+    
+    for (int i = 0; i < count; i++) {
+        Client& client = m_clients[i];
+        if (!client.connected) {
+            m_tickInputs[i] = PlayerInput::none();
+            continue;
+        }
+        
+        int index = tick % INPUT_BUFFER_SIZE;
+        if (client.inputTicks[index] == tick) {
+            client.lastInput = client.inputs[index];
+            m_tickInputs[i] = client.inputs[index];
+        } else {
+            // Missing input: keep holding the last direction but don't repeat presses
+            m_tickInputs[i] = client.lastInput;
+            m_tickInputs[i].buttons = 0;
+        }
+    }
+}
+
+void MatchServer::sendSnapshots() {
+    const NetSnapshot& current = m_history[m_serverTick % SNAPSHOT_HISTORY];
+    
+    // Rotate who goes first so a congested uplink doesn't always starve the same client
+    int clientCount = static_cast<int>(m_clients.size());
+    for (int n = 0; n < clientCount; n++) {
+        int i = (m_serverTick + n) % clientCount;
+        Client& client = m_clients[i];
+        if (!client.connected) {
+            continue;
+        }
+        
+        // Fall back to a full snapshot when the acked one has left the history
+        const NetSnapshot* baseline = nullptr;
+        if (client.ackedTick != NO_TICK && m_serverTick - client.ackedTick < SNAPSHOT_HISTORY) {
+            baseline = getSnapshot(client.ackedTick);
+        }
+        
+        m_packet.clear();
+        BitWriter writer(m_packet);
+        writePacketHeader(writer, PACKET_SNAPSHOT);
+        writer.writeBits(baseline ? baseline->tick : NO_TICK, 32);
+        writer.writeBits(client.newestInputTick, 32);
+        NetSnapshot::write(writer, current, baseline);
+        writer.flush();
+        
+        sendPacket(i);
+        client.metrics.snapshotsSent++;
+        if (!baseline) {
+            client.metrics.fullSnapshots++;
+        }
+    }
+}
+
+int MatchServer::findClient(const NetAddress& address) const {
+    for (int i = 0; i < static_cast<int>(m_clients.size()); i++) {
+        if (m_clients[i].connected && m_clients[i].address == address) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void MatchServer::sendPacket(int client) {
+    Client& slot = m_clients[client];
+    if (!m_transport->send(slot.address, m_packet.data(), m_packet.size())) {
+        return;
+    }
+    
+    slot.metrics.bytesSent += m_packet.size();
+    m_tickBytesSent += m_packet.size();
+    slot.windowBytes += m_packet.size();
+    
+    // Bandwidth over roughly the last second of ticks
+    uint32_t elapsed = m_serverTick - slot.windowStartTick;
+    if (elapsed >= static_cast<uint32_t>(SIMULATION_TICK_RATE)) {
+        slot.metrics.bytesPerSecond = static_cast<double>(slot.windowBytes) * SIMULATION_TICK_RATE / elapsed;
+        slot.windowBytes = 0;
+        slot.windowStartTick = m_serverTick;
+    }
+}
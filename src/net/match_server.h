@@ -0,0 +1,120 @@
+#ifndef MATCH_SERVER_H
+#define MATCH_SERVER_H
+
+#include <vector>
+#include <cstdint>
+#include "udp_socket.h"
+#include "transport.h"
+#include "snapshot.h"
+#include "protocol.h"
+#include "metrics_exporter.h"
+#include "../game/game_manager.h"
+
+struct ServerConfig {
+    uint16_t port = 27015;
+    int maxClients = 4;
+    float clientTimeout = 5.0f;   // Seconds of silence before a client is dropped
+    bool loopbackOnly = false;
+    Stage* sharedStage = nullptr; // Used instead of a stage per match; not owned
+};
+
+struct ClientMetrics {
+    uint64_t bytesSent = 0;
+    uint64_t bytesReceived = 0;
+    uint64_t snapshotsSent = 0;
+    uint64_t fullSnapshots = 0;       // Sent without a usable baseline
+    double bytesPerSecond = 0.0;      // Outgoing, over the last second
+};
+
+struct ServerMetrics {
+    uint64_t ticks = 0;
+    double lastTickMicroseconds = 0.0;
+    double averageTickMicroseconds = 0.0;   // Exponential moving average
+    double maxTickMicroseconds = 0.0;
+    uint64_t packetsReceived = 0;
+    uint64_t packetsRejected = 0;           // Bad header, truncated or from unknown peers
+};
+
+// Authoritative match host. Runs a GameManager headless at the simulation tick rate,
+// collects client inputs over UDP and sends each client a snapshot every tick,
+// delta-compressed against the newest snapshot that client acknowledged.
+class MatchServer {
+public:
+    MatchServer(const ServerConfig& config);
+    ~MatchServer();
+    
+    bool start();
+    void stop();
+    
+    // Receive, simulate one tick, broadcast. Call at SIMULATION_TICK_RATE.
+    void tick();
+    
+    // Routes traffic through a shim such as NetworkSimulator; nullptr goes back to the
+    // socket. The shim must wrap getSocket().
+    void setTransport(Transport* transport) { m_transport = transport ? transport : &m_socket; }
+    UdpSocket& getSocket() { return m_socket; }
+    
+    uint32_t getServerTick() const { return m_serverTick; }
+    uint16_t getPort() const { return m_socket.getPort(); }
+    int getClientCount() const;
+    int getMaxClients() const { return static_cast<int>(m_clients.size()); }
+    bool isClientConnected(int client) const { return m_clients[client].connected; }
+    const ClientMetrics& getClientMetrics(int client) const { return m_clients[client].metrics; }
+    const ServerMetrics& getMetrics() const { return m_metrics; }
+    const NetSnapshot* getSnapshot(uint32_t tick) const;
+    
+    void resetPeakMetrics() { m_metrics.maxTickMicroseconds = 0.0; }
+    
+    // Every tick is also recorded here for the metrics endpoint. Not owned.
+    void setMetricsShard(TickMetricsShard* shard) { m_metricsShard = shard; }
+    
+private:
+    static const int SNAPSHOT_HISTORY = 64;
+    static const int INPUT_BUFFER_SIZE = 64;
+    
+    // Client slot i always controls fighter i; a freed slot is reused by the next client
+    struct Client {
+        bool connected = false;
+        bool hasFighter = false;
+        NetAddress address;
+        uint32_t ackedTick = NO_TICK;       // Newest snapshot the client has confirmed
+        uint32_t newestInputTick = NO_TICK;
+        uint32_t lastHeardTick = 0;
+        PlayerInput inputs[INPUT_BUFFER_SIZE];
+        uint32_t inputTicks[INPUT_BUFFER_SIZE];
+        PlayerInput lastInput;
+        
+        ClientMetrics metrics;
+        uint64_t windowBytes = 0;
+        uint32_t windowStartTick = 0;
+    };
+    
+    ServerConfig m_config;
+    UdpSocket m_socket;
+    Transport* m_transport;   // m_socket, or a shim wrapping it
+    GameManager* m_game;
+    std::vector<Client> m_clients;
+    
+    NetSnapshot m_history[SNAPSHOT_HISTORY];
+    uint32_t m_serverTick;
+    
+    ServerMetrics m_metrics;
+    TickMetricsShard* m_metricsShard;
+    uint64_t m_tickBytesSent;       // Since the start of the current tick
+    uint64_t m_tickBytesReceived;
+    
+    std::vector<uint8_t> m_packet;
+    uint8_t m_receiveBuffer[MAX_PACKET_SIZE];
+    PlayerInput m_tickInputs[NetSnapshot::MAX_FIGHTERS];
+    
+    void receivePackets();
+    void handleConnect(const NetAddress& from, BitReader& reader);
+    void handleInput(int client, BitReader& reader);
+    void dropTimedOutClients();
+    void gatherInputs();
+    void sendSnapshots();
+    int findClient(const NetAddress& address) const;
+    void sendPacket(int client);
+};
+
+#endif
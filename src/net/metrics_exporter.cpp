@@ -0,0 +1,297 @@
+#include "metrics_exporter.h"
+#include "../utils/alloc_counter.h"
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+// Longest a slow or idle scraper can hold up the reporter thread
+static const int CLIENT_TIMEOUT_MILLISECONDS = 200;
+static const size_t MAX_REQUEST_SIZE = 4096;
+
+// A scraper hanging up mid-response mustn't raise SIGPIPE
+#ifdef MSG_NOSIGNAL
+static const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+static const int SEND_FLAGS = 0;
+#endif
+
+static uint64_t nowMicroseconds() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+TickMetricsShard::TickMetricsShard()
+    : m_ticks(0), m_tickMicroseconds(0), m_collisionPairs(0), m_bytesSent(0), m_bytesReceived(0),
+      m_packetsReceived(0), m_packetsRejected(0), m_clients(0), m_running(false) {
+    for (std::atomic<uint64_t>& bucket : m_tickBuckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+void TickMetricsShard::recordTick(uint64_t microseconds, uint64_t collisionPairs, uint64_t bytesSent, uint64_t bytesReceived,
+                                  uint64_t packetsReceived, uint64_t packetsRejected, int clients, bool running) {
+    int bucket = 0;
+    while (bucket < TICK_BUCKETS && microseconds > TICK_BUCKET_BOUNDS[bucket]) {
+        bucket++;
+    }
+    
+    m_tickBuckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    m_tickMicroseconds.fetch_add(microseconds, std::memory_order_relaxed);
+    m_collisionPairs.fetch_add(collisionPairs, std::memory_order_relaxed);
+    m_bytesSent.fetch_add(bytesSent, std::memory_order_relaxed);
+    m_bytesReceived.fetch_add(bytesReceived, std::memory_order_relaxed);
+    m_packetsReceived.fetch_add(packetsReceived, std::memory_order_relaxed);
+    m_packetsRejected.fetch_add(packetsRejected, std::memory_order_relaxed);
+    m_clients.store(clients, std::memory_order_relaxed);
+    m_running.store(running, std::memory_order_relaxed);
+    
+    // Last, so a reader that sees the tick count also sees the tick's bucket
+    m_ticks.fetch_add(1, std::memory_order_release);
+}
+
+MetricsExporter::MetricsExporter()
+    : m_listenHandle(-1)
+    , m_port(0)
+    , m_intervalMilliseconds(1000)
+    , m_running(false)
+    , m_previousMicroseconds(0)
+{
+}
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+}
+
+bool MetricsExporter::start(uint16_t port, int intervalMilliseconds) {
+    stop();
+    
+    m_listenHandle = socket(AF_INET, SOCK_STREAM, 0);
+    if (m_listenHandle < 0) {
+        std::cerr << "Failed to create metrics socket: " << strerror(errno) << std::endl;
+        return false;
+    }
+    
+    int reuse = 1;
+    setsockopt(m_listenHandle, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    
+    if (bind(m_listenHandle, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || listen(m_listenHandle, 8) < 0) {
+        std::cerr << "Failed to listen for metrics on port " << port << ": " << strerror(errno) << std::endl;
+        ::close(m_listenHandle);
+        m_listenHandle = -1;
+        return false;
+    }
+    
+    socklen_t length = sizeof(address);
+    getsockname(m_listenHandle, reinterpret_cast<sockaddr*>(&address), &length);
+    m_port = ntohs(address.sin_port);
+    m_intervalMilliseconds = std::max(intervalMilliseconds, 10);
+    
+    m_previous = Totals();
+    m_previous.allocations = AllocationCounter::get().allocations;
+    m_previousMicroseconds = nowMicroseconds();
+    aggregate();
+    
+    m_running = true;
+    m_reporter = std::thread(&MetricsExporter::reporterLoop, this);
+    
+    std::cout << "Metrics at http://127.0.0.1:" << m_port << "/metrics" << std::endl;
+    return true;
+}
+
+void MetricsExporter::stop() {
+    m_running = false;
+    if (m_reporter.joinable()) {
+        m_reporter.join();
+    }
+    if (m_listenHandle >= 0) {
+        ::close(m_listenHandle);
+        m_listenHandle = -1;
+    }
+}
+
+TickMetricsShard* MetricsExporter::createShard() {
+    std::lock_guard<std::mutex> lock(m_shardMutex);
+    m_shards.emplace_back(new TickMetricsShard());
+    return m_shards.back().get();
+}
+
+std::string MetricsExporter::getPage() {
+    std::lock_guard<std::mutex> lock(m_pageMutex);
+    return m_page;
+}
+
+void MetricsExporter::reporterLoop() {
+    uint64_t nextAggregate = nowMicroseconds() + m_intervalMilliseconds * 1000ULL;
+    
+    while (m_running) {
+        uint64_t now = nowMicroseconds();
+        if (now >= nextAggregate) {
+            aggregate();
+            nextAggregate += m_intervalMilliseconds * 1000ULL;
+            if (nextAggregate <= now) {
+                nextAggregate = now + m_intervalMilliseconds * 1000ULL;
+            }
+            continue;
+        }
+        
+        // Wake for the next aggregation, and at least every 100 ms so stop() is prompt
+        pollfd listener = {m_listenHandle, POLLIN, 0};
+        int timeout = static_cast<int>(std::min<uint64_t>((nextAggregate - now) / 1000 + 1, 100));
+        if (poll(&listener, 1, timeout) > 0 && (listener.revents & POLLIN)) {
+            int client = accept(m_listenHandle, nullptr, nullptr);
+            if (client >= 0) {
+                serveClient(client);
+                ::close(client);
+            }
+        }
+    }
+}
+
+void MetricsExporter::aggregate() {
+    Totals totals;
+    {
+        std::lock_guard<std::mutex> lock(m_shardMutex);
+        totals.matches = static_cast<int>(m_shards.size());
+        for (const std::unique_ptr<TickMetricsShard>& shard : m_shards) {
+            totals.ticks += shard->m_ticks.load(std::memory_order_acquire);
+            for (int i = 0; i <= TickMetricsShard::TICK_BUCKETS; i++) {
+                totals.tickBuckets[i] += shard->m_tickBuckets[i].load(std::memory_order_relaxed);
+            }
+            totals.tickMicroseconds += shard->m_tickMicroseconds.load(std::memory_order_relaxed);
+            totals.collisionPairs += shard->m_collisionPairs.load(std::memory_order_relaxed);
+            totals.bytesSent += shard->m_bytesSent.load(std::memory_order_relaxed);
+            totals.bytesReceived += shard->m_bytesReceived.load(std::memory_order_relaxed);
+            totals.packetsReceived += shard->m_packetsReceived.load(std::memory_order_relaxed);
+            totals.packetsRejected += shard->m_packetsRejected.load(std::memory_order_relaxed);
+            totals.clients += shard->m_clients.load(std::memory_order_relaxed);
+            totals.matchesRunning += shard->m_running.load(std::memory_order_relaxed) ? 1 : 0;
+        }
+    }
+    totals.allocations = AllocationCounter::get().allocations;
+    
+    // Buckets and the tick count are read at slightly different moments, so the
+    // histogram's count is taken from its own buckets to keep it consistent
+    uint64_t bucketTotal = 0;
+    for (uint64_t count : totals.tickBuckets) {
+        bucketTotal += count;
+    }
+    
+    uint64_t now = nowMicroseconds();
+    double seconds = (now - m_previousMicroseconds) / 1000000.0;
+    double allocationRate = seconds > 0.0 ? (totals.allocations - m_previous.allocations) / seconds : 0.0;
+    double tickRate = seconds > 0.0 ? (totals.ticks - m_previous.ticks) / seconds : 0.0;
+    
+    std::ostringstream page;
+    page << "# HELP fps_server_ticks_total Simulation ticks run by all matches.\n"
+         << "# TYPE fps_server_ticks_total counter\n"
+         << "fps_server_ticks_total " << totals.ticks << "\n"
+         << "# HELP fps_server_ticks_per_second Ticks per second over the last reporting interval.\n"
+         << "# TYPE fps_server_ticks_per_second gauge\n"
+         << "fps_server_ticks_per_second " << tickRate << "\n";
+    
+    page << "# HELP fps_server_tick_duration_seconds Time to receive, simulate and broadcast one tick.\n"
+         << "# TYPE fps_server_tick_duration_seconds histogram\n";
+    uint64_t cumulative = 0;
+    for (int i = 0; i < TickMetricsShard::TICK_BUCKETS; i++) {
+        cumulative += totals.tickBuckets[i];
+        page << "fps_server_tick_duration_seconds_bucket{le=\"" << TickMetricsShard::TICK_BUCKET_BOUNDS[i] / 1000000.0 << "\"} " << cumulative << "\n";
+    }
+    page << "fps_server_tick_duration_seconds_bucket{le=\"+Inf\"} " << bucketTotal << "\n"
+         << "fps_server_tick_duration_seconds_sum " << totals.tickMicroseconds / 1000000.0 << "\n"
+         << "fps_server_tick_duration_seconds_count " << bucketTotal << "\n";
+    
+    page << "# HELP fps_server_matches Matches hosted by this process.\n"
+         << "# TYPE fps_server_matches gauge\n"
+         << "fps_server_matches " << totals.matches << "\n"
+         << "# HELP fps_server_matches_running Matches currently in play.\n"
+         << "# TYPE fps_server_matches_running gauge\n"
+         << "fps_server_matches_running " << totals.matchesRunning << "\n"
+         << "# HELP fps_server_clients Connected clients across all matches.\n"
+         << "# TYPE fps_server_clients gauge\n"
+         << "fps_server_clients " << totals.clients << "\n";
+    
+    page << "# HELP fps_server_collision_pairs_total Hitbox against fighter checks.\n"
+         << "# TYPE fps_server_collision_pairs_total counter\n"
+         << "fps_server_collision_pairs_total " << totals.collisionPairs << "\n"
+         << "# HELP fps_server_bytes_sent_total UDP payload bytes sent to clients.\n"
+         << "# TYPE fps_server_bytes_sent_total counter\n"
+         << "fps_server_bytes_sent_total " << totals.bytesSent << "\n"
+         << "# HELP fps_server_bytes_received_total UDP payload bytes received from clients.\n"
+         << "# TYPE fps_server_bytes_received_total counter\n"
+         << "fps_server_bytes_received_total " << totals.bytesReceived << "\n"
+         << "# HELP fps_server_packets_received_total UDP packets received, including rejected ones.\n"
+         << "# TYPE fps_server_packets_received_total counter\n"
+         << "fps_server_packets_received_total " << totals.packetsReceived << "\n"
+         << "# HELP fps_server_packets_rejected_total Packets with a bad header or from unknown peers.\n"
+         << "# TYPE fps_server_packets_rejected_total counter\n"
+         << "fps_server_packets_rejected_total " << totals.packetsRejected << "\n";
+    
+    page << "# HELP fps_server_allocations_total Heap allocations made by the process.\n"
+         << "# TYPE fps_server_allocations_total counter\n"
+         << "fps_server_allocations_total " << totals.allocations << "\n"
+         << "# HELP fps_server_allocations_per_second Heap allocations per second over the last reporting interval.\n"
+         << "# TYPE fps_server_allocations_per_second gauge\n"
+         << "fps_server_allocations_per_second " << allocationRate << "\n";
+    
+    {
+        std::lock_guard<std::mutex> lock(m_pageMutex);
+        m_page = page.str();
+    }
+    m_previous = totals;
+    m_previousMicroseconds = now;
+}
+
+void MetricsExporter::serveClient(int handle) {
+    timeval timeout = {0, CLIENT_TIMEOUT_MILLISECONDS * 1000};
+    setsockopt(handle, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(handle, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+#ifdef SO_NOSIGPIPE
+    int noSigpipe = 1;
+    setsockopt(handle, SOL_SOCKET, SO_NOSIGPIPE, &noSigpipe, sizeof(noSigpipe));
+#endif
+    
+    // Only the request line matters; read until the end of the headers
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < MAX_REQUEST_SIZE) {
+        ssize_t received = recv(handle, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            break;
+        }
+        request.append(buffer, received);
+    }
+    
+    bool found = request.compare(0, 13, "GET /metrics ") == 0 || request.compare(0, 6, "GET / ") == 0;
+    std::string body = found ? getPage() : "Not found\n";
+    
+    std::ostringstream response;
+    response << (found ? "HTTP/1.1 200 OK\r\n" : "HTTP/1.1 404 Not Found\r\n")
+             << "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+             << "Content-Length: " << body.size() << "\r\n"
+             << "Connection: close\r\n\r\n"
+             << body;
+    
+    std::string data = response.str();
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t result = send(handle, data.data() + sent, data.size() - sent, SEND_FLAGS);
+        if (result <= 0) {
+            break;
+        }
+        sent += result;
+    }
+}
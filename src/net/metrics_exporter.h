@@ -0,0 +1,105 @@
+#ifndef METRICS_EXPORTER_H
+#define METRICS_EXPORTER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+// One tick thread's counters. Only the match that owns a shard writes to it, with
+// relaxed atomics and no locks; the exporter's reporter thread reads every shard.
+class TickMetricsShard {
+public:
+    // Upper bounds of the tick duration histogram buckets, in microseconds. A tick at
+    // 60 Hz has 16667 us; the last bucket is everything slower.
+    static constexpr int TICK_BUCKETS = 10;
+    static constexpr uint64_t TICK_BUCKET_BOUNDS[TICK_BUCKETS] = {
+        50, 100, 250, 500, 1000, 2500, 5000, 10000, 16667, 33333
+    };
+    
+    TickMetricsShard();
+    
+    // Called once at the end of every tick
+    void recordTick(uint64_t microseconds, uint64_t collisionPairs, uint64_t bytesSent, uint64_t bytesReceived,
+                    uint64_t packetsReceived, uint64_t packetsRejected, int clients, bool running);
+    
+private:
+    friend class MetricsExporter;
+    
+    std::atomic<uint64_t> m_ticks;
+    std::atomic<uint64_t> m_tickMicroseconds;            // Sum, for the histogram
+    std::atomic<uint64_t> m_tickBuckets[TICK_BUCKETS + 1];  // Not cumulative
+    std::atomic<uint64_t> m_collisionPairs;
+    std::atomic<uint64_t> m_bytesSent;
+    std::atomic<uint64_t> m_bytesReceived;
+    std::atomic<uint64_t> m_packetsReceived;
+    std::atomic<uint64_t> m_packetsRejected;
+    std::atomic<int> m_clients;
+    std::atomic<bool> m_running;
+};
+
+// Serves server metrics in the Prometheus text format at http://127.0.0.1:PORT/metrics.
+// Matches record into their own TickMetricsShard. A reporter thread sums the shards
+// once per interval, computes rates and renders the page, and between
+// aggregations answers scrapes with the latest page, so a scrape never touches a
+// tick thread.
+class MetricsExporter {
+public:
+    MetricsExporter();
+    ~MetricsExporter();
+    
+    // Binds 127.0.0.1 only; port 0 picks a free one (see getPort)
+    bool start(uint16_t port, int intervalMilliseconds = 1000);
+    void stop();
+    
+    uint16_t getPort() const { return m_port; }
+    
+    // Owned by the exporter and kept until it's destroyed; safe to call while running
+    TickMetricsShard* createShard();
+    
+    // The page the next scrape would get
+    std::string getPage();
+    
+private:
+    struct Totals {
+        uint64_t ticks = 0;
+        uint64_t tickMicroseconds = 0;
+        uint64_t tickBuckets[TickMetricsShard::TICK_BUCKETS + 1] = {};
+        uint64_t collisionPairs = 0;
+        uint64_t bytesSent = 0;
+        uint64_t bytesReceived = 0;
+        uint64_t packetsReceived = 0;
+        uint64_t packetsRejected = 0;
+        int clients = 0;
+        int matches = 0;
+        int matchesRunning = 0;
+        uint64_t allocations = 0;
+    };
+    
+    std::vector<std::unique_ptr<TickMetricsShard>> m_shards;
+    std::mutex m_shardMutex;      // Shard list only; never taken on a tick thread
+    
+    int m_listenHandle;
+    uint16_t m_port;
+    int m_intervalMilliseconds;
+    std::atomic<bool> m_running;
+    std::thread m_reporter;
+    
+    // Reporter thread only, apart from getPage
+    Totals m_previous;
+    uint64_t m_previousMicroseconds;
+    std::string m_page;
+    std::mutex m_pageMutex;
+    
+    void reporterLoop();
+    void aggregate();
+    void serveClient(int handle);
+    
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+};
+
+#endif
@@ -0,0 +1,233 @@
+#include "network_simulator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+
+// Heap order: earliest deliverTime on top, send order breaking ties
+template <typename Packet>
+static bool deliversLater(const Packet& a, const Packet& b) {
+    return a.deliverTime > b.deliverTime || (a.deliverTime == b.deliverTime && a.sequence > b.sequence);
+}
+
+NetworkSimulator::NetworkSimulator(Transport* inner, uint64_t seed)
+    : m_inner(inner)
+    , m_scriptIndex(0)
+    , m_rngState(0)
+    , m_time(0.0)
+    , m_linkFreeTime(0.0)
+    , m_lastInOrderTime(0.0)
+    , m_sequence(0)
+{
+    setSeed(seed);
+}
+
+void NetworkSimulator::setSeed(uint64_t seed) {
+    // splitmix64 so nearby seeds still give unrelated streams
+    uint64_t z = seed + 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    m_rngState = (z ^ (z >> 31)) | 1;
+}
+
+double NetworkSimulator::nextRandom() {
+    // xorshift64*; std distributions differ between standard libraries, this doesn't
+    m_rngState ^= m_rngState >> 12;
+    m_rngState ^= m_rngState << 25;
+    m_rngState ^= m_rngState >> 27;
+    uint64_t value = m_rngState * 0x2545F4914F6CDD1Dull;
+    return (value >> 11) * (1.0 / 9007199254740992.0);
+}
+
+double NetworkSimulator::sampleDelay() {
+    double delay = m_conditions.latencyMs;
+    
+    switch (m_conditions.distribution) {
+        case LatencyDistribution::CONSTANT:
+            break;
+        case LatencyDistribution::UNIFORM:
+            delay += (nextRandom() * 2.0 - 1.0) * m_conditions.jitterMs;
+            break;
+        case LatencyDistribution::NORMAL: {
+            // Box-Muller
+            double u1 = std::max(nextRandom(), 1e-12);
+            double u2 = nextRandom();
+            delay += std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2) * m_conditions.jitterMs;
+            break;
+        }
+    }
+    
+    return std::max(delay, 0.0) / 1000.0;
+}
+
+void NetworkSimulator::addScriptStep(double time, const NetworkConditions& conditions) {
+    ScriptStep step;
+    step.time = time;
+    step.conditions = conditions;
+    
+    auto position = std::upper_bound(m_script.begin() + m_scriptIndex, m_script.end(), time,
+        [](double value, const ScriptStep& other) { return value < other.time; });
+    m_script.insert(position, step);
+}
+
+bool NetworkSimulator::loadScript(const std::string& script) {
+    NetworkConditions conditions = m_conditions;
+    std::stringstream stream(script);
+    std::string entry;
+    
+    while (std::getline(stream, entry, ';')) {
+        if (entry.empty()) {
+            continue;
+        }
+        
+        double time = 0.0;
+        size_t colon = entry.find(':');
+        if (colon != std::string::npos) {
+            char* end = nullptr;
+            time = strtod(entry.c_str(), &end);
+            if (end != entry.c_str() + colon) {
+                return false;
+            }
+            entry = entry.substr(colon + 1);
+        }
+        
+        if (!NetworkConditions::parse(entry, conditions)) {
+            return false;
+        }
+        addScriptStep(time, conditions);
+    }
+    
+    // Steps at time zero take effect before anything is sent
+    update(0.0);
+    return true;
+}
+
+void NetworkSimulator::update(double deltaSeconds) {
+    m_time += deltaSeconds;
+    
+    while (m_scriptIndex < m_script.size() && m_script[m_scriptIndex].time <= m_time) {
+        m_conditions = m_script[m_scriptIndex].conditions;
+        m_scriptIndex++;
+    }
+    
+    while (!m_pending.empty() && m_pending.front().deliverTime <= m_time) {
+        std::pop_heap(m_pending.begin(), m_pending.end(), deliversLater<PendingPacket>);
+        PendingPacket& packet = m_pending.back();
+        
+        if (m_inner->send(packet.to, packet.data.data(), packet.data.size())) {
+            m_stats.packetsDelivered++;
+            m_stats.bytesDelivered += packet.data.size();
+        }
+        
+        m_freeBuffers.push_back(std::move(packet.data));
+        m_pending.pop_back();
+    }
+}
+
+void NetworkSimulator::schedule(const NetAddress& to, const uint8_t* data, size_t size, double deliverTime) {
+    PendingPacket packet;
+    packet.deliverTime = deliverTime;
+    packet.sequence = m_sequence++;
+    packet.to = to;
+    
+    if (!m_freeBuffers.empty()) {
+        packet.data = std::move(m_freeBuffers.back());
+        m_freeBuffers.pop_back();
+    }
+    packet.data.assign(data, data + size);
+    
+    m_pending.push_back(std::move(packet));
+    std::push_heap(m_pending.begin(), m_pending.end(), deliversLater<PendingPacket>);
+}
+
+bool NetworkSimulator::send(const NetAddress& to, const uint8_t* data, size_t size) {
+    m_stats.packetsSent++;
+    
+    // Bandwidth cap: packets serialize onto the link one after another
+    double departTime = m_time;
+    if (m_conditions.bandwidthKbps > 0.0f) {
+        double bytesPerSecond = m_conditions.bandwidthKbps * 1000.0 / 8.0;
+        double linkStart = std::max(m_linkFreeTime, m_time);
+        double backlogBytes = (linkStart - m_time) * bytesPerSecond;
+        if (backlogBytes + size > m_conditions.queueLimitBytes) {
+            m_stats.packetsQueueDropped++;
+            return true;  // Lost on the wire, not a local send failure
+        }
+        
+        m_linkFreeTime = linkStart + size / bytesPerSecond;
+        departTime = m_linkFreeTime;
+    }
+    
+    if (nextRandom() * 100.0 < m_conditions.lossPercent) {
+        m_stats.packetsLost++;
+        return true;
+    }
+    
+    double deliverTime = departTime + sampleDelay();
+    if (nextRandom() * 100.0 < m_conditions.reorderPercent) {
+        m_stats.packetsReordered++;
+        deliverTime += m_conditions.reorderDelayMs / 1000.0;
+    } else {
+        deliverTime = std::max(deliverTime, m_lastInOrderTime);
+        m_lastInOrderTime = deliverTime;
+    }
+    schedule(to, data, size, deliverTime);
+    
+    if (nextRandom() * 100.0 < m_conditions.duplicatePercent) {
+        m_stats.packetsDuplicated++;
+        schedule(to, data, size, departTime + sampleDelay());
+    }
+    
+    return true;
+}
+
+int NetworkSimulator::receive(NetAddress& from, uint8_t* buffer, size_t capacity) {
+    // Conditions apply to outgoing traffic; the peer's simulator handles the other way
+    return m_inner->receive(from, buffer, capacity);
+}
+
+bool NetworkConditions::parse(const std::string& spec, NetworkConditions& conditions) {
+    std::stringstream stream(spec);
+    std::string entry;
+    
+    while (std::getline(stream, entry, ',')) {
+        if (entry.empty()) {
+            continue;
+        }
+        
+        size_t equals = entry.find('=');
+        if (equals == std::string::npos) {
+            return false;
+        }
+        
+        std::string key = entry.substr(0, equals);
+        std::string value = entry.substr(equals + 1);
+        char* end = nullptr;
+        double number = strtod(value.c_str(), &end);
+        bool isNumber = !value.empty() && *end == '\0';
+        
+        if (key == "dist") {
+            if (value == "constant") conditions.distribution = LatencyDistribution::CONSTANT;
+            else if (value == "uniform") conditions.distribution = LatencyDistribution::UNIFORM;
+            else if (value == "normal") conditions.distribution = LatencyDistribution::NORMAL;
+            else return false;
+            continue;
+        }
+        
+        if (!isNumber) {
+            return false;
+        }
+        
+        if (key == "latency") conditions.latencyMs = static_cast<float>(number);
+        else if (key == "jitter") conditions.jitterMs = static_cast<float>(number);
+        else if (key == "loss") conditions.lossPercent = static_cast<float>(number);
+        else if (key == "dup") conditions.duplicatePercent = static_cast<float>(number);
+        else if (key == "reorder") conditions.reorderPercent = static_cast<float>(number);
+        else if (key == "reorder_delay") conditions.reorderDelayMs = static_cast<float>(number);
+        else if (key == "bandwidth") conditions.bandwidthKbps = static_cast<float>(number);
+        else if (key == "queue") conditions.queueLimitBytes = static_cast<int>(number);
+        else return false;
+    }
+    
+    return true;
+}
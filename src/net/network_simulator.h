@@ -0,0 +1,105 @@
+#ifndef NETWORK_SIMULATOR_H
+#define NETWORK_SIMULATOR_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "transport.h"
+
+enum class LatencyDistribution {
+    CONSTANT,
+    UNIFORM,    // latency +- jitter
+    NORMAL      // jitter is the standard deviation
+};
+
+struct NetworkConditions {
+    float latencyMs = 0.0f;          // One-way delay
+    float jitterMs = 0.0f;
+    LatencyDistribution distribution = LatencyDistribution::UNIFORM;
+    float lossPercent = 0.0f;
+    float duplicatePercent = 0.0f;
+    float reorderPercent = 0.0f;     // Chance a packet is held back behind later ones
+    float reorderDelayMs = 20.0f;
+    float bandwidthKbps = 0.0f;      // Link rate in kilobits per second, 0 for unlimited
+    int queueLimitBytes = 64 * 1024; // Packets beyond this much backlog are tail-dropped
+    
+    // Comma-separated key=value list, e.g. "latency=80,jitter=10,dist=normal,loss=2".
+    // Keys: latency, jitter, dist (constant|uniform|normal), loss, dup, reorder,
+    // reorder_delay, bandwidth, queue. Unset keys keep their current value.
+    static bool parse(const std::string& spec, NetworkConditions& conditions);
+};
+
+struct NetworkSimulatorStats {
+    uint64_t packetsSent = 0;
+    uint64_t packetsDelivered = 0;
+    uint64_t packetsLost = 0;
+    uint64_t packetsQueueDropped = 0;
+    uint64_t packetsDuplicated = 0;
+    uint64_t packetsReordered = 0;
+    uint64_t bytesDelivered = 0;
+};
+
+// Transport shim that holds outgoing packets and releases them to the wrapped transport
+// according to NetworkConditions. Time only moves in update(), and all randomness comes
+// from a seeded generator, so the same seed, script and send pattern always produce the
+// same drops, delays and orderings. Put one in front of each endpoint to affect both
+// directions.
+class NetworkSimulator : public Transport {
+public:
+    NetworkSimulator(Transport* inner, uint64_t seed = 1);
+    
+    void setSeed(uint64_t seed);
+    void setConditions(const NetworkConditions& conditions) { m_conditions = conditions; }
+    const NetworkConditions& getConditions() const { return m_conditions; }
+    
+    // Switches to `conditions` once the simulator clock reaches `time` seconds
+    void addScriptStep(double time, const NetworkConditions& conditions);
+    
+    // Semicolon-separated "seconds:spec" steps, each applied on top of the previous one,
+    // e.g. "0:latency=50,jitter=5;10:loss=20;15:loss=0". A step without a time starts at 0.
+    bool loadScript(const std::string& script);
+    
+    // Advances the simulator clock and forwards every packet that is now due
+    void update(double deltaSeconds);
+    
+    bool send(const NetAddress& to, const uint8_t* data, size_t size) override;
+    int receive(NetAddress& from, uint8_t* buffer, size_t capacity) override;
+    
+    double getTime() const { return m_time; }
+    int getQueuedPackets() const { return static_cast<int>(m_pending.size()); }
+    const NetworkSimulatorStats& getStats() const { return m_stats; }
+    
+private:
+    struct PendingPacket {
+        double deliverTime;
+        uint64_t sequence;    // Ties deliver in send order
+        NetAddress to;
+        std::vector<uint8_t> data;
+    };
+    
+    struct ScriptStep {
+        double time;
+        NetworkConditions conditions;
+    };
+    
+    Transport* m_inner;
+    NetworkConditions m_conditions;
+    std::vector<ScriptStep> m_script;
+    size_t m_scriptIndex;
+    
+    uint64_t m_rngState;
+    double m_time;
+    double m_linkFreeTime;        // When the bandwidth-limited link finishes its backlog
+    double m_lastInOrderTime;     // Jitter alone never reorders, like a real FIFO link
+    uint64_t m_sequence;
+    
+    std::vector<PendingPacket> m_pending;   // Min-heap on deliverTime
+    std::vector<std::vector<uint8_t>> m_freeBuffers;
+    NetworkSimulatorStats m_stats;
+    
+    double nextRandom();
+    double sampleDelay();
+    void schedule(const NetAddress& to, const uint8_t* data, size_t size, double deliverTime);
+};
+
+#endif
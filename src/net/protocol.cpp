@@ -0,0 +1,41 @@
+#include "protocol.h"
+
+static const int PACKET_TYPE_BITS = 3;
+
+void writePacketHeader(BitWriter& writer, PacketType type) {
+    writer.writeBits(PROTOCOL_ID, 32);
+    writer.writeBits(type, PACKET_TYPE_BITS);
+}
+
+bool readPacketHeader(BitReader& reader, PacketType& type) {
+    if (reader.readBits(32) != PROTOCOL_ID) {
+        return false;
+    }
+    
+    uint32_t value = reader.readBits(PACKET_TYPE_BITS);
+    if (reader.hasOverflowed() || value >= PACKET_TYPE_COUNT) {
+        return false;
+    }
+    
+    type = static_cast<PacketType>(value);
+    return true;
+}
+
+void writePlayerInput(BitWriter& writer, const PlayerInput& input) {
+    writer.writeBits(static_cast<uint32_t>(input.moveX + 1), 2);
+    writer.writeBits(input.buttons, 2);
+    writer.writeBits(input.attackType, 3);
+}
+
+PlayerInput readPlayerInput(BitReader& reader) {
+    PlayerInput input = PlayerInput::none();
+    input.moveX = static_cast<int8_t>(static_cast<int>(reader.readBits(2)) - 1);
+    input.buttons = static_cast<uint8_t>(reader.readBits(2));
+    input.attackType = static_cast<uint8_t>(reader.readBits(3));
+    
+    // Reject out-of-range movement from a corrupted or hostile packet
+    if (input.moveX > 1) {
+        input.moveX = 0;
+    }
+    return input;
+}
@@ -0,0 +1,44 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <cstdint>
+#include "bit_stream.h"
+#include "../game/player_input.h"
+
+// Every packet starts with this so stray datagrams on the port are ignored
+const uint32_t PROTOCOL_ID = 0x53465031;  // "SFP1"
+
+// Stays under a typical path MTU so packets are never fragmented
+const int MAX_PACKET_SIZE = 1200;
+
+// Marks "no tick", e.g. a snapshot with no baseline
+const uint32_t NO_TICK = 0xFFFFFFFFu;
+
+// Each input packet repeats this many recent ticks so a lost packet costs nothing
+const int INPUT_REDUNDANCY = 4;
+
+// How far ahead of the newest snapshot clients stamp their inputs, so they reach the
+// server before it simulates that tick
+const uint32_t INPUT_LEAD_TICKS = 3;
+
+// Clients push their input clock forward whenever the server reports holding fewer
+// than this many ticks of input beyond the snapshot it just sent
+const int32_t INPUT_MIN_MARGIN = 2;
+
+enum PacketType : uint8_t {
+    PACKET_CONNECT,     // client -> server: fighter type
+    PACKET_ACCEPT,      // server -> client: player index, server tick
+    PACKET_REJECT,      // server -> client: match is full
+    PACKET_INPUT,       // client -> server: acked snapshot tick, recent inputs
+    PACKET_SNAPSHOT,    // server -> client: match state, delta against the acked tick
+    PACKET_DISCONNECT,
+    PACKET_TYPE_COUNT
+};
+
+void writePacketHeader(BitWriter& writer, PacketType type);
+bool readPacketHeader(BitReader& reader, PacketType& type);
+
+void writePlayerInput(BitWriter& writer, const PlayerInput& input);
+PlayerInput readPlayerInput(BitReader& reader);
+
+#endif
@@ -0,0 +1,210 @@
+#include "snapshot.h"
+#include "../game/game_manager.h"
+#include "../game/simulation.h"
+#include <algorithm>
+#include <cmath>
+
+// Field widths for full values. Positions cover +-512 units and velocities
+// +-512 units/s, well past any blast zone.
+static const int POSITION_BITS = 18;
+static const int VELOCITY_BITS = 16;
+static const int DELTA_BITS = 8;
+static const int STATE_BITS = 3;
+static const int FLAG_BITS = 3;
+static const int DAMAGE_BITS = 14;
+static const int LIVES_BITS = 4;
+static const int GAME_STATE_BITS = 3;
+static const int FIGHTER_COUNT_BITS = 4;
+static const int MATCH_TICKS_BITS = 25;  // Zig-zagged, so 2^24 ticks: over 77 hours at 60 Hz
+
+// Deltas that fit in DELTA_BITS (zig-zagged) are sent as a delta, anything else in full
+static void writeIntDelta(BitWriter& writer, int32_t value, int32_t base, int fullBits) {
+    int32_t delta = value - base;
+    if (delta >= -(1 << (DELTA_BITS - 1)) && delta < (1 << (DELTA_BITS - 1))) {
+        writer.writeBool(true);
+        writer.writeSigned(delta, DELTA_BITS);
+    } else {
+        writer.writeBool(false);
+        writer.writeSigned(value, fullBits);
+    }
+}
+
+static int32_t readIntDelta(BitReader& reader, int32_t base, int fullBits) {
+    if (reader.readBool()) {
+        return base + reader.readSigned(DELTA_BITS);
+    }
+    return reader.readSigned(fullBits);
+}
+
+static int32_t quantize(float value, float scale, int bits) {
+    int32_t limit = (1 << (bits - 1)) - 1;
+    int32_t quantized = static_cast<int32_t>(std::lround(value * scale));
+    return std::min(std::max(quantized, -limit), limit);
+}
+
+bool NetFighterState::operator==(const NetFighterState& other) const {
+    return positionX == other.positionX && positionY == other.positionY &&
+           velocityX == other.velocityX && velocityY == other.velocityY &&
+           state == other.state && flags == other.flags &&
+           damage == other.damage && lives == other.lives;
+}
+
+void NetSnapshot::capture(const GameManager& game, uint32_t serverTick) {
+    const FighterComponents& components = game.getFighters();
+    
+    tick = serverTick;
+    gameState = static_cast<uint8_t>(game.getGameState());
+    matchTicks = static_cast<uint32_t>(std::lround(game.getMatchTimer() * SIMULATION_TICK_RATE));
+    fighterCount = std::min(components.size(), static_cast<int>(MAX_FIGHTERS));
+    
+    for (int i = 0; i < fighterCount; i++) {
+        NetFighterState& fighter = fighters[i];
+        fighter.positionX = quantize(toFloat(components.m_positions[i].x), POSITION_SCALE, POSITION_BITS);
+        fighter.positionY = quantize(toFloat(components.m_positions[i].y), POSITION_SCALE, POSITION_BITS);
+        fighter.velocityX = quantize(toFloat(components.m_velocities[i].x), VELOCITY_SCALE, VELOCITY_BITS);
+        fighter.velocityY = quantize(toFloat(components.m_velocities[i].y), VELOCITY_SCALE, VELOCITY_BITS);
+        fighter.state = static_cast<uint8_t>(components.m_states[i]);
+        fighter.flags = components.m_flags[i] & ((1 << FLAG_BITS) - 1);
+        fighter.damage = static_cast<uint16_t>(std::min(std::max(toFloat(components.m_damagePercents[i]) * 10.0f, 0.0f), 16383.0f));
+        fighter.lives = static_cast<uint8_t>(std::min(std::max(components.m_lives[i], 0), 15));
+    }
+    
+    for (int i = fighterCount; i < MAX_FIGHTERS; i++) {
+        fighters[i] = NetFighterState();
+    }
+}
+
+glm::vec2 NetSnapshot::getPosition(int fighter) const {
+    return glm::vec2(fighters[fighter].positionX / POSITION_SCALE, fighters[fighter].positionY / POSITION_SCALE);
+}
+
+glm::vec2 NetSnapshot::getVelocity(int fighter) const {
+    return glm::vec2(fighters[fighter].velocityX / VELOCITY_SCALE, fighters[fighter].velocityY / VELOCITY_SCALE);
+}
+
+bool NetSnapshot::operator==(const NetSnapshot& other) const {
+    if (tick != other.tick || gameState != other.gameState || matchTicks != other.matchTicks ||
+        fighterCount != other.fighterCount) {
+        return false;
+    }
+    
+    for (int i = 0; i < fighterCount; i++) {
+        if (fighters[i] != other.fighters[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void NetSnapshot::write(BitWriter& writer, const NetSnapshot& snapshot, const NetSnapshot* baseline) {
+    static const NetSnapshot empty;
+    const NetSnapshot& base = baseline ? *baseline : empty;
+    bool full = baseline == nullptr;
+    
+    writer.writeBits(snapshot.tick, 32);
+    writer.writeBits(snapshot.gameState, GAME_STATE_BITS);
+    writeIntDelta(writer, static_cast<int32_t>(snapshot.matchTicks), static_cast<int32_t>(base.matchTicks), MATCH_TICKS_BITS);
+    writer.writeBits(snapshot.fighterCount, FIGHTER_COUNT_BITS);
+    
+    for (int i = 0; i < snapshot.fighterCount; i++) {
+        const NetFighterState& fighter = snapshot.fighters[i];
+        const NetFighterState& previous = base.fighters[i];
+        
+        if (!full) {
+            bool changed = fighter != previous;
+            writer.writeBool(changed);
+            if (!changed) {
+                continue;
+            }
+        }
+        
+        // One bit per field group, then only the groups that differ
+        bool positionChanged = full || fighter.positionX != previous.positionX || fighter.positionY != previous.positionY;
+        bool velocityChanged = full || fighter.velocityX != previous.velocityX || fighter.velocityY != previous.velocityY;
+        bool stateChanged = full || fighter.state != previous.state || fighter.flags != previous.flags;
+        bool damageChanged = full || fighter.damage != previous.damage;
+        bool livesChanged = full || fighter.lives != previous.lives;
+        
+        if (!full) {
+            writer.writeBool(positionChanged);
+            writer.writeBool(velocityChanged);
+            writer.writeBool(stateChanged);
+            writer.writeBool(damageChanged);
+            writer.writeBool(livesChanged);
+        }
+        
+        if (positionChanged) {
+            writeIntDelta(writer, fighter.positionX, previous.positionX, POSITION_BITS);
+            writeIntDelta(writer, fighter.positionY, previous.positionY, POSITION_BITS);
+        }
+        if (velocityChanged) {
+            writeIntDelta(writer, fighter.velocityX, previous.velocityX, VELOCITY_BITS);
+            writeIntDelta(writer, fighter.velocityY, previous.velocityY, VELOCITY_BITS);
+        }
+        if (stateChanged) {
+            writer.writeBits(fighter.state, STATE_BITS);
+            writer.writeBits(fighter.flags, FLAG_BITS);
+        }
+        if (damageChanged) {
+            writer.writeBits(fighter.damage, DAMAGE_BITS);
+        }
+        if (livesChanged) {
+            writer.writeBits(fighter.lives, LIVES_BITS);
+        }
+    }
+}
+
+bool NetSnapshot::read(BitReader& reader, NetSnapshot& snapshot, const NetSnapshot* baseline) {
+    static const NetSnapshot empty;
+    const NetSnapshot& base = baseline ? *baseline : empty;
+    bool full = baseline == nullptr;
+    
+    snapshot.tick = reader.readBits(32);
+    snapshot.gameState = static_cast<uint8_t>(reader.readBits(GAME_STATE_BITS));
+    snapshot.matchTicks = static_cast<uint32_t>(readIntDelta(reader, static_cast<int32_t>(base.matchTicks), MATCH_TICKS_BITS));
+    snapshot.fighterCount = static_cast<int>(reader.readBits(FIGHTER_COUNT_BITS));
+    if (snapshot.fighterCount > MAX_FIGHTERS) {
+        return false;
+    }
+    
+    for (int i = 0; i < snapshot.fighterCount; i++) {
+        NetFighterState& fighter = snapshot.fighters[i];
+        const NetFighterState& previous = base.fighters[i];
+        fighter = previous;
+        
+        if (!full && !reader.readBool()) {
+            continue;
+        }
+        
+        bool positionChanged = full || reader.readBool();
+        bool velocityChanged = full || reader.readBool();
+        bool stateChanged = full || reader.readBool();
+        bool damageChanged = full || reader.readBool();
+        bool livesChanged = full || reader.readBool();
+        
+        if (positionChanged) {
+            fighter.positionX = readIntDelta(reader, previous.positionX, POSITION_BITS);
+            fighter.positionY = readIntDelta(reader, previous.positionY, POSITION_BITS);
+        }
+        if (velocityChanged) {
+            fighter.velocityX = readIntDelta(reader, previous.velocityX, VELOCITY_BITS);
+            fighter.velocityY = readIntDelta(reader, previous.velocityY, VELOCITY_BITS);
+        }
+        if (stateChanged) {
+            fighter.state = static_cast<uint8_t>(reader.readBits(STATE_BITS));
+            fighter.flags = static_cast<uint8_t>(reader.readBits(FLAG_BITS));
+        }
+        if (damageChanged) {
+            fighter.damage = static_cast<uint16_t>(reader.readBits(DAMAGE_BITS));
+        }
+        if (livesChanged) {
+            fighter.lives = static_cast<uint8_t>(reader.readBits(LIVES_BITS));
+        }
+    }
+    
+    for (int i = snapshot.fighterCount; i < MAX_FIGHTERS; i++) {
+        snapshot.fighters[i] = NetFighterState();
+    }
+    
+    return !reader.hasOverflowed();
+}
@@ -0,0 +1,52 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "bit_stream.h"
+
+class GameManager;
+
+// One fighter as sent over the network. Values are fixed-point so a delta between two
+// snapshots reconstructs exactly on the other side.
+struct NetFighterState {
+    int32_t positionX = 0;   // 1/POSITION_SCALE units
+    int32_t positionY = 0;
+    int32_t velocityX = 0;   // 1/VELOCITY_SCALE units per second
+    int32_t velocityY = 0;
+    uint8_t state = 0;       // CharacterState
+    uint8_t flags = 0;       // FighterFlags
+    uint16_t damage = 0;     // Tenths of a percent
+    uint8_t lives = 0;
+    
+    bool operator==(const NetFighterState& other) const;
+    bool operator!=(const NetFighterState& other) const { return !(*this == other); }
+};
+
+// Quantized match state for one server tick
+struct NetSnapshot {
+    static const int MAX_FIGHTERS = 8;
+    static constexpr float POSITION_SCALE = 256.0f;
+    static constexpr float VELOCITY_SCALE = 64.0f;
+    
+    uint32_t tick = 0xFFFFFFFFu;
+    uint8_t gameState = 0;
+    uint32_t matchTicks = 0;     // Match timer in simulation ticks
+    int fighterCount = 0;
+    NetFighterState fighters[MAX_FIGHTERS];
+    
+    void capture(const GameManager& game, uint32_t serverTick);
+    
+    glm::vec2 getPosition(int fighter) const;
+    glm::vec2 getVelocity(int fighter) const;
+    float getDamage(int fighter) const { return fighters[fighter].damage / 10.0f; }
+    
+    bool operator==(const NetSnapshot& other) const;
+    
+    // With a baseline only changed fields are written, mostly as small deltas; without
+    // one every field is sent in full
+    static void write(BitWriter& writer, const NetSnapshot& snapshot, const NetSnapshot* baseline);
+    static bool read(BitReader& reader, NetSnapshot& snapshot, const NetSnapshot* baseline);
+};
+
+#endif
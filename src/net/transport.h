@@ -0,0 +1,33 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+// IPv4 address and port, both in host byte order
+struct NetAddress {
+    uint32_t ip = 0;
+    uint16_t port = 0;
+    
+    static NetAddress loopback(uint16_t port) { return NetAddress{0x7F000001u, port}; }
+    static bool parse(const std::string& host, uint16_t port, NetAddress& out);
+    
+    std::string toString() const;
+    
+    bool operator==(const NetAddress& other) const { return ip == other.ip && port == other.port; }
+    bool operator!=(const NetAddress& other) const { return !(*this == other); }
+};
+
+// Datagram endpoint the match code talks through: a real socket, or a shim in front of one
+class Transport {
+public:
+    virtual ~Transport() {}
+    
+    virtual bool send(const NetAddress& to, const uint8_t* data, size_t size) = 0;
+    
+    // Returns the datagram size, or -1 when nothing is waiting
+    virtual int receive(NetAddress& from, uint8_t* buffer, size_t capacity) = 0;
+};
+
+#endif
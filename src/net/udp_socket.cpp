@@ -0,0 +1,110 @@
+#include "udp_socket.h"
+#include <iostream>
+#include <cerrno>
+#include <cstring>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+bool NetAddress::parse(const std::string& host, uint16_t port, NetAddress& out) {
+    in_addr address;
+    if (inet_pton(AF_INET, host.c_str(), &address) != 1) {
+        return false;
+    }
+    
+    out.ip = ntohl(address.s_addr);
+    out.port = port;
+    return true;
+}
+
+std::string NetAddress::toString() const {
+    return std::to_string((ip >> 24) & 0xFF) + "." + std::to_string((ip >> 16) & 0xFF) + "." +
+           std::to_string((ip >> 8) & 0xFF) + "." + std::to_string(ip & 0xFF) + ":" + std::to_string(port);
+}
+
+UdpSocket::UdpSocket()
+    : m_handle(-1)
+    , m_port(0)
+{
+}
+
+UdpSocket::~UdpSocket() {
+    close();
+}
+
+bool UdpSocket::open(uint16_t port, bool loopbackOnly) {
+    close();
+    
+    m_handle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (m_handle < 0) {
+        std::cerr << "Failed to create UDP socket: " << strerror(errno) << std::endl;
+        return false;
+    }
+    
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(loopbackOnly ? INADDR_LOOPBACK : INADDR_ANY);
+    address.sin_port = htons(port);
+    
+    if (bind(m_handle, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        std::cerr << "Failed to bind UDP port " << port << ": " << strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+    
+    int flags = fcntl(m_handle, F_GETFL, 0);
+    if (flags < 0 || fcntl(m_handle, F_SETFL, flags | O_NONBLOCK) < 0) {
+        std::cerr << "Failed to make UDP socket non-blocking: " << strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+    
+    socklen_t length = sizeof(address);
+    getsockname(m_handle, reinterpret_cast<sockaddr*>(&address), &length);
+    m_port = ntohs(address.sin_port);
+    return true;
+}
+
+void UdpSocket::close() {
+    if (m_handle >= 0) {
+        ::close(m_handle);
+        m_handle = -1;
+    }
+    m_port = 0;
+}
+
+bool UdpSocket::send(const NetAddress& to, const uint8_t* data, size_t size) {
+    if (m_handle < 0) {
+        return false;
+    }
+    
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(to.ip);
+    address.sin_port = htons(to.port);
+    
+    ssize_t sent = sendto(m_handle, data, size, 0, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    return sent == static_cast<ssize_t>(size);
+}
+
+int UdpSocket::receive(NetAddress& from, uint8_t* buffer, size_t capacity) {
+    if (m_handle < 0) {
+        return -1;
+    }
+    
+    sockaddr_in address;
+    socklen_t length = sizeof(address);
+    ssize_t received = recvfrom(m_handle, buffer, capacity, 0, reinterpret_cast<sockaddr*>(&address), &length);
+    if (received < 0) {
+        // EAGAIN/EWOULDBLOCK just means the queue is empty
+        return -1;
+    }
+    
+    from.ip = ntohl(address.sin_addr.s_addr);
+    from.port = ntohs(address.sin_port);
+    return static_cast<int>(received);
+}
@@ -0,0 +1,32 @@
+#ifndef UDP_SOCKET_H
+#define UDP_SOCKET_H
+
+#include <cstdint>
+#include <cstddef>
+#include "transport.h"
+
+// Non-blocking POSIX UDP socket
+class UdpSocket : public Transport {
+public:
+    UdpSocket();
+    ~UdpSocket();
+    
+    // Port 0 picks any free port; the bound port is available from getPort()
+    bool open(uint16_t port, bool loopbackOnly = false);
+    void close();
+    
+    bool send(const NetAddress& to, const uint8_t* data, size_t size) override;
+    int receive(NetAddress& from, uint8_t* buffer, size_t capacity) override;
+    
+    bool isOpen() const { return m_handle >= 0; }
+    uint16_t getPort() const { return m_port; }
+    
+private:
+    int m_handle;
+    uint16_t m_port;
+    
+    UdpSocket(const UdpSocket&) = delete;
+    UdpSocket& operator=(const UdpSocket&) = delete;
+};
+
+#endif
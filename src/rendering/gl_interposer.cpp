@@ -0,0 +1,360 @@
+#include "gl_interposer.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <type_traits>
+#include <unordered_map>
+
+bool GlInterposer::m_installed = false;
+GlFrameCounters GlInterposer::m_frame = {};
+GlFrameCounters GlInterposer::m_lastFrame = {};
+GlInterposer::CaptureState GlInterposer::m_captureState = GlInterposer::CAPTURE_IDLE;
+std::string GlInterposer::m_capturePath;
+std::string GlInterposer::m_captureLog;
+
+static const char* const CALL_NAMES[GL_CALL_COUNT] = {
+#define GL_INTERPOSER_NAME(name) "gl" #name,
+    GL_INTERPOSED_CALLS(GL_INTERPOSER_NAME)
+#undef GL_INTERPOSER_NAME
+};
+
+// Last value the wrapped calls set for each piece of state we check for redundancy
+static const GLuint UNKNOWN = 0xFFFFFFFF;
+static const int MAX_TEXTURE_UNITS = 32;
+
+struct ShadowState {
+    GLuint program;
+    GLuint vertexArray;
+    GLuint arrayBuffer;
+    GLuint elementBuffer;     // Part of the bound vertex array's state
+    GLuint activeTexture;     // Unit index, not the GL_TEXTUREi enum
+    GLuint textures[MAX_TEXTURE_UNITS];   // GL_TEXTURE_2D binding per unit
+    GLenum blendSource;
+    GLenum blendDestination;
+    GLenum depthFunc;
+    GLuint depthMask;
+    GLenum cullFace;
+    bool clearColorKnown;
+    GLfloat clearColor[4];
+    bool viewportKnown;
+    GLint viewport[4];
+    std::unordered_map<GLenum, bool> capabilities;
+    
+    void reset() {
+        program = vertexArray = arrayBuffer = elementBuffer = activeTexture = UNKNOWN;
+        for (GLuint& texture : textures) {
+            texture = UNKNOWN;
+        }
+        blendSource = blendDestination = depthFunc = depthMask = cullFace = UNKNOWN;
+        clearColorKnown = false;
+        viewportKnown = false;
+        capabilities.clear();
+    }
+};
+
+static ShadowState s_shadow;
+
+static void recordStateChange(GlFrameCounters& frame, bool redundant) {
+    frame.stateChanges++;
+    if (redundant) {
+        frame.redundantStateChanges++;
+    }
+}
+
+// Sets `shadow` to `value`, reporting whether it already held it
+static bool updateShadow(GLuint& shadow, GLuint value) {
+    bool redundant = shadow == value;
+    shadow = value;
+    return redundant;
+}
+
+// Bytes per pixel of client pixel data; packed and compressed formats are approximated
+static uint64_t bytesPerPixel(GLenum format, GLenum type) {
+    int components = 4;
+    switch (format) {
+        case GL_RED: case GL_DEPTH_COMPONENT: case GL_STENCIL_INDEX: components = 1; break;
+        case GL_RG: case GL_DEPTH_STENCIL: components = 2; break;
+        case GL_RGB: case GL_BGR: components = 3; break;
+    }
+    switch (type) {
+        case GL_UNSIGNED_BYTE: case GL_BYTE: return components;
+        case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT: return components * 2;
+        case GL_UNSIGNED_INT: case GL_INT: case GL_FLOAT: return components * 4;
+        case GL_UNSIGNED_SHORT_5_6_5: case GL_UNSIGNED_SHORT_4_4_4_4: case GL_UNSIGNED_SHORT_5_5_5_1: return 2;
+        default: return 4;
+    }
+}
+
+// Per-entry-point bookkeeping beyond the call count. The template catches every call
+// without any; the overloads below are exact matches for the ones that have some.
+template <int Call>
+using CallTag = std::integral_constant<int, Call>;
+
+template <int Call, typename... Args>
+static void inspect(GlFrameCounters&, CallTag<Call>, Args...) {}
+
+static void inspect(GlFrameCounters& frame, CallTag<GL_CALL_UseProgram>, GLuint program) {
+    recordStateChange(frame, updateShadow(s_shadow.program, program));
+}
+
+static void inspect(GlFrameCounters& frame, CallTag<GL_CALL_BindVertexArray>, GLuint array) {
+    bool redundant = updateShadow(s_shadow.vertexArray, array);
+    if (!redundant) {
+        s_shadow.elementBuffer = UNKNOWN;
+    }
+    recordStateChange(frame, redundant);
+}
+
+static void inspect(GlFrameCounters& frame, CallTag<GL_CALL_BindBuffer>, GLenum target, GLuint buffer) {
+    bool redundant = false;
+    if (target == GL_ARRAY_BUFFER) {
+        redundant = updateShadow(s_shadow.arrayBuffer, buffer);
+    } else if (target == GL_ELEMENT_ARRAY_BUFFER) {
+        redundant = updateShadow(s_shadow.elementBuffer, buffer);
+    }
+    recordStateChange(frame, redundant);
+}
+
+static void inspect(GlFrameCounters& frame, CallTag<GL_CALL_ActiveTexture>, GLenum texture) {
+    recordStateChange(frame, updateShadow(s_shadow.activeTexture, texture - GL_TEXTURE0));
+}
+
+static void inspect(GlFrameCounters& frame, CallTag<GL_CALL_BindTexture>, GLenum target, GLuint texture) {
+    bool redundant = false;
+    GLuint unit = s_shadow.activeTexture == UNKNOWN ? 0 : s_shadow.activeTexture;
+    if (target == GL_TEXTURE_2D && unit < MAX_TEXTURE_UNITS) {
+        redundant = updateShadow(s_shadow.textures[unit], texture);
+    }
+    recordStateChange(frame, redundant);
+}
+
+static void setCapability(GlFrameCounters& frame, GLenum capability, bool enabled) {
+    auto found = s_shadow.capabilities.find(capability);
+    recordStateChange(frame, found != s_shadow.capabilities.end() && found->second == enabled);
+    s_shadow.capabilities[capability] = enabled;
+}
+
+static void inspect(GlFrameCounters& frame, CallTag<GL_CALL_Enable>, GLenum capability) {
+    setCapability(frame, capability, true);
+}
+
+static void inspect(GlFrameCounters& frame, CallTag<GL_CALL_Disable>, GLenum capability) {
+    setCapability(frame, capability, false);
+}
+
+static void inspect(GlFrameCounters& frame, CallTag<GL_CALL_BlendFunc>, GLenum source, GLenum destination) {
+    bool redundant = s_shadow.blendSource == source && s_shadow.blendDestination == destination;
+    s_shadow.blendSource = source;
+    s_shadow.blendDestination = destination;
+    recordStateChange(frame, redundant);
+}
+
+static void inspect(GlFrameCounters& frame, CallTag<GL_CALL_DepthFunc>, GLenum func) {
+    recordStateChange(frame, updateShadow(s_shadow.depthFunc, func));
+}
+
+static void inspect(GlFrameCounters& frame, CallTag<GL_CALL_DepthMask>, GLboolean flag) {
+    recordStateChange(frame, updateShadow(s_shadow.depthMask, flag));
+}
+
+static void inspect(GlFrameCounters& frame, CallTag<GL_CALL_CullFace>, GLenum mode) {
+    recordStateChange(frame, updateShadow(s_shadow.cullFace, mode));
+}
+
+static void inspect(GlFrameCounters& frame, CallTag<GL_CALL_ClearColor>, GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
+    GLfloat color[4] = {red, green, blue, alpha};
+    bool redundant = s_shadow.clearColorKnown && std::memcmp(color, s_shadow.clearColor, sizeof(color)) == 0;
+    std::memcpy(s_shadow.clearColor, color, sizeof(color));
+    s_shadow.clearColorKnown = true;
+    recordStateChange(frame, redundant);
+}
+
+static void inspect(GlFrameCounters& frame, CallTag<GL_CALL_Viewport>, GLint x, GLint y, GLsizei width, GLsizei height) {
+    GLint viewport[4] = {x, y, width, height};
+    bool redundant = s_shadow.viewportKnown && std::memcmp(viewport, s_shadow.viewport, sizeof(viewport)) == 0;
+    std::memcpy(s_shadow.viewport, viewport, sizeof(viewport));
+    s_shadow.viewportKnown = true;
+    recordStateChange(frame, redundant);
+}
+
+// Deleting a bound object unbinds it
+static void forgetDeleted(GLuint& shadow, GLsizei count, const GLuint* names) {
+    for (GLsizei i = 0; i < count; i++) {
+        if (shadow == names[i]) {
+            shadow = 0;
+        }
+    }
+}
+
+static void inspect(GlFrameCounters&, CallTag<GL_CALL_DeleteBuffers>, GLsizei count, const GLuint* buffers) {
+    forgetDeleted(s_shadow.arrayBuffer, count, buffers);
+    forgetDeleted(s_shadow.elementBuffer, count, buffers);
+}
+
+static void inspect(GlFrameCounters&, CallTag<GL_CALL_DeleteTextures>, GLsizei count, const GLuint* textures) {
+    for (GLuint& texture : s_shadow.textures) {
+        forgetDeleted(texture, count, textures);
+    }
+}
+
+static void inspect(GlFrameCounters&, CallTag<GL_CALL_DeleteVertexArrays>, GLsizei count, const GLuint* arrays) {
+    forgetDeleted(s_shadow.vertexArray, count, arrays);
+}
+
+static void inspect(GlFrameCounters&, CallTag<GL_CALL_DeleteProgram>, GLuint program) {
+    if (s_shadow.program == program) {
+        s_shadow.program = UNKNOWN;   // Stays in use until another program is bound
+    }
+}
+
+static void countDraw(GlFrameCounters& frame) {
+    frame.drawCalls++;
+}
+
+static void inspect(GlFrameCounters& frame, CallTag<GL_CALL_DrawArrays>, GLenum, GLint, GLsizei) { countDraw(frame); }
+static void inspect(GlFrameCounters& frame, CallTag<GL_CALL_DrawArraysInstanced>, GLenum, GLint, GLsizei, GLsizei) { countDraw(frame); }
+static void inspect(GlFrameCounters& frame, CallTag<GL_CALL_DrawElements>, GLenum, GLsizei, GLenum, const void*) { countDraw(frame); }
+static void inspect(GlFrameCounters& frame, CallTag<GL_CALL_DrawElementsInstanced>, GLenum, GLsizei, GLenum, const void*, GLsizei) { countDraw(frame); }
+
+static void inspect(GlFrameCounters& frame, CallTag<GL_CALL_BufferData>, GLenum, GLsizeiptr size, const void* data, GLenum) {
+    frame.bufferUploads++;
+    if (data) {
+        frame.bytesUploaded += static_cast<uint64_t>(size);
+    }
+}
+
+static void inspect(GlFrameCounters& frame, CallTag<GL_CALL_BufferSubData>, GLenum, GLintptr, GLsizeiptr size, const void*) {
+    frame.bufferUploads++;
+    frame.bytesUploaded += static_cast<uint64_t>(size);
+}
+
+static void inspect(GlFrameCounters& frame, CallTag<GL_CALL_TexImage2D>, GLenum, GLint, GLint, GLsizei width, GLsizei height, GLint, GLenum format, GLenum type, const void* pixels) {
+    frame.textureUploads++;
+    if (pixels) {
+        frame.bytesUploaded += static_cast<uint64_t>(width) * height * bytesPerPixel(format, type);
+    }
+}
+
+static void inspect(GlFrameCounters& frame, CallTag<GL_CALL_TexSubImage2D>, GLenum, GLint, GLint, GLint, GLsizei width, GLsizei height, GLenum format, GLenum type, const void*) {
+    frame.textureUploads++;
+    frame.bytesUploaded += static_cast<uint64_t>(width) * height * bytesPerPixel(format, type);
+}
+
+// Arguments for the call log: strings as text, pointers as addresses, enums as numbers
+template <typename T>
+static void formatArg(std::ostringstream& stream, T value) {
+    stream << value;
+}
+
+static void formatArg(std::ostringstream& stream, const GLchar* value) {
+    stream << '"' << (value ? value : "") << '"';
+}
+
+static void formatArg(std::ostringstream& stream, GLboolean value) {
+    stream << (value ? "GL_TRUE" : "GL_FALSE");
+}
+
+template <typename... Args>
+static void logCall(int call, Args... args) {
+    std::ostringstream stream;
+    stream << GlInterposer::getCallName(call) << "(";
+    int index = 0;
+    (void)index;
+    ((stream << (index++ ? ", " : ""), formatArg(stream, args)), ...);
+    stream << ")";
+    GlInterposer::logCall(stream.str());
+}
+
+template <int Call, typename Function>
+struct GlHook;
+
+template <int Call, typename Ret, typename... Args>
+struct GlHook<Call, Ret (APIENTRYP)(Args...)> {
+    typedef Ret (APIENTRYP Function)(Args...);
+    static inline Function original = nullptr;
+    
+    static Ret APIENTRY wrapper(Args... args) {
+        inspect(GlInterposer::recordCall(Call), CallTag<Call>(), args...);
+        if (GlInterposer::isCapturing()) {
+            logCall(Call, args...);
+        }
+        return original(args...);
+    }
+};
+
+template <int Call, typename Function>
+static void hook(Function& slot) {
+    // Entry points the driver doesn't provide stay null
+    if (slot && slot != &GlHook<Call, Function>::wrapper) {
+        GlHook<Call, Function>::original = slot;
+        slot = &GlHook<Call, Function>::wrapper;
+    }
+}
+
+template <int Call, typename Function>
+static void unhook(Function& slot) {
+    if (slot == &GlHook<Call, Function>::wrapper) {
+        slot = GlHook<Call, Function>::original;
+    }
+}
+
+void GlInterposer::install() {
+#define GL_INTERPOSER_HOOK(name) hook<GL_CALL_##name>(glad_gl##name);
+    GL_INTERPOSED_CALLS(GL_INTERPOSER_HOOK)
+#undef GL_INTERPOSER_HOOK
+    
+    s_shadow.reset();
+    m_frame = {};
+    m_lastFrame = {};
+    m_installed = true;
+}
+
+void GlInterposer::uninstall() {
+#define GL_INTERPOSER_UNHOOK(name) unhook<GL_CALL_##name>(glad_gl##name);
+    GL_INTERPOSED_CALLS(GL_INTERPOSER_UNHOOK)
+#undef GL_INTERPOSER_UNHOOK
+    
+    m_installed = false;
+}
+
+const char* GlInterposer::getCallName(int call) {
+    return call >= 0 && call < GL_CALL_COUNT ? CALL_NAMES[call] : "unknown";
+}
+
+GlFrameCounters& GlInterposer::recordCall(int call) {
+    m_frame.calls++;
+    m_frame.callsByEntry[call]++;
+    return m_frame;
+}
+
+void GlInterposer::logCall(const std::string& line) {
+    m_captureLog += line;
+    m_captureLog += '\n';
+}
+
+void GlInterposer::captureNextFrame(const std::string& path) {
+    m_capturePath = path;
+    m_captureLog.clear();
+    m_captureState = CAPTURE_PENDING;
+}
+
+void GlInterposer::endFrame() {
+    m_lastFrame = m_frame;
+    m_frame = {};
+    
+    if (m_captureState == CAPTURE_RUNNING) {
+        std::ofstream out(m_capturePath);
+        if (out) {
+            out << m_captureLog;
+            std::cout << "Captured " << m_lastFrame.calls << " GL calls to " << m_capturePath << std::endl;
+        } else {
+            std::cerr << "Failed to write GL capture to " << m_capturePath << std::endl;
+        }
+        m_captureLog.clear();
+        m_captureState = CAPTURE_IDLE;
+    } else if (m_captureState == CAPTURE_PENDING) {
+        // Start on a frame boundary so the log holds exactly one frame
+        m_captureState = CAPTURE_RUNNING;
+    }
+}
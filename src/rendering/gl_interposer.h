@@ -0,0 +1,78 @@
+#ifndef GL_INTERPOSER_H
+#define GL_INTERPOSER_H
+
+#include <glad/glad.h>
+#include <string>
+#include <cstdint>
+
+// GL entry points the interposer wraps. Everything the renderer calls is here, plus the
+// usual draw, upload and state calls it's likely to start using.
+#define GL_INTERPOSED_CALLS(X) \
+    X(ActiveTexture) X(AttachShader) X(BindBuffer) X(BindTexture) X(BindVertexArray) \
+    X(BlendFunc) X(BufferData) X(BufferSubData) X(Clear) X(ClearColor) X(CompileShader) \
+    X(CreateProgram) X(CreateShader) X(CullFace) X(DeleteBuffers) X(DeleteProgram) \
+    X(DeleteShader) X(DeleteTextures) X(DeleteVertexArrays) X(DepthFunc) X(DepthMask) \
+    X(Disable) X(DisableVertexAttribArray) X(DrawArrays) X(DrawArraysInstanced) \
+    X(DrawElements) X(DrawElementsInstanced) X(Enable) X(EnableVertexAttribArray) \
+    X(GenBuffers) X(GenTextures) X(GenVertexArrays) X(GenerateMipmap) \
+    X(GetUniformLocation) X(LinkProgram) X(ShaderSource) X(TexImage2D) X(TexParameteri) \
+    X(TexSubImage2D) X(Uniform1f) X(Uniform1i) X(Uniform3fv) X(Uniform4fv) \
+    X(UniformMatrix4fv) X(UseProgram) X(VertexAttribPointer) X(Viewport)
+
+enum GlCall {
+#define GL_INTERPOSER_ENUM(name) GL_CALL_##name,
+    GL_INTERPOSED_CALLS(GL_INTERPOSER_ENUM)
+#undef GL_INTERPOSER_ENUM
+    GL_CALL_COUNT
+};
+
+struct GlFrameCounters {
+    uint64_t calls;
+    uint64_t drawCalls;
+    uint64_t stateChanges;           // Binds, enables, blend/depth/clear state
+    uint64_t redundantStateChanges;  // State set to what it already was
+    uint64_t bufferUploads;
+    uint64_t textureUploads;
+    uint64_t bytesUploaded;          // Buffer data plus texture pixels
+    uint64_t callsByEntry[GL_CALL_COUNT];
+};
+
+// Debug layer over GLAD's dispatch. install() swaps the glad_gl* function pointers for
+// wrappers that count every call per frame and forward to the driver; uninstall() puts
+// the originals back. Redundant state changes are found against a shadow copy of the
+// state the wrapped calls set, so state changed some other way (e.g. a call that isn't
+// wrapped) can hide or invent a redundancy. Render thread only.
+class GlInterposer {
+public:
+    // Call after gladLoadGLLoader
+    static void install();
+    static void uninstall();
+    static bool isInstalled() { return m_installed; }
+    
+    // Call once per frame, after the swap. Finishes the frame's counters and, if a
+    // capture was requested, writes that frame's call log.
+    static void endFrame();
+    
+    // Logs every wrapped call of the next full frame, with arguments, to `path`
+    static void captureNextFrame(const std::string& path);
+    
+    static const GlFrameCounters& getLastFrame() { return m_lastFrame; }
+    static const char* getCallName(int call);
+    
+    // Called by the wrappers; returns the frame's counters for per-call bookkeeping
+    static GlFrameCounters& recordCall(int call);
+    static bool isCapturing() { return m_captureState == CAPTURE_RUNNING; }
+    static void logCall(const std::string& line);
+    
+private:
+    enum CaptureState { CAPTURE_IDLE, CAPTURE_PENDING, CAPTURE_RUNNING };
+    
+    static bool m_installed;
+    static GlFrameCounters m_frame;
+    static GlFrameCounters m_lastFrame;
+    static CaptureState m_captureState;
+    static std::string m_capturePath;
+    static std::string m_captureLog;
+};
+
+#endif
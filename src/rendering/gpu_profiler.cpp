@@ -0,0 +1,79 @@
+#include "gpu_profiler.h"
+
+GpuProfiler::GpuProfiler()
+    : m_currentFrame(0), m_passOpen(false), m_droppedResults(0) {
+}
+
+GpuProfiler::~GpuProfiler() {
+    for (std::vector<PassQuery>& passes : m_frames) {
+        for (const PassQuery& pass : passes) {
+            glDeleteQueries(1, &pass.query);
+        }
+    }
+    if (!m_freeQueries.empty()) {
+        glDeleteQueries(static_cast<GLsizei>(m_freeQueries.size()), m_freeQueries.data());
+    }
+}
+
+void GpuProfiler::beginFrame() {
+    if (m_passOpen) {
+        endPass();
+    }
+    
+    // The slot being reused holds the frame issued FRAME_DELAY frames ago
+    m_currentFrame = (m_currentFrame + 1) % (FRAME_DELAY + 1);
+    resolve(m_frames[m_currentFrame]);
+}
+
+void GpuProfiler::beginPass(const char* name) {
+    if (m_passOpen) {
+        return;
+    }
+    
+    GLuint query;
+    if (m_freeQueries.empty()) {
+        glGenQueries(1, &query);
+    } else {
+        query = m_freeQueries.back();
+        m_freeQueries.pop_back();
+    }
+    
+    glBeginQuery(GL_TIME_ELAPSED, query);
+    m_frames[m_currentFrame].push_back({name, query, Profiler::getTimeMicroseconds()});
+    m_passOpen = true;
+}
+
+void GpuProfiler::endPass() {
+    if (!m_passOpen) {
+        return;
+    }
+    glEndQuery(GL_TIME_ELAPSED);
+    m_passOpen = false;
+}
+
+void GpuProfiler::resolve(std::vector<PassQuery>& passes) {
+    if (passes.empty()) {
+        return;
+    }
+    
+    m_lastResults.clear();
+    for (const PassQuery& pass : passes) {
+        GLint available = 0;
+        glGetQueryObjectiv(pass.query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            GLuint64 nanoseconds = 0;
+            glGetQueryObjectui64v(pass.query, GL_QUERY_RESULT, &nanoseconds);
+            m_lastResults.push_back({pass.name, nanoseconds / 1000000.0});
+            
+            if (Profiler::isCapturing()) {
+                Profiler::record(pass.name, "gpu", pass.cpuStartMicroseconds, nanoseconds / 1000, Profiler::GPU_TRACK);
+            }
+        } else {
+            m_droppedResults++;
+        }
+        
+        // Reissuing a query discards any result it still had pending
+        m_freeQueries.push_back(pass.query);
+    }
+    passes.clear();
+}
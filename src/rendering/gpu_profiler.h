@@ -0,0 +1,79 @@
+#ifndef GPU_PROFILER_H
+#define GPU_PROFILER_H
+
+#include <glad/glad.h>
+#include <vector>
+#include <cstdint>
+#include "../utils/profiler.h"
+
+struct GpuPassTime {
+    const char* name;
+    double milliseconds;
+};
+
+// GPU time per render pass from GL_TIME_ELAPSED queries. Queries come from a pool and
+// are read back FRAME_DELAY frames after they were issued, by which point the GPU has
+// normally finished them, so reading never stalls the pipeline; a result still not ready
+// then is dropped rather than waited for.
+//
+// While the Profiler is capturing, each result is added to the trace on its GPU track,
+// starting where the pass was submitted on the CPU. TIME_ELAPSED only measures duration,
+// so the GPU spans are placed at submission rather than at when the GPU ran them.
+class GpuProfiler {
+public:
+    GpuProfiler();
+    ~GpuProfiler();  // Needs the GL context that created it
+    
+    // Call at the start of every frame; resolves the frame FRAME_DELAY frames back
+    void beginFrame();
+    
+    // Passes can't nest: GL allows one TIME_ELAPSED query at a time
+    void beginPass(const char* name);
+    void endPass();
+    
+    // Passes of the most recently resolved frame, in submission order
+    const std::vector<GpuPassTime>& getLastResults() const { return m_lastResults; }
+    uint64_t getDroppedResults() const { return m_droppedResults; }
+    
+private:
+    static constexpr int FRAME_DELAY = 3;
+    
+    struct PassQuery {
+        const char* name;
+        GLuint query;
+        uint64_t cpuStartMicroseconds;
+    };
+    
+    std::vector<PassQuery> m_frames[FRAME_DELAY + 1];
+    int m_currentFrame;
+    bool m_passOpen;
+    
+    std::vector<GLuint> m_freeQueries;
+    std::vector<GpuPassTime> m_lastResults;
+    uint64_t m_droppedResults;
+    
+    void resolve(std::vector<PassQuery>& passes);
+};
+
+// Times the enclosing scope as a render pass on both the CPU and, when a profiler is
+// given, the GPU
+class GpuZone {
+public:
+    GpuZone(GpuProfiler* profiler, const char* name)
+        : m_profiler(profiler), m_cpuZone(name, "render") {
+        if (m_profiler) m_profiler->beginPass(name);
+    }
+    
+    ~GpuZone() {
+        if (m_profiler) m_profiler->endPass();
+    }
+    
+private:
+    GpuProfiler* m_profiler;
+    ProfileZone m_cpuZone;
+    
+    GpuZone(const GpuZone&) = delete;
+    GpuZone& operator=(const GpuZone&) = delete;
+};
+
+#endif
@@ -0,0 +1,283 @@
+#include "perf_overlay.h"
+#include "../utils/profiler.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstddef>
+
+// 3x5 pixel glyphs for ASCII 32-95, rows top to bottom, three bits per row with the
+// leftmost pixel highest. Lowercase is drawn as uppercase; anything else is blank.
+static const uint16_t FONT_GLYPHS[64] = {
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x52A5, 0x0000, 0x0000,
+    0x1491, 0x4494, 0x0000, 0x05D0, 0x0000, 0x01C0, 0x0002, 0x12A4,
+    0x7B6F, 0x2C97, 0x73E7, 0x72CF, 0x5BC9, 0x79CF, 0x79EF, 0x7292,
+    0x7BEF, 0x7BCF, 0x0410, 0x0000, 0x0000, 0x0E38, 0x0000, 0x0000,
+    0x0000, 0x2BED, 0x6BAE, 0x3923, 0x6B6E, 0x79A7, 0x79A4, 0x396B,
+    0x5BED, 0x7497, 0x126A, 0x5BAD, 0x4927, 0x5FED, 0x6B6D, 0x2B6A,
+    0x6BA4, 0x2B73, 0x6BAD, 0x388E, 0x7492, 0x5B6F, 0x5B6A, 0x5BFD,
+    0x5AAD, 0x5A92, 0x72A7, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+};
+
+// Atlas layout: 16x4 cells of 4x6 texels, one glyph each, then a solid cell used for
+// the untextured quads
+static const int ATLAS_WIDTH = 64;
+static const int ATLAS_HEIGHT = 32;
+static const int CELL_WIDTH = 4;
+static const int CELL_HEIGHT = 6;
+static const int SOLID_CELL_Y = 24;
+
+// Screen pixels per font pixel, and the resulting text grid
+static const float FONT_SCALE = 2.0f;
+static const float CHAR_ADVANCE = CELL_WIDTH * FONT_SCALE;
+static const float LINE_HEIGHT = (CELL_HEIGHT + 1) * FONT_SCALE;
+
+// Panel layout, in screen pixels from the top-left corner
+static const float PANEL_X = 8.0f;
+static const float PANEL_Y = 8.0f;
+static const float PADDING = 8.0f;
+static const float PANEL_WIDTH = 50 * CHAR_ADVANCE + 2 * PADDING;
+static const float BAR_WIDTH = 3.0f;
+static const float GRAPH_HEIGHT = 80.0f;
+static const float GRAPH_MAX_MS = 40.0f;
+
+static constexpr uint32_t rgba(uint32_t r, uint32_t g, uint32_t b, uint32_t a) {
+    return r | (g << 8) | (b << 16) | (a << 24);
+}
+
+static const uint32_t COLOR_PANEL = rgba(0, 0, 0, 170);
+static const uint32_t COLOR_TEXT = rgba(230, 230, 230, 255);
+static const uint32_t COLOR_BUDGET_LINE = rgba(255, 255, 255, 80);
+static const uint32_t COLOR_UPDATE = rgba(80, 160, 255, 255);
+static const uint32_t COLOR_RENDER = rgba(255, 170, 60, 255);
+static const uint32_t COLOR_FRAME = rgba(90, 200, 90, 255);
+static const uint32_t COLOR_FRAME_SLOW = rgba(230, 210, 60, 255);
+static const uint32_t COLOR_FRAME_HITCH = rgba(230, 70, 60, 255);
+
+PerfOverlay::PerfOverlay()
+    : m_visible(false), m_initialized(false), m_shader(nullptr), m_vao(0), m_vbo(0), m_atlas(0),
+      m_history(), m_historyNext(0), m_historyCount(0), m_lastDrawMs(0.0f),
+      m_rateStartMicroseconds(0), m_rateStartHitboxes(0), m_rateStartCollisionPairs(0),
+      m_hitboxesPerSecond(0), m_collisionPairsPerSecond(0) {
+}
+
+PerfOverlay::~PerfOverlay() {
+    if (m_initialized) {
+        glDeleteVertexArrays(1, &m_vao);
+        glDeleteBuffers(1, &m_vbo);
+        glDeleteTextures(1, &m_atlas);
+    }
+    delete m_shader;
+}
+
+bool PerfOverlay::init() {
+    m_initialized = true;
+    m_shader = new Shader("assets/shaders/overlay.vert", "assets/shaders/overlay.frag");
+    m_shader->use();
+    m_shader->setInt("atlas", 0);
+    
+    // Font atlas, single channel coverage
+    std::vector<uint8_t> texels(ATLAS_WIDTH * ATLAS_HEIGHT, 0);
+    for (int glyph = 0; glyph < 64; glyph++) {
+        int cellX = (glyph % 16) * CELL_WIDTH;
+        int cellY = (glyph / 16) * CELL_HEIGHT;
+        for (int row = 0; row < 5; row++) {
+            for (int column = 0; column < 3; column++) {
+                if (FONT_GLYPHS[glyph] & (1 << (14 - row * 3 - column))) {
+                    texels[(cellY + row) * ATLAS_WIDTH + cellX + column] = 255;
+                }
+            }
+        }
+    }
+    for (int row = 0; row < CELL_HEIGHT; row++) {
+        for (int column = 0; column < CELL_WIDTH; column++) {
+            texels[(SOLID_CELL_Y + row) * ATLAS_WIDTH + column] = 255;
+        }
+    }
+    
+    glGenTextures(1, &m_atlas);
+    glBindTexture(GL_TEXTURE_2D, m_atlas);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, ATLAS_WIDTH, ATLAS_HEIGHT, 0, GL_RED, GL_UNSIGNED_BYTE, texels.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    
+    // Streamed every frame; sized once for the most the overlay can emit
+    glGenVertexArrays(1, &m_vao);
+    glGenBuffers(1, &m_vbo);
+    glBindVertexArray(m_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    glBufferData(GL_ARRAY_BUFFER, MAX_VERTICES * sizeof(OverlayVertex), nullptr, GL_STREAM_DRAW);
+    
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(OverlayVertex), (void*)offsetof(OverlayVertex, x));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(OverlayVertex), (void*)offsetof(OverlayVertex, u));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(OverlayVertex), (void*)offsetof(OverlayVertex, color));
+    glEnableVertexAttribArray(2);
+    
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+    
+    m_vertices.reserve(MAX_VERTICES);
+    return true;
+}
+
+void PerfOverlay::addQuad(float x, float y, float width, float height, uint32_t color) {
+    if (m_vertices.size() + 6 > MAX_VERTICES) {
+        return;
+    }
+    
+    // Every texel of the solid cell is opaque, so one UV serves all four corners
+    const float u = 1.5f / ATLAS_WIDTH;
+    const float v = (SOLID_CELL_Y + 1.5f) / ATLAS_HEIGHT;
+    OverlayVertex topLeft = {x, y, u, v, color};
+    OverlayVertex topRight = {x + width, y, u, v, color};
+    OverlayVertex bottomLeft = {x, y + height, u, v, color};
+    OverlayVertex bottomRight = {x + width, y + height, u, v, color};
+    
+    m_vertices.push_back(topLeft);
+    m_vertices.push_back(bottomLeft);
+    m_vertices.push_back(topRight);
+    m_vertices.push_back(topRight);
+    m_vertices.push_back(bottomLeft);
+    m_vertices.push_back(bottomRight);
+}
+
+float PerfOverlay::addText(float x, float y, const char* text, uint32_t color) {
+    for (const char* c = text; *c; c++, x += CHAR_ADVANCE) {
+        int code = (*c >= 'a' && *c <= 'z') ? *c - 32 : *c;
+        if (code <= ' ' || code > '_' || m_vertices.size() + 6 > MAX_VERTICES) {
+            continue;
+        }
+        
+        int glyph = code - ' ';
+        float u0 = static_cast<float>((glyph % 16) * CELL_WIDTH) / ATLAS_WIDTH;
+        float v0 = static_cast<float>((glyph / 16) * CELL_HEIGHT) / ATLAS_HEIGHT;
+        float u1 = u0 + 3.0f / ATLAS_WIDTH;
+        float v1 = v0 + 5.0f / ATLAS_HEIGHT;
+        float width = 3 * FONT_SCALE;
+        float height = 5 * FONT_SCALE;
+        
+        OverlayVertex topLeft = {x, y, u0, v0, color};
+        OverlayVertex topRight = {x + width, y, u1, v0, color};
+        OverlayVertex bottomLeft = {x, y + height, u0, v1, color};
+        OverlayVertex bottomRight = {x + width, y + height, u1, v1, color};
+        
+        m_vertices.push_back(topLeft);
+        m_vertices.push_back(bottomLeft);
+        m_vertices.push_back(topRight);
+        m_vertices.push_back(topRight);
+        m_vertices.push_back(bottomLeft);
+        m_vertices.push_back(bottomRight);
+    }
+    return x;
+}
+
+void PerfOverlay::draw(const PerfOverlaySample& sample, int width, int height) {
+    if (!m_initialized && !init()) {
+        return;
+    }
+    uint64_t start = Profiler::getTimeMicroseconds();
+    
+    m_history[m_historyNext] = {sample.updateMs, sample.renderMs, sample.frameMs};
+    m_historyNext = (m_historyNext + 1) % HISTORY;
+    m_historyCount = std::min(m_historyCount + 1, HISTORY);
+    
+    // Rates over about a second. A longer gap means the overlay was hidden, so the
+    // window starts over rather than averaging over the time it wasn't shown.
+    uint64_t rateMicroseconds = start - m_rateStartMicroseconds;
+    if (m_rateStartMicroseconds == 0 || rateMicroseconds >= 1000000) {
+        if (m_rateStartMicroseconds != 0 && rateMicroseconds < 2000000) {
+            m_hitboxesPerSecond = (sample.totalHitboxes - m_rateStartHitboxes) * 1000000 / rateMicroseconds;
+            m_collisionPairsPerSecond = (sample.totalCollisionPairs - m_rateStartCollisionPairs) * 1000000 / rateMicroseconds;
+        }
+        m_rateStartMicroseconds = start;
+        m_rateStartHitboxes = sample.totalHitboxes;
+        m_rateStartCollisionPairs = sample.totalCollisionPairs;
+    }
+    
+    int lines = sample.hasRollback ? 4 : 3;
+    float textHeight = lines * LINE_HEIGHT;
+    float panelHeight = PADDING + textHeight + GRAPH_HEIGHT + PADDING;
+    
+    m_vertices.clear();
+    addQuad(PANEL_X, PANEL_Y, PANEL_WIDTH, panelHeight, COLOR_PANEL);
+    
+    // Counters, formatted into a stack buffer so drawing allocates nothing
+    char text[96];
+    unsigned long long drawCalls = sample.drawCalls;
+    unsigned long long stateChanges = sample.stateChanges;
+    unsigned long long redundant = sample.redundantStateChanges;
+    unsigned long long allocations = sample.allocations;
+    float x = PANEL_X + PADDING;
+    float y = PANEL_Y + PADDING;
+    
+    snprintf(text, sizeof(text), "FRAME %.1f MS  CPU %.1f  ", sample.frameMs, sample.cpuMs);
+    x = addText(x, y, text, COLOR_TEXT);
+    snprintf(text, sizeof(text), "UPDATE %.2f  ", sample.updateMs);
+    x = addText(x, y, text, COLOR_UPDATE);
+    snprintf(text, sizeof(text), "RENDER %.2f", sample.renderMs);
+    addText(x, y, text, COLOR_RENDER);
+    
+    y += LINE_HEIGHT;
+    if (sample.hasGlCounters) {
+        snprintf(text, sizeof(text), "DRAWS %llu  STATE %llu (%llu REDUNDANT)  ALLOCS %llu", drawCalls, stateChanges, redundant, allocations);
+    } else {
+        snprintf(text, sizeof(text), "DRAWS -  STATE - (--GL-DEBUG)  ALLOCS %llu", allocations);
+    }
+    addText(PANEL_X + PADDING, y, text, COLOR_TEXT);
+    
+    y += LINE_HEIGHT;
+    snprintf(text, sizeof(text), "HITBOXES %llu/S  PAIRS %llu/S  OVERLAY %.3f MS", m_hitboxesPerSecond, m_collisionPairsPerSecond, m_lastDrawMs);
+    addText(PANEL_X + PADDING, y, text, COLOR_TEXT);
+    
+    if (sample.hasRollback) {
+        y += LINE_HEIGHT;
+        unsigned long long rollbacks = sample.rollbacks;
+        snprintf(text, sizeof(text), "ROLLBACK %d FRAMES  %llu ROLLBACKS", sample.rollbackFrames, rollbacks);
+        addText(PANEL_X + PADDING, y, text, COLOR_TEXT);
+    }
+    
+    // Frame graph, oldest bar on the left; each bar stacks update, render and the rest
+    // of the frame, the rest coloured by whether the frame hit 60 and 30 fps
+    float graphBottom = PANEL_Y + PADDING + textHeight + GRAPH_HEIGHT;
+    float pixelsPerMs = GRAPH_HEIGHT / GRAPH_MAX_MS;
+    for (int i = 0; i < m_historyCount; i++) {
+        const GraphEntry& entry = m_history[(m_historyNext - m_historyCount + i + HISTORY) % HISTORY];
+        float barX = PANEL_X + PADDING + i * BAR_WIDTH;
+        float updateHeight = std::min(entry.updateMs * pixelsPerMs, GRAPH_HEIGHT);
+        float renderHeight = std::min(entry.renderMs * pixelsPerMs, GRAPH_HEIGHT - updateHeight);
+        float restHeight = std::min(std::max(entry.frameMs - entry.updateMs - entry.renderMs, 0.0f) * pixelsPerMs,
+                                    GRAPH_HEIGHT - updateHeight - renderHeight);
+        
+        uint32_t frameColor = entry.frameMs > 33.4f ? COLOR_FRAME_HITCH : (entry.frameMs > 16.8f ? COLOR_FRAME_SLOW : COLOR_FRAME);
+        addQuad(barX, graphBottom - updateHeight, BAR_WIDTH - 1.0f, updateHeight, COLOR_UPDATE);
+        addQuad(barX, graphBottom - updateHeight - renderHeight, BAR_WIDTH - 1.0f, renderHeight, COLOR_RENDER);
+        addQuad(barX, graphBottom - updateHeight - renderHeight - restHeight, BAR_WIDTH - 1.0f, restHeight, frameColor);
+    }
+    
+    // 60 and 30 fps budgets
+    float graphWidth = HISTORY * BAR_WIDTH;
+    addQuad(PANEL_X + PADDING, graphBottom - 16.7f * pixelsPerMs, graphWidth, 1.0f, COLOR_BUDGET_LINE);
+    addQuad(PANEL_X + PADDING, graphBottom - 33.3f * pixelsPerMs, graphWidth, 1.0f, COLOR_BUDGET_LINE);
+    
+    // One upload into the orphaned buffer, one draw
+    m_shader->use();
+    m_shader->setMat4("projection", glm::ortho(0.0f, static_cast<float>(width), static_cast<float>(height), 0.0f, -1.0f, 1.0f));
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_atlas);
+    glBindVertexArray(m_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    glBufferData(GL_ARRAY_BUFFER, MAX_VERTICES * sizeof(OverlayVertex), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, m_vertices.size() * sizeof(OverlayVertex), m_vertices.data());
+    
+    glDisable(GL_DEPTH_TEST);
+    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(m_vertices.size()));
+    glEnable(GL_DEPTH_TEST);
+    
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+    
+    m_lastDrawMs = (Profiler::getTimeMicroseconds() - start) / 1000.0f;
+}
@@ -0,0 +1,90 @@
+#ifndef PERF_OVERLAY_H
+#define PERF_OVERLAY_H
+
+#include <glad/glad.h>
+#include <vector>
+#include <cstdint>
+#include "shader.h"
+
+// One frame's numbers for the overlay. Times in milliseconds.
+struct PerfOverlaySample {
+    float frameMs = 0.0f;        // Previous complete frame, start to start
+    float cpuMs = 0.0f;          // Previous frame, start until the swap was issued
+    float updateMs = 0.0f;
+    float renderMs = 0.0f;
+    
+    bool hasGlCounters = false;  // Only while the GL interposer is installed
+    uint64_t drawCalls = 0;
+    uint64_t stateChanges = 0;
+    uint64_t redundantStateChanges = 0;
+    uint64_t allocations = 0;
+    
+    uint64_t totalHitboxes = 0;        // Running totals; the overlay shows them per second
+    uint64_t totalCollisionPairs = 0;
+    
+    bool hasRollback = false;    // Only when a rollback session is driving the game
+    int rollbackFrames = 0;      // Frames resimulated by the latest rollback
+    uint64_t rollbacks = 0;
+};
+
+// Debug overlay in the top-left corner: a rolling graph of the last HISTORY frames, each
+// bar split into update, render and the rest of the frame, plus counters as text. The
+// whole overlay is one vertex buffer of coloured quads textured from a tiny built-in
+// font atlas, drawn with a single glDrawArrays, and it allocates nothing per frame.
+//
+// Hidden, it costs nothing: the caller skips draw(), and the graph only collects frames
+// while it's shown. GL resources are created the first time it's drawn.
+class PerfOverlay {
+public:
+    PerfOverlay();
+    ~PerfOverlay();  // Needs the GL context it drew with
+    
+    void toggle() { m_visible = !m_visible; }
+    bool isVisible() const { return m_visible; }
+    
+    // Adds the sample to the graph and draws; leaves depth testing enabled
+    void draw(const PerfOverlaySample& sample, int width, int height);
+    
+private:
+    static constexpr int HISTORY = 120;
+    static constexpr int MAX_VERTICES = 8192;
+    
+    struct OverlayVertex {
+        float x, y;
+        float u, v;
+        uint32_t color;  // RGBA8
+    };
+    
+    struct GraphEntry {
+        float updateMs;
+        float renderMs;
+        float frameMs;
+    };
+    
+    bool m_visible;
+    bool m_initialized;
+    Shader* m_shader;
+    GLuint m_vao;
+    GLuint m_vbo;
+    GLuint m_atlas;
+    
+    std::vector<OverlayVertex> m_vertices;
+    GraphEntry m_history[HISTORY];
+    int m_historyNext;
+    int m_historyCount;
+    float m_lastDrawMs;  // CPU cost of the previous draw, shown on the overlay
+    
+    // A hitbox lasts a single tick, so they're shown per second rather than per frame
+    uint64_t m_rateStartMicroseconds;
+    uint64_t m_rateStartHitboxes;
+    uint64_t m_rateStartCollisionPairs;
+    unsigned long long m_hitboxesPerSecond;
+    unsigned long long m_collisionPairsPerSecond;
+    
+    bool init();
+    void addQuad(float x, float y, float width, float height, uint32_t color);
+    // Returns the x just past the text
+    float addText(float x, float y, const char* text, uint32_t color);
+};
+
+#endif
@@ -0,0 +1,152 @@
+#include "server/lag_bench.h"
+#include "game/lag_compensation.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+// Targets stand in an 8x8 grid and all walk along +x, fast enough that ten ticks of
+// lag put them well outside their own capsule
+static const float GRID_SPACING = 4.0f;
+static const float SPEED_PER_TICK = 0.2f;
+static const uint32_t FIRST_TICK = 1000;
+static const uint32_t TICK_COUNT = 200;
+static const uint32_t SKIPPED_TICK = FIRST_TICK + 190;   // The server never recorded it
+static const uint32_t ABSENT_TICK = FIRST_TICK + 195;    // ABSENT_TARGET is dead here
+static const int ABSENT_TARGET = 5;
+static const int CHECK_TARGET = 3;
+
+static uint32_t nextRandom(uint32_t& state) {
+    // xorshift32
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static float nextUnit(uint32_t& state) {
+    return (nextRandom(state) & 0xffffff) / static_cast<float>(0x1000000);
+}
+
+static glm::vec3 targetCenter(int target, double tick) {
+    return glm::vec3((target % 8) * GRID_SPACING + static_cast<float>(tick * SPEED_PER_TICK),
+                     1.0f, (target / 8) * GRID_SPACING);
+}
+
+// Straight down onto the target's center as it was at `tick`, so only that column of
+// the grid is in the way
+static Ray shotAt(int target, double tick) {
+    Ray ray;
+    ray.origin = targetCenter(target, tick) + glm::vec3(0.0f, 10.0f, 0.0f);
+    ray.direction = glm::vec3(0.0f, -1.0f, 0.0f);
+    ray.maxDistance = 100.0f;
+    return ray;
+}
+
+static int fire(LagCompensation& lagCompensation, int owner, const Ray& ray, uint32_t viewTick, float viewFraction) {
+    HitscanBatch batch;
+    batch.addShot(owner, ray, 1.0f, viewTick, viewFraction);
+    lagCompensation.validateShots(batch);
+    return batch.getResults()[0].targetHit;
+}
+
+LagBench::LagBench(const LagBenchConfig& config)
+    : m_config(config) {
+    m_config.shots = std::max(m_config.shots, 1);
+    m_config.repeats = std::max(m_config.repeats, 1);
+}
+
+void LagBench::check(bool ok, const char* what) {
+    if (ok) {
+        m_result.checksPassed++;
+    } else {
+        m_result.checksFailed++;
+        std::cout << "  FAILED " << what << std::endl;
+    }
+}
+
+bool LagBench::run() {
+    m_result = LagBenchResult();
+    
+    LagCompensation lagCompensation;
+    for (uint32_t tick = FIRST_TICK; tick < FIRST_TICK + TICK_COUNT; tick++) {
+        if (tick == SKIPPED_TICK) {
+            continue;
+        }
+        lagCompensation.beginTick(tick);
+        for (int target = 0; target < LagCompensation::MAX_TARGETS; target++) {
+            if (tick != ABSENT_TICK || target != ABSENT_TARGET) {
+                lagCompensation.record(target, targetCenter(target, tick));
+            }
+        }
+    }
+    uint32_t newest = lagCompensation.getNewestTick();
+    uint32_t oldest = lagCompensation.getOldestTick();
+    
+    // Correctness: where a lagged client saw a target is a hit, where it is now isn't
+    Ray past = shotAt(CHECK_TARGET, newest - 10 + 0.5);
+    check(fire(lagCompensation, -1, past, newest - 10, 0.5f) == CHECK_TARGET, "shot at a past view tick hits the rewound target");
+    check(fire(lagCompensation, -1, past, VIEW_TICK_PRESENT, 0.0f) == -1, "the same shot at the present misses");
+    check(fire(lagCompensation, CHECK_TARGET, past, newest - 10, 0.5f) == -1, "a shot never hits its owner");
+    check(fire(lagCompensation, -1, past, newest - 10, NAN) == -1, "a NaN view fraction hits no one");
+    
+    Ray skipped = shotAt(CHECK_TARGET, SKIPPED_TICK + 0.5);
+    check(fire(lagCompensation, -1, skipped, SKIPPED_TICK, 0.5f) == CHECK_TARGET, "a skipped tick is interpolated across");
+    
+    Ray absent = shotAt(ABSENT_TARGET, ABSENT_TICK);
+    check(fire(lagCompensation, -1, absent, ABSENT_TICK, 0.0f) == -1, "a target absent at the view tick can't be hit");
+    
+    Ray oldestShot = shotAt(CHECK_TARGET, oldest);
+    check(oldest == newest - (LagCompensation::HISTORY_TICKS - 1), "the oldest tick is a full history back");
+    check(fire(lagCompensation, -1, oldestShot, FIRST_TICK, 0.0f) == CHECK_TARGET, "view ticks older than the history clamp to the oldest");
+    
+    // Cost: shots from around the grid at random view times across the whole history,
+    // through random points in the crowd
+    uint32_t random = m_config.seed * 2654435761u + 1;
+    HitscanBatch batch;
+    double bestSeconds = 0.0;
+    for (int repeat = 0; repeat < m_config.repeats; repeat++) {
+        batch.clear();
+        for (int i = 0; i < m_config.shots; i++) {
+            uint32_t viewTick = oldest + nextRandom(random) % (newest - oldest + 1);
+            float viewFraction = nextUnit(random);
+            glm::vec3 aim = targetCenter(static_cast<int>(nextRandom(random) % LagCompensation::MAX_TARGETS), viewTick + viewFraction);
+            aim += glm::vec3(nextUnit(random) - 0.5f, nextUnit(random) - 0.5f, nextUnit(random) - 0.5f) * 1.5f;
+            
+            float angle = nextUnit(random) * 6.2831853f;
+            Ray ray;
+            ray.origin = aim + glm::vec3(std::cos(angle) * 40.0f, 1.0f, std::sin(angle) * 40.0f);
+            ray.direction = glm::normalize(aim - ray.origin);
+            ray.maxDistance = 100.0f;
+            batch.addShot(static_cast<int>(nextRandom(random) % LagCompensation::MAX_TARGETS), ray, 1.0f, viewTick, viewFraction);
+        }
+        
+        LagCompensationStats before = lagCompensation.getStats();
+        auto start = std::chrono::steady_clock::now();
+        lagCompensation.validateShots(batch);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const LagCompensationStats& after = lagCompensation.getStats();
+        
+        if (repeat == 0 || seconds < bestSeconds) {
+            bestSeconds = seconds;
+            m_result.microsecondsPerShot = seconds * 1000000.0 / m_config.shots;
+            m_result.broadphasePerShot = static_cast<double>(after.broadphaseTests - before.broadphaseTests) / m_config.shots;
+            m_result.narrowphasePerShot = static_cast<double>(after.narrowphaseTests - before.narrowphaseTests) / m_config.shots;
+            m_result.hitRate = static_cast<double>(after.hits - before.hits) / m_config.shots;
+        }
+    }
+    
+    m_result.passed = m_result.checksFailed == 0;
+    
+    std::cout << "lag bench: " << LagCompensation::MAX_TARGETS << " targets, history " << oldest << "-" << newest
+              << ", checks " << m_result.checksPassed << "/" << m_result.checksPassed + m_result.checksFailed << std::endl;
+    std::cout << std::fixed << std::setprecision(3)
+              << "  " << m_config.shots << " shots  " << m_result.microsecondsPerShot << " us/shot  "
+              << std::setprecision(1) << m_result.broadphasePerShot << " sphere tests/shot  "
+              << std::setprecision(2) << m_result.narrowphasePerShot << " capsule tests/shot  "
+              << std::setprecision(0) << m_result.hitRate * 100.0 << "% hit" << std::endl;
+    std::cout << std::defaultfloat << std::setprecision(6);
+    std::cout << (m_result.passed ? "lag bench: passed" : "lag bench: FAILED") << std::endl;
+    return m_result.passed;
+}
@@ -0,0 +1,42 @@
+#ifndef LAG_BENCH_H
+#define LAG_BENCH_H
+
+#include <cstdint>
+
+struct LagBenchConfig {
+    int shots = 4096;    // Per timed batch
+    int repeats = 5;     // Fastest batch is kept
+    uint32_t seed = 1;
+};
+
+struct LagBenchResult {
+    int checksPassed = 0;
+    int checksFailed = 0;
+    double microsecondsPerShot = 0.0;
+    double broadphasePerShot = 0.0;
+    double narrowphasePerShot = 0.0;
+    double hitRate = 0.0;
+    bool passed = false;
+};
+
+// Lag compensation check and benchmark. Fills LagCompensation::MAX_TARGETS moving targets
+// over more than a history's worth of ticks, some of them skipped, then checks that a shot
+// at a past view time hits the rewound target where the same shot at the present misses,
+// including across a skipped tick. A batch of shots at random view times through the
+// crowd is timed for the per-shot cost. Fails only on a wrong hit or miss.
+class LagBench {
+public:
+    explicit LagBench(const LagBenchConfig& config);
+    
+    bool run();
+    
+    const LagBenchResult& getResult() const { return m_result; }
+    
+private:
+    LagBenchConfig m_config;
+    LagBenchResult m_result;
+    
+    void check(bool ok, const char* what);
+};
+
+#endif
@@ -0,0 +1,462 @@
+#include "server/perf_harness.h"
+#include "utils/alloc_counter.h"
+#include "game/replay.h"
+#include "game/simulation.h"
+#include <sys/resource.h>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+struct ScriptedMatch {
+    const char* name;
+    int players;
+    uint32_t ticks;
+    uint32_t seed;
+};
+
+// Half an hour of match time each, so a run takes long enough to time reliably
+static const ScriptedMatch SCRIPTED_MATCHES[] = {
+    {"scripted_duel", 2, 30 * 60 * SIMULATION_TICK_RATE, 1},
+    {"scripted_brawl", 4, 30 * 60 * SIMULATION_TICK_RATE, 2},
+};
+
+// Slack on top of the percentage: a baseline of zero allocations per tick still allows
+// the odd vector growing during a run
+static const double ALLOCATION_SLACK_PER_TICK = 0.01;
+
+static uint32_t nextRandom(uint32_t& state) {
+    // xorshift32
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// Timed next to each scenario to tell how fast the machine is running right now. A
+// dependent chain of integer steps, so the compiler can't vectorize or skip it.
+static const uint32_t REFERENCE_STEPS = 1 << 24;
+static volatile uint32_t s_referenceSink;
+
+static double measureReferenceOpsPerSecond() {
+    uint32_t state = 1;
+    uint32_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < REFERENCE_STEPS; i++) {
+        sum += nextRandom(state) >> 7;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    s_referenceSink = sum;
+    return seconds > 0.0 ? REFERENCE_STEPS / seconds : 0.0;
+}
+
+static uint64_t readPeakRssKiB() {
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return static_cast<uint64_t>(usage.ru_maxrss) / 1024;  // Bytes on macOS
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss);
+#endif
+}
+
+// Baseline and JSON keys are whitespace-free
+static std::string scenarioName(const std::string& replayPath) {
+    std::string name = "replay_" + replayPath.substr(replayPath.find_last_of("/\\") + 1);
+    std::replace_if(name.begin(), name.end(), [](char c) { return isspace(static_cast<unsigned char>(c)) != 0; }, '_');
+    return name;
+}
+
+PerfHarness::PerfHarness(const PerfConfig& config)
+    : m_config(config)
+    , m_peakRssKiB(0) {
+    m_config.repeats = std::max(m_config.repeats, 1);
+}
+
+bool PerfHarness::run() {
+    m_results.clear();
+    loadBaselines();
+    loadThroughput();
+    
+    std::vector<Scenario> scenarios;
+    if (!buildScenarios(scenarios)) {
+        return false;
+    }
+    
+    bool passed = true;
+    for (const Scenario& scenario : scenarios) {
+        PerfResult result = measure(scenario);
+        compare(result);
+        passed = passed && result.regressions.empty();
+        
+        std::cout << std::fixed << std::setprecision(0)
+                  << result.scenario << "  " << result.ticks << " ticks  "
+                  << result.ticksPerSecond << " ticks/s  "
+                  << std::setprecision(3) << result.allocationsPerTick << " allocs/tick  "
+                  << std::setprecision(0) << result.bytesPerTick << " B/tick";
+        if (!result.hasBaseline && !m_config.requireBaseline) {
+            std::cout << "  (new baseline)";
+        } else if (result.regressions.empty() && result.baseline.ticksPerSecond > 0.0) {
+            std::cout << "  (baseline " << result.baseline.ticksPerSecond << " ticks/s)";
+        }
+        std::cout << std::defaultfloat << std::setprecision(6) << std::endl;
+        
+        for (const std::string& regression : result.regressions) {
+            std::cout << "  REGRESSION " << regression << std::endl;
+        }
+        
+        m_results.push_back(result);
+    }
+    
+    m_peakRssKiB = readPeakRssKiB();
+    std::cout << "peak RSS " << m_peakRssKiB << " KiB for the whole run" << std::endl;
+    
+    // A regressed run would bake the regression into the baseline
+    bool changed = false;
+    bool throughputChanged = false;
+    for (const PerfResult& result : m_results) {
+        bool record = !result.hasBaseline && !m_config.requireBaseline;
+        if (record || (m_config.updateBaseline && passed)) {
+            PerfBaseline& baseline = m_baselines[result.scenario];
+            baseline.ticksPerSecond = m_config.throughputPath.empty() ? result.ticksPerSecond : baseline.ticksPerSecond;
+            baseline.allocationsPerTick = result.allocationsPerTick;
+            changed = true;
+        }
+        
+        bool recordThroughput = m_throughput.count(result.scenario) == 0 && result.regressions.empty();
+        if (!m_config.throughputPath.empty() && (recordThroughput || (m_config.updateBaseline && passed))) {
+            PerfThroughput& throughput = m_throughput[result.scenario];
+            throughput.ticksPerSecond = result.ticksPerSecond;
+            throughput.referenceOpsPerSecond = result.referenceOpsPerSecond;
+            throughputChanged = true;
+        }
+    }
+    if (changed) {
+        saveBaselines();
+    }
+    if (throughputChanged) {
+        saveThroughput();
+    }
+    
+    if (!m_config.jsonPath.empty()) {
+        writeJson(passed);
+    }
+    
+    std::cout << (passed ? "perf: passed" : "perf: FAILED") << std::endl;
+    return passed;
+}
+
+bool PerfHarness::buildScenarios(std::vector<Scenario>& scenarios) {
+    // Scripted matches: each fighter holds a random move for a few ticks at a time and
+    // jumps or attacks now and then. Lots of stocks so nobody wins before the end.
+    for (const ScriptedMatch& match : SCRIPTED_MATCHES) {
+        Scenario scenario;
+        scenario.name = match.name;
+        scenario.settings.mode = GameMode::STOCK;
+        scenario.settings.stockCount = 99;
+        scenario.settings.seed = match.seed;
+        for (int i = 0; i < match.players; i++) {
+            scenario.players.push_back(static_cast<FighterType>(i % 4));
+        }
+        
+        uint32_t random = match.seed * 2654435761u + 1;
+        std::vector<PlayerInput> held(match.players, PlayerInput::make(glm::vec2(0.0f), false, false, AttackType::NEUTRAL));
+        std::vector<uint32_t> holdTicks(match.players, 0);
+        scenario.inputs.reserve(static_cast<size_t>(match.ticks) * match.players);
+        
+        for (uint32_t tick = 0; tick < match.ticks; tick++) {
+            for (int i = 0; i < match.players; i++) {
+                PlayerInput input = held[i];
+                input.buttons = 0;
+                if (holdTicks[i] == 0) {
+                    holdTicks[i] = 6 + nextRandom(random) % 25;
+                    float moveX = static_cast<float>(static_cast<int>(nextRandom(random) % 3) - 1);
+                    bool jump = nextRandom(random) % 8 == 0;
+                    bool attack = nextRandom(random) % 3 == 0;
+                    input = PlayerInput::make(glm::vec2(moveX, 0.0f), jump, attack, static_cast<AttackType>(nextRandom(random) % 8));
+                    held[i] = input;
+                }
+                holdTicks[i]--;
+                scenario.inputs.push_back(input);
+            }
+        }
+        scenarios.push_back(scenario);
+    }
+    
+    // Replays are decoded up front so reading them isn't part of the timing
+    for (const std::string& path : m_config.replays) {
+        ReplayFile file;
+        if (!file.open(path)) {
+            std::cerr << "perf: can't open replay " << path << std::endl;
+            return false;
+        }
+        
+        Scenario scenario;
+        scenario.name = scenarioName(path);
+        scenario.settings = file.getSettings();
+        scenario.players = file.getPlayers();
+        
+        GameManager loader;
+        loader.init();
+        ReplayPlayer player(file);
+        if (!player.setup(loader)) {
+            return false;
+        }
+        
+        std::vector<PlayerInput> inputs(scenario.players.size());
+        scenario.inputs.reserve(static_cast<size_t>(file.getTickCount()) * inputs.size());
+        while (player.nextTick(inputs.data())) {
+            scenario.inputs.insert(scenario.inputs.end(), inputs.begin(), inputs.end());
+        }
+        if (player.isCorrupt()) {
+            std::cerr << "perf: replay " << path << " is corrupt at tick " << player.getTick() << std::endl;
+            return false;
+        }
+        scenarios.push_back(scenario);
+    }
+    
+    return true;
+}
+
+PerfResult PerfHarness::measure(const Scenario& scenario) {
+    PerfResult best;
+    best.scenario = scenario.name;
+    
+    int playerCount = static_cast<int>(scenario.players.size());
+    size_t tickCount = playerCount > 0 ? scenario.inputs.size() / playerCount : 0;
+    
+    double bestScore = 0.0;
+    for (int repeat = 0; repeat < m_config.repeats; repeat++) {
+        double referenceBefore = measureReferenceOpsPerSecond();
+        
+        GameManager game;
+        game.init();
+        game.getGameSettings() = scenario.settings;
+        for (int i = 0; i < playerCount; i++) {
+            game.addPlayer(scenario.players[i], i);
+        }
+        game.startGame();
+        
+        uint64_t startTick = game.getCurrentTick();
+        AllocationCounts allocationsBefore = AllocationCounter::get();
+        auto start = std::chrono::steady_clock::now();
+        
+        // One update() per tick, as a frame at exactly the tick rate would do
+        const PlayerInput* input = scenario.inputs.data();
+        for (size_t tick = 0; tick < tickCount && game.getGameState() == GameState::PLAYING; tick++) {
+            for (int i = 0; i < playerCount; i++, input++) {
+                glm::vec2 movement(static_cast<float>(input->moveX), 0.0f);
+                game.processPlayerInput(i, movement, (input->buttons & INPUT_JUMP) != 0,
+                                        (input->buttons & INPUT_ATTACK) != 0, static_cast<AttackType>(input->attackType));
+            }
+            game.update(SIMULATION_TICK_DURATION);
+        }
+        
+        auto end = std::chrono::steady_clock::now();
+        AllocationCounts allocationsAfter = AllocationCounter::get();
+        
+        // The machine's speed on either side of the run
+        double reference = (referenceBefore + measureReferenceOpsPerSecond()) * 0.5;
+        
+        uint64_t ticks = game.getCurrentTick() - startTick;
+        double seconds = std::chrono::duration<double>(end - start).count();
+        double ticksPerSecond = seconds > 0.0 ? ticks / seconds : 0.0;
+        
+        // Allocation counts don't vary between runs; the run fastest for the speed the
+        // machine was going at is the least disturbed
+        double score = reference > 0.0 ? ticksPerSecond / reference : ticksPerSecond;
+        if (repeat == 0 || score > bestScore) {
+            bestScore = score;
+            best.ticks = ticks;
+            best.ticksPerSecond = ticksPerSecond;
+            best.referenceOpsPerSecond = reference;
+            if (ticks > 0) {
+                best.allocationsPerTick = static_cast<double>(allocationsAfter.allocations - allocationsBefore.allocations) / ticks;
+                best.bytesPerTick = static_cast<double>(allocationsAfter.bytes - allocationsBefore.bytes) / ticks;
+            }
+        }
+    }
+    
+    return best;
+}
+
+void PerfHarness::compare(PerfResult& result) {
+    auto found = m_baselines.find(result.scenario);
+    if (found != m_baselines.end()) {
+        result.hasBaseline = true;
+        result.baseline = found->second;
+    } else if (m_config.requireBaseline) {
+        result.regressions.push_back("no baseline for this scenario in " + m_config.baselinePath);
+    }
+    
+    // This machine's own ticks/s beats one recorded somewhere else
+    auto throughput = m_throughput.find(result.scenario);
+    if (throughput != m_throughput.end()) {
+        const PerfThroughput& recorded = throughput->second;
+        double speed = 1.0;
+        if (recorded.referenceOpsPerSecond > 0.0 && result.referenceOpsPerSecond > 0.0) {
+            speed = result.referenceOpsPerSecond / recorded.referenceOpsPerSecond;
+        }
+        result.baseline.ticksPerSecond = recorded.ticksPerSecond * speed;
+    }
+    
+    const PerfBaseline& baseline = result.baseline;
+    double tolerance = m_config.tolerancePercent / 100.0;
+    
+    std::ostringstream message;
+    message << std::fixed;
+    
+    if (baseline.ticksPerSecond > 0.0 && result.ticksPerSecond < baseline.ticksPerSecond * (1.0 - tolerance)) {
+        message.str("");
+        message << std::setprecision(0) << "ticks/s " << result.ticksPerSecond << " vs baseline " << baseline.ticksPerSecond
+                << std::setprecision(1) << " (" << (result.ticksPerSecond / baseline.ticksPerSecond - 1.0) * 100.0 << "%)";
+        result.regressions.push_back(message.str());
+    }
+    
+    if (result.hasBaseline && result.allocationsPerTick > baseline.allocationsPerTick * (1.0 + tolerance) + ALLOCATION_SLACK_PER_TICK) {
+        message.str("");
+        message << std::setprecision(3) << "allocations/tick " << result.allocationsPerTick << " vs baseline " << baseline.allocationsPerTick;
+        result.regressions.push_back(message.str());
+    }
+}
+
+bool PerfHarness::loadBaselines() {
+    m_baselines.clear();
+    
+    std::ifstream in(m_config.baselinePath);
+    if (!in) {
+        if (m_config.requireBaseline) {
+            std::cerr << "perf: no baseline at " << m_config.baselinePath << std::endl;
+        } else {
+            std::cout << "perf: no baseline at " << m_config.baselinePath << ", recording one" << std::endl;
+        }
+        return false;
+    }
+    
+    // One scenario per line: name ticks_per_second allocations_per_tick
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        
+        std::istringstream fields(line);
+        std::string name;
+        PerfBaseline baseline;
+        if (fields >> name >> baseline.ticksPerSecond >> baseline.allocationsPerTick) {
+            m_baselines[name] = baseline;
+        } else {
+            std::cerr << "perf: ignoring bad baseline line: " << line << std::endl;
+        }
+    }
+    return true;
+}
+
+bool PerfHarness::saveBaselines() const {
+    std::ofstream out(m_config.baselinePath);
+    if (!out) {
+        std::cerr << "Failed to write perf baseline to " << m_config.baselinePath << std::endl;
+        return false;
+    }
+    
+    out << "# scenario ticks_per_second allocations_per_tick\n";
+    out << "# ticks/s depends on the machine; 0 skips that check\n";
+    for (const auto& entry : m_baselines) {
+        out << entry.first << " " << std::fixed << std::setprecision(0) << entry.second.ticksPerSecond
+            << " " << std::setprecision(4) << entry.second.allocationsPerTick << "\n";
+    }
+    return static_cast<bool>(out);
+}
+
+void PerfHarness::loadThroughput() {
+    m_throughput.clear();
+    if (m_config.throughputPath.empty()) {
+        return;
+    }
+    
+    std::ifstream in(m_config.throughputPath);
+    if (!in) {
+        std::cout << "perf: no throughput baseline at " << m_config.throughputPath << ", recording this machine's" << std::endl;
+        return;
+    }
+    
+    // One scenario per line: name ticks_per_second reference_ops_per_second
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        
+        std::istringstream fields(line);
+        std::string name;
+        PerfThroughput throughput;
+        if (fields >> name >> throughput.ticksPerSecond >> throughput.referenceOpsPerSecond) {
+            m_throughput[name] = throughput;
+        } else {
+            std::cerr << "perf: ignoring bad throughput line: " << line << std::endl;
+        }
+    }
+}
+
+bool PerfHarness::saveThroughput() const {
+    std::ofstream out(m_config.throughputPath);
+    if (!out) {
+        std::cerr << "Failed to write perf throughput to " << m_config.throughputPath << std::endl;
+        return false;
+    }
+    
+    out << "# scenario ticks_per_second reference_ops_per_second\n";
+    out << "# measured on this machine; delete the file to re-record\n";
+    for (const auto& entry : m_throughput) {
+        out << entry.first << " " << std::fixed << std::setprecision(0) << entry.second.ticksPerSecond
+            << " " << entry.second.referenceOpsPerSecond << "\n";
+    }
+    return static_cast<bool>(out);
+}
+
+bool PerfHarness::writeJson(bool passed) const {
+    std::ofstream out(m_config.jsonPath);
+    if (!out) {
+        std::cerr << "Failed to write perf results to " << m_config.jsonPath << std::endl;
+        return false;
+    }
+    
+#ifdef FIXED_POINT_SIMULATION
+    const bool fixedPoint = true;
+#else
+    const bool fixedPoint = false;
+#endif
+    
+    out << std::fixed << std::setprecision(3);
+    out << "{\n";
+    out << "  \"time\": " << static_cast<int64_t>(std::time(nullptr)) << ",\n";
+    out << "  \"fixed_point\": " << (fixedPoint ? "true" : "false") << ",\n";
+    out << "  \"tolerance_percent\": " << m_config.tolerancePercent << ",\n";
+    out << "  \"passed\": " << (passed ? "true" : "false") << ",\n";
+    out << "  \"peak_rss_kib\": " << m_peakRssKiB << ",\n";
+    out << "  \"scenarios\": [";
+    for (size_t i = 0; i < m_results.size(); i++) {
+        const PerfResult& result = m_results[i];
+        out << (i ? ",\n    " : "\n    ")
+            << "{\"name\": \"" << result.scenario << "\""
+            << ", \"ticks\": " << result.ticks
+            << ", \"ticks_per_second\": " << result.ticksPerSecond
+            << ", \"allocations_per_tick\": " << result.allocationsPerTick
+            << ", \"bytes_per_tick\": " << result.bytesPerTick
+            << ", \"reference_ops_per_second\": " << result.referenceOpsPerSecond;
+        if (result.hasBaseline || result.baseline.ticksPerSecond > 0.0) {
+            out << ", \"baseline\": {\"ticks_per_second\": " << result.baseline.ticksPerSecond
+                << ", \"allocations_per_tick\": " << result.baseline.allocationsPerTick << "}";
+        }
+        out << ", \"regressed\": " << (result.regressions.empty() ? "false" : "true") << "}";
+    }
+    out << (m_results.empty() ? "]\n" : "\n  ]\n");
+    out << "}\n";
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,95 @@
+#ifndef PERF_HARNESS_H
+#define PERF_HARNESS_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "game/game_manager.h"
+
+struct PerfConfig {
+    std::string baselinePath;
+    std::string throughputPath;        // This machine's ticks/s, recorded on first run; empty to skip
+    std::string jsonPath;              // Empty to skip the JSON report
+    std::vector<std::string> replays;  // Run after the built-in scripted matches
+    double tolerancePercent = 10.0;    // Allowed drop in ticks/s and rise in allocations
+    int repeats = 3;                   // Best run of each scenario is kept
+    bool updateBaseline = false;       // Overwrite existing baselines with this run
+    bool requireBaseline = false;      // Fail scenarios missing from the baseline instead of recording them
+};
+
+struct PerfBaseline {
+    double ticksPerSecond = 0.0;       // 0 skips the throughput check
+    double allocationsPerTick = 0.0;
+};
+
+// This machine's ticks/s for a scenario, and how fast the reference workload ran
+// alongside it
+struct PerfThroughput {
+    double ticksPerSecond = 0.0;
+    double referenceOpsPerSecond = 0.0;
+};
+
+struct PerfResult {
+    std::string scenario;
+    uint64_t ticks = 0;
+    double ticksPerSecond = 0.0;
+    double allocationsPerTick = 0.0;
+    double bytesPerTick = 0.0;
+    double referenceOpsPerSecond = 0.0;
+    bool hasBaseline = false;
+    PerfBaseline baseline;                 // ticksPerSecond from the throughput file when it has one, scaled
+    std::vector<std::string> regressions;  // Empty when within tolerance
+};
+
+// Performance regression check for the match simulation. Each scenario is a fixed list
+// of per-tick inputs, built in (seeded scripted matches) or read from a replay, fed
+// through GameManager::update one tick per call with no window or network. Heap
+// allocations per tick are compared with the baseline file, which can be shared between
+// machines. Ticks/s is compared with the throughput file, which holds this machine's own
+// numbers, or with the baseline file's where it has none. A fixed reference workload is
+// timed next to each scenario and the throughput file's ticks/s is scaled by how much
+// faster or slower it ran than when they were recorded, so a busy or throttled machine
+// doesn't read as a regression. Peak RSS covers the whole process, so it is reported
+// once per run rather than per scenario.
+//
+// Scenarios missing from the baseline fail with requireBaseline; otherwise they are
+// added to it and pass. Scenarios missing from the throughput file are always added to
+// it. Existing numbers only change with updateBaseline, and never from a run that
+// regressed.
+class PerfHarness {
+public:
+    explicit PerfHarness(const PerfConfig& config);
+    
+    // True when no scenario regressed beyond the tolerance
+    bool run();
+    
+    const std::vector<PerfResult>& getResults() const { return m_results; }
+    uint64_t getPeakRssKiB() const { return m_peakRssKiB; }
+    
+private:
+    struct Scenario {
+        std::string name;
+        GameSettings settings;
+        std::vector<FighterType> players;
+        std::vector<PlayerInput> inputs;  // players.size() per tick
+    };
+    
+    PerfConfig m_config;
+    std::map<std::string, PerfBaseline> m_baselines;
+    std::map<std::string, PerfThroughput> m_throughput;
+    std::vector<PerfResult> m_results;
+    uint64_t m_peakRssKiB;
+    
+    bool buildScenarios(std::vector<Scenario>& scenarios);
+    PerfResult measure(const Scenario& scenario);
+    void compare(PerfResult& result);
+    
+    bool loadBaselines();
+    bool saveBaselines() const;
+    void loadThroughput();
+    bool saveThroughput() const;
+    bool writeJson(bool passed) const;
+};
+
+#endif
@@ -0,0 +1,140 @@
+#include "server/rollback_bench.h"
+#include "game/rollback_session.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+static double microsecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Sorts the samples in place
+static RollbackTimings summarize(std::vector<double>& samples) {
+    RollbackTimings timings;
+    if (samples.empty()) {
+        return timings;
+    }
+    
+    std::sort(samples.begin(), samples.end());
+    double total = 0.0;
+    for (double sample : samples) {
+        total += sample;
+    }
+    timings.average = total / samples.size();
+    timings.p99 = samples[std::min(samples.size() - 1, samples.size() * 99 / 100)];
+    timings.max = samples.back();
+    return timings;
+}
+
+static void printTimings(const char* label, const RollbackTimings& timings) {
+    std::cout << std::fixed << std::setprecision(1)
+              << "  " << label << "  avg " << timings.average << " us"
+              << "  p99 " << timings.p99 << " us"
+              << "  max " << timings.max << " us" << std::endl;
+}
+
+// Input a player holds for a frame. moveX flips every frame, so the prediction (the
+// player's previous input) is always wrong; attacks and jumps keep hitboxes in play.
+static PlayerInput scriptedInput(int player, uint32_t frame, uint32_t seed) {
+    uint32_t random = (frame * 2654435761u) ^ (static_cast<uint32_t>(player + 1) * 40503u) ^ seed;
+    random ^= random >> 15;
+    random *= 2246822519u;
+    random ^= random >> 13;
+    
+    float moveX = (frame + player) % 2 == 0 ? 1.0f : -1.0f;
+    bool jump = random % 16 == 0;
+    bool attack = (random >> 4) % 4 == 0;
+    return PlayerInput::make(glm::vec2(moveX, 0.0f), jump, attack, static_cast<AttackType>((random >> 8) % 8));
+}
+
+RollbackBench::RollbackBench(const RollbackBenchConfig& config)
+    : m_config(config) {
+    m_config.players = std::max(2, std::min(m_config.players, static_cast<int>(RollbackSession::MAX_PLAYERS)));
+    m_config.frames = std::max(m_config.frames, RollbackSession::MAX_ROLLBACK_FRAMES + 1);
+}
+
+bool RollbackBench::run() {
+    m_result = RollbackBenchResult();
+    
+    GameManager game;
+    game.init();
+    game.getGameSettings().mode = GameMode::STOCK;
+    game.getGameSettings().stockCount = 99;  // Nobody wins before the end
+    game.getGameSettings().seed = m_config.seed;
+    for (int i = 0; i < m_config.players; i++) {
+        game.addPlayer(static_cast<FighterType>(i % 4), i);
+    }
+    game.startGame();
+    
+    RollbackSession session(&game);
+    const uint32_t delay = RollbackSession::MAX_ROLLBACK_FRAMES;
+    
+    // Reserved up front so recording a sample never allocates inside the timed region
+    std::vector<double> saveSamples, loadSamples, rollbackSamples;
+    saveSamples.reserve(m_config.frames);
+    loadSamples.reserve(m_config.frames);
+    rollbackSamples.reserve(m_config.frames);
+    std::vector<uint8_t> snapshot;
+    
+    uint64_t rollbacks = 0;
+    for (uint32_t frame = 0; frame < static_cast<uint32_t>(m_config.frames); frame++) {
+        if (game.getGameState() != GameState::PLAYING) {
+            std::cerr << "rollback bench: match ended at frame " << frame << std::endl;
+            return false;
+        }
+        
+        session.addLocalInput(0, scriptedInput(0, frame, m_config.seed));
+        if (frame >= delay) {
+            for (int player = 1; player < m_config.players; player++) {
+                session.addRemoteInput(player, frame - delay, scriptedInput(player, frame - delay, m_config.seed));
+            }
+        }
+        
+        session.advanceFrame();
+        
+        const RollbackStats& stats = session.getStats();
+        if (stats.rollbacks != rollbacks) {
+            rollbacks = stats.rollbacks;
+            rollbackSamples.push_back(stats.lastRollbackMicroseconds);
+            m_result.framesPerRollback = std::max(m_result.framesPerRollback, stats.lastRollbackFrames);
+        }
+        
+        // Save and load on their own, restoring the state we just saved
+        auto start = std::chrono::steady_clock::now();
+        game.saveState(snapshot);
+        saveSamples.push_back(microsecondsSince(start));
+        
+        start = std::chrono::steady_clock::now();
+        game.loadState(snapshot.data(), snapshot.size());
+        loadSamples.push_back(microsecondsSince(start));
+    }
+    
+    m_result.rollbacks = rollbacks;
+    m_result.save = summarize(saveSamples);
+    m_result.load = summarize(loadSamples);
+    m_result.rollback = summarize(rollbackSamples);
+    
+    // Anything short of full-window rollbacks on almost every frame isn't the worst case
+    bool fullWindow = m_result.framesPerRollback == RollbackSession::MAX_ROLLBACK_FRAMES &&
+                      rollbacks + delay >= static_cast<uint64_t>(m_config.frames);
+    m_result.passed = fullWindow && m_result.rollback.p99 <= m_config.budgetMicroseconds;
+    
+    std::cout << "rollback bench: " << m_config.players << " players, " << rollbacks << " rollbacks of "
+              << m_result.framesPerRollback << " frames, snapshot " << snapshot.size() << " B" << std::endl;
+    printTimings("save    ", m_result.save);
+    printTimings("load    ", m_result.load);
+    printTimings("rollback", m_result.rollback);
+    std::cout << std::defaultfloat << std::setprecision(6);
+    
+    if (!fullWindow) {
+        std::cout << "rollback bench: FAILED, expected a " << RollbackSession::MAX_ROLLBACK_FRAMES
+                  << "-frame rollback every frame" << std::endl;
+    } else if (!m_result.passed) {
+        std::cout << "rollback bench: FAILED, p99 over the " << m_config.budgetMicroseconds << " us budget" << std::endl;
+    } else {
+        std::cout << "rollback bench: passed" << std::endl;
+    }
+    return m_result.passed;
+}
@@ -0,0 +1,45 @@
+#ifndef ROLLBACK_BENCH_H
+#define ROLLBACK_BENCH_H
+
+#include <cstdint>
+
+struct RollbackBenchConfig {
+    int players = 4;
+    int frames = 3600;                   // A minute of match time
+    double budgetMicroseconds = 1000.0;  // Full-window rollback, 99th percentile
+    uint32_t seed = 1;
+};
+
+struct RollbackTimings {
+    double average = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+};
+
+struct RollbackBenchResult {
+    uint64_t rollbacks = 0;
+    int framesPerRollback = 0;
+    RollbackTimings save;        // GameManager::saveState
+    RollbackTimings load;        // GameManager::loadState
+    RollbackTimings rollback;    // Load plus re-simulating the window, as RollbackSession does it
+    bool passed = false;
+};
+
+// Worst-case rollback benchmark. One local player and the rest remote, with every remote
+// input arriving a full MAX_ROLLBACK_FRAMES late and never matching its prediction, so
+// each frame rolls back the whole window before simulating. Fails when the 99th
+// percentile rollback exceeds the budget.
+class RollbackBench {
+public:
+    explicit RollbackBench(const RollbackBenchConfig& config);
+    
+    bool run();
+    
+    const RollbackBenchResult& getResult() const { return m_result; }
+    
+private:
+    RollbackBenchConfig m_config;
+    RollbackBenchResult m_result;
+};
+
+#endif
@@ -0,0 +1,460 @@
+#include "net/match_server.h"
+#include "net/match_host.h"
+#include "net/match_client.h"
+#include "net/network_simulator.h"
+#include "game/replay.h"
+#include "game/simulation.h"
+#include "server/perf_harness.h"
+#include "server/rollback_bench.h"
+#include "server/lag_bench.h"
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+static std::atomic<bool> s_running(true);
+
+static void handleSignal(int) {
+    s_running = false;
+}
+
+static void printMetrics(const MatchServer& server) {
+    const ServerMetrics& metrics = server.getMetrics();
+    std::cout << "tick " << server.getServerTick()
+              << "  clients " << server.getClientCount()
+              << "  tick avg " << metrics.averageTickMicroseconds << " us"
+              << "  max " << metrics.maxTickMicroseconds << " us" << std::endl;
+    
+    for (int i = 0; i < server.getMaxClients(); i++) {
+        if (!server.isClientConnected(i)) {
+            continue;
+        }
+        const ClientMetrics& client = server.getClientMetrics(i);
+        std::cout << "  client " << i
+                  << "  " << client.bytesPerSecond / 1024.0 << " KiB/s"
+                  << "  sent " << client.bytesSent << " B"
+                  << "  snapshots " << client.snapshotsSent
+                  << " (" << client.fullSnapshots << " full)" << std::endl;
+    }
+}
+
+static void printHostMetrics(const MatchHost& host) {
+    MatchHostMetrics metrics = host.getMetrics();
+    std::cout << "matches " << metrics.matches
+              << "  ticks " << metrics.ticks
+              << "  latency avg " << metrics.averageLatencyMicroseconds << " us"
+              << "  max " << metrics.maxLatencyMicroseconds << " us (match " << metrics.worstMatch << ")"
+              << "  missed deadlines " << metrics.missedDeadlines
+              << "  skipped ticks " << metrics.skippedTicks << std::endl;
+}
+
+// How stale a client's last snapshot may be once the loopback test has drained the
+// network, a quarter of a second
+static const uint32_t LOOPBACK_MAX_TICKS_BEHIND = SIMULATION_TICK_RATE / 4;
+
+// Plays a match between in-process clients over 127.0.0.1 as fast as the server can
+// tick, then checks every client kept up and rebuilt the server's snapshots exactly.
+// With a netsim script every endpoint sends through its own seeded NetworkSimulator,
+// stepped in simulated time, so a run is reproducible.
+static int runLoopbackTest(int clientCount, int seconds, const std::string& netsim, uint64_t seed) {
+    // Declared first so they outlive the server and clients that send through them
+    std::vector<std::unique_ptr<NetworkSimulator>> simulators;
+    
+    ServerConfig config;
+    config.port = 0;
+    config.maxClients = clientCount;
+    config.loopbackOnly = true;
+    
+    MatchServer server(config);
+    if (!server.start()) {
+        return 1;
+    }
+    
+    std::vector<std::unique_ptr<MatchClient>> clients;
+    
+    if (!netsim.empty()) {
+        simulators.emplace_back(new NetworkSimulator(&server.getSocket(), seed));
+        server.setTransport(simulators.back().get());
+    }
+    
+    for (int i = 0; i < clientCount; i++) {
+        clients.emplace_back(new MatchClient());
+        MatchClient& client = *clients.back();
+        
+        // The simulator has to be in place before connect() sends the handshake
+        if (!netsim.empty()) {
+            simulators.emplace_back(new NetworkSimulator(&client.getSocket(), seed + i + 1));
+            client.setTransport(simulators.back().get());
+        }
+        
+        if (!client.connect(NetAddress::loopback(server.getPort()), static_cast<FighterType>(i % 4))) {
+            return 1;
+        }
+    }
+    
+    for (auto& simulator : simulators) {
+        if (!simulator->loadScript(netsim)) {
+            std::cerr << "Invalid netsim script: " << netsim << std::endl;
+            return 1;
+        }
+    }
+    
+    int totalTicks = seconds * SIMULATION_TICK_RATE;
+    for (int tick = 0; tick < totalTicks; tick++) {
+        for (auto& simulator : simulators) {
+            simulator->update(SIMULATION_TICK_DURATION);
+        }
+        
+        for (int i = 0; i < clientCount; i++) {
+            MatchClient& client = *clients[i];
+            client.update();
+            
+            // Deterministic mix of walking, jumping and attacking per client
+            int phase = (tick / 20 + i * 7) % 6;
+            glm::vec2 movement(phase < 2 ? -1.0f : (phase < 4 ? 1.0f : 0.0f), 0.0f);
+            bool jump = (tick + i * 11) % 45 == 0;
+            bool attack = (tick + i * 5) % 30 == 0;
+            client.sendInput(PlayerInput::make(movement, jump, attack, static_cast<AttackType>((tick / 30) % 8)));
+        }
+        
+        server.tick();
+    }
+    
+    // Let packets still in flight land, without ticking the server further
+    for (int i = 0; i < SIMULATION_TICK_RATE; i++) {
+        for (auto& simulator : simulators) {
+            simulator->update(SIMULATION_TICK_DURATION);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        for (auto& client : clients) {
+            client->update();
+        }
+    }
+    
+    bool allMatch = true;
+    for (int i = 0; i < clientCount; i++) {
+        MatchClient& client = *clients[i];
+        
+        // Every client has to end up close to the server and rebuild that snapshot exactly;
+        // one that never heard from it, or fell out of its history, is starved
+        const NetSnapshot* latest = client.getLatestSnapshot();
+        uint32_t ticksBehind = latest ? server.getServerTick() - latest->tick : server.getServerTick();
+        const NetSnapshot* expected = latest ? server.getSnapshot(latest->tick) : nullptr;
+        bool current = expected && ticksBehind <= LOOPBACK_MAX_TICKS_BEHIND;
+        bool matches = current && *latest == *expected;
+        allMatch = allMatch && matches;
+        
+        std::cout << "client " << i
+                  << "  snapshots " << client.getSnapshotsReceived()
+                  << "  decode failures " << client.getDecodeFailures()
+                  << "  avg " << (client.getSnapshotsReceived() ? client.getBytesReceived() / client.getSnapshotsReceived() : 0)
+                  << " B/snapshot  ticks behind " << ticksBehind
+                  << "  state " << (!current ? "STARVED" : (matches ? "matches" : "MISMATCH")) << std::endl;
+    }
+    
+    for (size_t i = 0; i < simulators.size(); i++) {
+        const NetworkSimulatorStats& stats = simulators[i]->getStats();
+        std::cout << (i == 0 ? "netsim server" : "netsim client " + std::to_string(i - 1))
+                  << "  sent " << stats.packetsSent
+                  << "  delivered " << stats.packetsDelivered
+                  << "  lost " << stats.packetsLost
+                  << "  queue dropped " << stats.packetsQueueDropped
+                  << "  duplicated " << stats.packetsDuplicated
+                  << "  reordered " << stats.packetsReordered << std::endl;
+    }
+    
+    printMetrics(server);
+    
+    for (auto& client : clients) {
+        client->disconnect();
+    }
+    server.stop();
+    
+    return allMatch ? 0 : 1;
+}
+
+// Re-runs a recorded match headless as fast as possible and checks it ends up in the
+// recorded state. With a seek tick, only restores that point and reports how long it took.
+static int playReplay(const std::string& path, int64_t seekTick) {
+    auto openStart = std::chrono::steady_clock::now();
+    ReplayFile file;
+    if (!file.open(path)) {
+        return 1;
+    }
+    auto openEnd = std::chrono::steady_clock::now();
+    
+    std::cout << "replay " << path
+              << "  " << file.getFileSize() << " B"
+              << "  players " << file.getPlayers().size()
+              << "  ticks " << file.getTickCount()
+              << "  keyframes " << file.getKeyframeCount()
+              << "  opened in " << std::chrono::duration<double, std::micro>(openEnd - openStart).count() << " us" << std::endl;
+    
+    if (seekTick >= 0) {
+        GameManager game;
+        game.init();
+        ReplayPlayer player(file);
+        if (!player.setup(game)) {
+            return 1;
+        }
+        
+        auto seekStart = std::chrono::steady_clock::now();
+        bool ok = player.seek(game, static_cast<uint32_t>(seekTick));
+        auto seekEnd = std::chrono::steady_clock::now();
+        
+        ReplayKeyframeView keyframe;
+        file.getKeyframe(file.findKeyframe(player.getTick()), keyframe);
+        std::cout << "  seek to " << player.getTick()
+                  << "  from keyframe " << keyframe.tick
+                  << "  resimulated " << player.getTick() - keyframe.tick << " ticks"
+                  << "  in " << std::chrono::duration<double, std::micro>(seekEnd - seekStart).count() << " us" << std::endl;
+        return ok ? 0 : 1;
+    }
+    
+    ReplayPlaybackResult result;
+    bool ok = ReplayPlayer::playHeadless(file, result);
+    
+    std::cout << "  played " << result.ticksPlayed << "/" << file.getTickCount() << " ticks"
+              << "  hashes verified " << result.ticksVerified
+              << "  keyframes verified " << result.keyframesVerified << "/" << file.getKeyframeCount() << std::endl;
+    std::cout << "  " << result.seconds * 1000.0 << " ms  "
+              << static_cast<uint64_t>(result.ticksPerSecond) << " ticks/s  "
+              << result.realtimeFactor << "x realtime" << std::endl;
+    if (result.firstMismatchTick >= 0) {
+        std::cout << "  DESYNC: state differs from the recording at tick " << result.firstMismatchTick << std::endl;
+        for (const std::string& line : result.mismatchDiff) {
+            std::cout << "    " << line << std::endl;
+        }
+    }
+    
+    return ok ? 0 : 1;
+}
+
+// Plays a scripted 4-player match through advanceTick and prints the state hash every
+// ten seconds of match time and at the end. Fixed-point builds must print the same lines
+// whatever the compiler flags; the determinism ctest compares two such builds.
+static int printStateHashes(int seconds, uint64_t seed) {
+    const int playerCount = 4;
+    GameManager game;
+    game.init();
+    game.getGameSettings().mode = GameMode::STOCK;
+    game.getGameSettings().stockCount = 99;
+    game.getGameSettings().seed = static_cast<uint32_t>(seed);
+    for (int i = 0; i < playerCount; i++) {
+        game.addPlayer(static_cast<FighterType>(i % 4), i);
+    }
+    game.startGame();
+    
+    PlayerInput inputs[playerCount];
+    int totalTicks = seconds * SIMULATION_TICK_RATE;
+    uint64_t collisionPairs = 0;
+    for (int tick = 0; tick < totalTicks; tick++) {
+        // Same mix of walking, jumping and attacking as the loopback test
+        for (int i = 0; i < playerCount; i++) {
+            int phase = (tick / 20 + i * 7) % 6;
+            glm::vec2 movement(phase < 2 ? -1.0f : (phase < 4 ? 1.0f : 0.0f), 0.0f);
+            bool jump = (tick + i * 11) % 45 == 0;
+            bool attack = (tick + i * 5) % 30 == 0;
+            inputs[i] = PlayerInput::make(movement, jump, attack, static_cast<AttackType>((tick / 30) % 8));
+        }
+        game.advanceTick(inputs, playerCount);
+        collisionPairs += game.getSimulationCounters().collisionPairsTested;
+        
+        if ((tick + 1) % (10 * SIMULATION_TICK_RATE) == 0 || tick + 1 == totalTicks) {
+            std::cout << "tick " << tick + 1 << "  hash " << std::hex << game.computeStateHash() << std::dec << std::endl;
+        }
+    }
+    
+    // Fighters attack every half second, so a match without a single hitbox test means
+    // attacks never reach the collision check
+    std::cout << "collision pairs tested " << collisionPairs << std::endl;
+    if (collisionPairs == 0) {
+        std::cerr << "state hash: no hitbox was ever tested against a fighter" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// Many matches in one process; match i listens on the base port + i
+static int runHost(const MatchHostConfig& config) {
+    MatchHost host(config);
+    if (!host.start()) {
+        return 1;
+    }
+    
+    while (s_running) {
+        std::this_thread::sleep_for(std::chrono::seconds(5));
+        printHostMetrics(host);
+        host.resetPeakMetrics();
+    }
+    
+    host.stop();
+    return 0;
+}
+
+static void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [--port N] [--max-clients N] [--host-matches N [--threads N]] [--metrics-port N]" << std::endl;
+    std::cout << "       " << program << " --loopback-test CLIENTS SECONDS [--netsim SCRIPT] [--seed N]" << std::endl;
+    std::cout << "       " << program << " --play-replay FILE [--seek TICK]" << std::endl;
+    std::cout << "       " << program << " --perf BASELINE [--perf-throughput FILE] [--perf-replay FILE]... [--perf-json FILE] [--perf-tolerance PCT] [--perf-repeats N] [--perf-update-baseline] [--perf-require-baseline]" << std::endl;
+    std::cout << "       " << program << " --rollback-bench [--rollback-budget US]" << std::endl;
+    std::cout << "       " << program << " --lag-bench" << std::endl;
+    std::cout << "       " << program << " --state-hash SECONDS [--seed N]" << std::endl;
+    std::cout << "SCRIPT is e.g. \"0:latency=60,jitter=8,loss=2;10:loss=15,reorder=5\"" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    ServerConfig config;
+    MatchHostConfig hostConfig;
+    hostConfig.matches = 0;
+    int testClients = 0;
+    int testSeconds = 0;
+    std::string netsim;
+    uint64_t seed = 1;
+    std::string replayPath;
+    int64_t seekTick = -1;
+    PerfConfig perfConfig;
+    int hashSeconds = 0;
+    bool rollbackBench = false;
+    bool lagBench = false;
+    RollbackBenchConfig rollbackConfig;
+    int metricsPort = -1;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            config.port = static_cast<uint16_t>(atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--max-clients") == 0 && i + 1 < argc) {
+            config.maxClients = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--host-matches") == 0 && i + 1 < argc) {
+            hostConfig.matches = std::max(atoi(argv[++i]), 1);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            hostConfig.threads = std::max(atoi(argv[++i]), 0);
+        } else if (strcmp(argv[i], "--loopback-test") == 0 && i + 2 < argc) {
+            testClients = std::max(atoi(argv[i + 1]), 2);
+            testSeconds = std::max(atoi(argv[i + 2]), 1);
+            i += 2;
+        } else if (strcmp(argv[i], "--metrics-port") == 0 && i + 1 < argc) {
+            metricsPort = atoi(argv[++i]);
+            if (metricsPort < 0 || metricsPort > 65535) {
+                std::cerr << "Invalid metrics port: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--netsim") == 0 && i + 1 < argc) {
+            netsim = argv[++i];
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--play-replay") == 0 && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else if (strcmp(argv[i], "--seek") == 0 && i + 1 < argc) {
+            seekTick = std::max(atoll(argv[++i]), 0LL);
+        } else if (strcmp(argv[i], "--perf") == 0 && i + 1 < argc) {
+            perfConfig.baselinePath = argv[++i];
+        } else if (strcmp(argv[i], "--perf-throughput") == 0 && i + 1 < argc) {
+            perfConfig.throughputPath = argv[++i];
+        } else if (strcmp(argv[i], "--perf-replay") == 0 && i + 1 < argc) {
+            perfConfig.replays.push_back(argv[++i]);
+        } else if (strcmp(argv[i], "--perf-json") == 0 && i + 1 < argc) {
+            perfConfig.jsonPath = argv[++i];
+        } else if (strcmp(argv[i], "--perf-tolerance") == 0 && i + 1 < argc) {
+            perfConfig.tolerancePercent = std::max(atof(argv[++i]), 0.0);
+        } else if (strcmp(argv[i], "--perf-repeats") == 0 && i + 1 < argc) {
+            perfConfig.repeats = std::max(atoi(argv[++i]), 1);
+        } else if (strcmp(argv[i], "--perf-update-baseline") == 0) {
+            perfConfig.updateBaseline = true;
+        } else if (strcmp(argv[i], "--perf-require-baseline") == 0) {
+            perfConfig.requireBaseline = true;
+        } else if (strcmp(argv[i], "--state-hash") == 0 && i + 1 < argc) {
+            hashSeconds = std::max(atoi(argv[++i]), 1);
+        } else if (strcmp(argv[i], "--lag-bench") == 0) {
+            lagBench = true;
+        } else if (strcmp(argv[i], "--rollback-bench") == 0) {
+            rollbackBench = true;
+        } else if (strcmp(argv[i], "--rollback-budget") == 0 && i + 1 < argc) {
+            rollbackConfig.budgetMicroseconds = std::max(atof(argv[++i]), 0.0);
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    
+    if (!replayPath.empty()) {
+        return playReplay(replayPath, seekTick);
+    }
+    
+    if (!perfConfig.baselinePath.empty()) {
+        PerfHarness harness(perfConfig);
+        return harness.run() ? 0 : 1;
+    }
+    
+    if (hashSeconds > 0) {
+        return printStateHashes(hashSeconds, seed);
+    }
+    
+    if (rollbackBench) {
+        RollbackBench bench(rollbackConfig);
+        return bench.run() ? 0 : 1;
+    }
+    
+    if (lagBench) {
+        LagBench bench{LagBenchConfig()};
+        return bench.run() ? 0 : 1;
+    }
+    
+    if (testClients > 0) {
+        return runLoopbackTest(testClients, testSeconds, netsim, seed);
+    }
+    
+    signal(SIGINT, handleSignal);
+    signal(SIGTERM, handleSignal);
+    
+    // Scraped over loopback HTTP; declared before the matches so it outlives their shards
+    MetricsExporter metrics;
+    if (metricsPort >= 0 && !metrics.start(static_cast<uint16_t>(metricsPort))) {
+        return 1;
+    }
+    
+    if (hostConfig.matches > 0) {
+        hostConfig.server = config;
+        hostConfig.metrics = metricsPort >= 0 ? &metrics : nullptr;
+        return runHost(hostConfig);
+    }
+    
+    MatchServer server(config);
+    if (metricsPort >= 0) {
+        server.setMetricsShard(metrics.createShard());
+    }
+    if (!server.start()) {
+        return 1;
+    }
+    
+    // Fixed-rate loop. If we fall far behind (e.g. the process was suspended), resync
+    // instead of running a burst of catch-up ticks.
+    const auto tickDuration = std::chrono::microseconds(1000000 / SIMULATION_TICK_RATE);
+    const int METRICS_INTERVAL_TICKS = SIMULATION_TICK_RATE * 5;
+    auto nextTick = std::chrono::steady_clock::now();
+    
+    while (s_running) {
+        server.tick();
+        
+        if (server.getServerTick() % METRICS_INTERVAL_TICKS == 0) {
+            printMetrics(server);
+            server.resetPeakMetrics();
+        }
+        
+        nextTick += tickDuration;
+        auto now = std::chrono::steady_clock::now();
+        if (now - nextTick > tickDuration * 8) {
+            nextTick = now;
+        }
+        std::this_thread::sleep_until(nextTick);
+    }
+    
+    server.stop();
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include "alloc_counter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<uint64_t> s_allocations(0);
+static std::atomic<uint64_t> s_frees(0);
+static std::atomic<uint64_t> s_bytes(0);
+
+AllocationCounts AllocationCounter::get() {
+    AllocationCounts counts;
+    counts.allocations = s_allocations.load(std::memory_order_relaxed);
+    counts.frees = s_frees.load(std::memory_order_relaxed);
+    counts.bytes = s_bytes.load(std::memory_order_relaxed);
+    return counts;
+}
+
+static void* countedAllocate(size_t size) {
+    s_allocations.fetch_add(1, std::memory_order_relaxed);
+    s_bytes.fetch_add(size, std::memory_order_relaxed);
+    return malloc(size ? size : 1);
+}
+
+static void* countedAllocateAligned(size_t size, std::align_val_t alignment) {
+    s_allocations.fetch_add(1, std::memory_order_relaxed);
+    s_bytes.fetch_add(size, std::memory_order_relaxed);
+    
+    // aligned_alloc wants a size that's a multiple of the alignment
+    size_t align = static_cast<size_t>(alignment);
+    return aligned_alloc(align, ((size ? size : 1) + align - 1) / align * align);
+}
+
+static void countedFree(void* pointer) {
+    if (pointer) {
+        s_frees.fetch_add(1, std::memory_order_relaxed);
+        free(pointer);
+    }
+}
+
+void* operator new(size_t size) {
+    void* pointer = countedAllocate(size);
+    if (!pointer) throw std::bad_alloc();
+    return pointer;
+}
+
+void* operator new[](size_t size) {
+    void* pointer = countedAllocate(size);
+    if (!pointer) throw std::bad_alloc();
+    return pointer;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return countedAllocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return countedAllocate(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    void* pointer = countedAllocateAligned(size, alignment);
+    if (!pointer) throw std::bad_alloc();
+    return pointer;
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    void* pointer = countedAllocateAligned(size, alignment);
+    if (!pointer) throw std::bad_alloc();
+    return pointer;
+}
+
+void operator delete(void* pointer) noexcept { countedFree(pointer); }
+void operator delete[](void* pointer) noexcept { countedFree(pointer); }
+void operator delete(void* pointer, size_t) noexcept { countedFree(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { countedFree(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { countedFree(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { countedFree(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { countedFree(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { countedFree(pointer); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { countedFree(pointer); }
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept { countedFree(pointer); }
@@ -0,0 +1,23 @@
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <cstdint>
+
+struct AllocationCounts {
+    uint64_t allocations;
+    uint64_t frees;
+    uint64_t bytes;  // Requested bytes, not what the allocator rounded up to
+};
+
+// Counts heap allocations made anywhere in the process. alloc_counter.cpp replaces the
+// global operator new and delete with versions that bump relaxed atomics and call
+// malloc, so counting costs a couple of atomic increments per allocation. The counters
+// are shared by every thread, so threads allocating at once (MatchHost workers) contend
+// on them; the simulation allocates rarely enough per tick for that not to matter.
+// Allocations made with malloc directly (SDL, the driver) aren't seen.
+class AllocationCounter {
+public:
+    static AllocationCounts get();
+};
+
+#endif
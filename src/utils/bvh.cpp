@@ -0,0 +1,403 @@
+#include "bvh.h"
+#include <algorithm>
+#include <cfloat>
+
+BVH::BVH() {
+}
+
+void BVH::clear() {
+    m_nodes.clear();
+    m_primitiveIndices.clear();
+    m_primitives.clear();
+    m_centroids.clear();
+}
+
+void BVH::build(const std::vector<AABB>& primitives) {
+    clear();
+    if (primitives.empty()) {
+        return;
+    }
+    
+    m_primitives = primitives;
+    m_primitiveIndices.resize(primitives.size());
+    m_centroids.resize(primitives.size());
+    for (size_t i = 0; i < primitives.size(); i++) {
+        m_primitiveIndices[i] = static_cast<uint32_t>(i);
+        m_centroids[i] = primitives[i].center();
+    }
+    
+    // A binary tree over N leaves never needs more than 2N - 1 nodes
+    m_nodes.reserve(primitives.size() * 2);
+    
+    Node root;
+    root.leftFirst = 0;
+    root.primitiveCount = static_cast<uint32_t>(primitives.size());
+    m_nodes.push_back(root);
+    updateNodeBounds(0);
+    
+    // Iterative subdivision so deep trees can't overflow the call stack
+    std::vector<std::pair<uint32_t, int>> pending;
+    pending.push_back(std::make_pair(0u, 0));
+    while (!pending.empty()) {
+        uint32_t nodeIndex = pending.back().first;
+        int depth = pending.back().second;
+        pending.pop_back();
+        
+        if (depth >= MAX_DEPTH) {
+            continue;
+        }
+        
+        subdivide(nodeIndex);
+        if (m_nodes[nodeIndex].primitiveCount == 0) {
+            uint32_t left = m_nodes[nodeIndex].leftFirst;
+            pending.push_back(std::make_pair(left, depth + 1));
+            pending.push_back(std::make_pair(left + 1, depth + 1));
+        }
+    }
+    
+    // The centroids are only needed while building
+    m_centroids.clear();
+    m_centroids.shrink_to_fit();
+}
+
+void BVH::updateNodeBounds(uint32_t nodeIndex) {
+    Node& node = m_nodes[nodeIndex];
+    AABB bounds;
+    for (uint32_t i = 0; i < node.primitiveCount; i++) {
+        bounds.expand(m_primitives[m_primitiveIndices[node.leftFirst + i]]);
+    }
+    node.boundsMin = bounds.min;
+    node.boundsMax = bounds.max;
+}
+
+float BVH::findBestSplit(const Node& node, int& axis, float& splitPosition) const {
+    float bestCost = FLT_MAX;
+    
+    AABB centroidBounds;
+    for (uint32_t i = 0; i < node.primitiveCount; i++) {
+        centroidBounds.expand(m_centroids[m_primitiveIndices[node.leftFirst + i]]);
+    }
+    
+    for (int a = 0; a < 3; a++) {
+        float boundsMin = centroidBounds.min[a];
+        float boundsMax = centroidBounds.max[a];
+        if (boundsMin == boundsMax) {
+            continue;
+        }
+        
+        // Bin primitives by centroid
+        AABB binBounds[SAH_BINS];
+        int binCount[SAH_BINS] = {0};
+        float scale = SAH_BINS / (boundsMax - boundsMin);
+        for (uint32_t i = 0; i < node.primitiveCount; i++) {
+            uint32_t primitive = m_primitiveIndices[node.leftFirst + i];
+            int bin = std::min(SAH_BINS - 1, static_cast<int>((m_centroids[primitive][a] - boundsMin) * scale));
+            binCount[bin]++;
+            binBounds[bin].expand(m_primitives[primitive]);
+        }
+        
+        // Sweep from both sides to get the area and count on each side of every plane
+        float leftArea[SAH_BINS - 1], rightArea[SAH_BINS - 1];
+        int leftCount[SAH_BINS - 1], rightCount[SAH_BINS - 1];
+        AABB leftBox, rightBox;
+        int leftSum = 0, rightSum = 0;
+        for (int i = 0; i < SAH_BINS - 1; i++) {
+            leftSum += binCount[i];
+            leftCount[i] = leftSum;
+            leftBox.expand(binBounds[i]);
+            leftArea[i] = leftSum > 0 ? leftBox.halfArea() : 0.0f;
+            
+            rightSum += binCount[SAH_BINS - 1 - i];
+            rightCount[SAH_BINS - 2 - i] = rightSum;
+            rightBox.expand(binBounds[SAH_BINS - 1 - i]);
+            rightArea[SAH_BINS - 2 - i] = rightSum > 0 ? rightBox.halfArea() : 0.0f;
+        }
+        
+        float binWidth = (boundsMax - boundsMin) / SAH_BINS;
+        for (int i = 0; i < SAH_BINS - 1; i++) {
+            float cost = leftCount[i] * leftArea[i] + rightCount[i] * rightArea[i];
+            if (cost > 0.0f && cost < bestCost) {
+                bestCost = cost;
+                axis = a;
+                splitPosition = boundsMin + binWidth * (i + 1);
+            }
+        }
+    }
+    
+    return bestCost;
+}
+
+void BVH::subdivide(uint32_t nodeIndex) {
+    Node& node = m_nodes[nodeIndex];
+    if (node.primitiveCount <= MAX_LEAF_SIZE) {
+        return;
+    }
+    
+    int axis = -1;
+    float splitPosition = 0.0f;
+    float splitCost = findBestSplit(node, axis, splitPosition);
+    
+    // Only split if it beats intersecting every primitive in this node
+    AABB nodeBounds(node.boundsMin, node.boundsMax);
+    float leafCost = node.primitiveCount * nodeBounds.halfArea();
+    if (axis < 0 || splitCost >= leafCost) {
+        return;
+    }
+    
+    // Partition primitive indices around the split plane
+    int i = static_cast<int>(node.leftFirst);
+    int j = i + static_cast<int>(node.primitiveCount) - 1;
+    while (i <= j) {
+        if (m_centroids[m_primitiveIndices[i]][axis] < splitPosition) {
+            i++;
+        } else {
+            std::swap(m_primitiveIndices[i], m_primitiveIndices[j]);
+            j--;
+        }
+    }
+    
+    uint32_t leftCount = static_cast<uint32_t>(i) - node.leftFirst;
+    if (leftCount == 0 || leftCount == node.primitiveCount) {
+        return;
+    }
+    
+    uint32_t leftChild = static_cast<uint32_t>(m_nodes.size());
+    
+    Node left;
+    left.leftFirst = node.leftFirst;
+    left.primitiveCount = leftCount;
+    
+    Node right;
+    right.leftFirst = static_cast<uint32_t>(i);
+    right.primitiveCount = node.primitiveCount - leftCount;
+    
+    // push_back may reallocate, so don't use the node reference past this point
+    m_nodes[nodeIndex].leftFirst = leftChild;
+    m_nodes[nodeIndex].primitiveCount = 0;
+    m_nodes.push_back(left);
+    m_nodes.push_back(right);
+    
+    updateNodeBounds(leftChild);
+    updateNodeBounds(leftChild + 1);
+}
+
+bool BVH::intersectPrimitive(uint32_t primitive, const Ray& ray, const glm::vec3& inverseDirection,
+                             float maxDistance, RayHit& hit) const {
+    const AABB& box = m_primitives[primitive];
+    float t;
+    glm::vec3 normal;
+    if (!intersectRayAABB(ray.origin, inverseDirection, maxDistance, box.min, box.max, t, normal)) {
+        return false;
+    }
+    
+    hit.hit = true;
+    hit.distance = t;
+    hit.primitive = static_cast<int>(primitive);
+    hit.point = ray.origin + ray.direction * t;
+    hit.normal = normal;
+    return true;
+}
+
+bool BVH::raycast(const Ray& ray, RayHit& hit) const {
+    hit = RayHit();
+    if (m_nodes.empty()) {
+        return false;
+    }
+    
+    glm::vec3 inverseDirection = safeInverse(ray.direction);
+    float closest = ray.maxDistance;
+    
+    uint32_t stack[MAX_DEPTH * 2];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+    
+    while (stackSize > 0) {
+        const Node& node = m_nodes[stack[--stackSize]];
+        
+        float tNode;
+        if (!intersectRayAABB(ray.origin, inverseDirection, closest, node.boundsMin, node.boundsMax, tNode)) {
+            continue;
+        }
+        
+        if (node.primitiveCount > 0) {
+            for (uint32_t i = 0; i < node.primitiveCount; i++) {
+                RayHit candidate;
+                if (intersectPrimitive(m_primitiveIndices[node.leftFirst + i], ray, inverseDirection, closest, candidate)) {
+                    closest = candidate.distance;
+                    hit = candidate;
+                }
+            }
+            continue;
+        }
+        
+        // Visit the nearer child first so the far one is more likely to be culled
+        uint32_t nearChild = node.leftFirst;
+        uint32_t farChild = node.leftFirst + 1;
+        const Node& left = m_nodes[nearChild];
+        const Node& right = m_nodes[farChild];
+        float tLeft = FLT_MAX, tRight = FLT_MAX;
+        bool hitLeft = intersectRayAABB(ray.origin, inverseDirection, closest, left.boundsMin, left.boundsMax, tLeft);
+        bool hitRight = intersectRayAABB(ray.origin, inverseDirection, closest, right.boundsMin, right.boundsMax, tRight);
+        if (hitLeft && hitRight && tRight < tLeft) {
+            std::swap(nearChild, farChild);
+        }
+        if (hitLeft && hitRight) {
+            stack[stackSize++] = farChild;
+            stack[stackSize++] = nearChild;
+        } else if (hitLeft) {
+            stack[stackSize++] = node.leftFirst;
+        } else if (hitRight) {
+            stack[stackSize++] = node.leftFirst + 1;
+        }
+    }
+    
+    return hit.hit;
+}
+
+bool BVH::occluded(const Ray& ray) const {
+    if (m_nodes.empty()) {
+        return false;
+    }
+    
+    glm::vec3 inverseDirection = safeInverse(ray.direction);
+    
+    uint32_t stack[MAX_DEPTH * 2];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+    
+    while (stackSize > 0) {
+        const Node& node = m_nodes[stack[--stackSize]];
+        
+        float tNode;
+        if (!intersectRayAABB(ray.origin, inverseDirection, ray.maxDistance, node.boundsMin, node.boundsMax, tNode)) {
+            continue;
+        }
+        
+        if (node.primitiveCount > 0) {
+            for (uint32_t i = 0; i < node.primitiveCount; i++) {
+                const AABB& box = m_primitives[m_primitiveIndices[node.leftFirst + i]];
+                float t;
+                if (intersectRayAABB(ray.origin, inverseDirection, ray.maxDistance, box.min, box.max, t)) {
+                    return true;
+                }
+            }
+            continue;
+        }
+        
+        stack[stackSize++] = node.leftFirst;
+        stack[stackSize++] = node.leftFirst + 1;
+    }
+    
+    return false;
+}
+
+void BVH::queryOverlaps(const AABB& box, std::vector<int>& results) const {
+    if (m_nodes.empty()) {
+        return;
+    }
+    
+    uint32_t stack[MAX_DEPTH * 2];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+    
+    while (stackSize > 0) {
+        const Node& node = m_nodes[stack[--stackSize]];
+        if (!box.overlaps(AABB(node.boundsMin, node.boundsMax))) {
+            continue;
+        }
+        
+        if (node.primitiveCount > 0) {
+            for (uint32_t i = 0; i < node.primitiveCount; i++) {
+                uint32_t primitive = m_primitiveIndices[node.leftFirst + i];
+                if (box.overlaps(m_primitives[primitive])) {
+                    results.push_back(static_cast<int>(primitive));
+                }
+            }
+            continue;
+        }
+        
+        stack[stackSize++] = node.leftFirst;
+        stack[stackSize++] = node.leftFirst + 1;
+    }
+}
+
+void BVH::raycastBatch(const Ray* rays, RayHit* hits, size_t count) const {
+    for (size_t first = 0; first < count; first += PACKET_SIZE) {
+        int packetCount = static_cast<int>(std::min<size_t>(PACKET_SIZE, count - first));
+        tracePacket(rays + first, hits + first, packetCount);
+    }
+}
+
+void BVH::tracePacket(const Ray* rays, RayHit* hits, int count) const {
+    glm::vec3 inverseDirections[PACKET_SIZE];
+    float closest[PACKET_SIZE];
+    for (int r = 0; r < count; r++) {
+        hits[r] = RayHit();
+        inverseDirections[r] = safeInverse(rays[r].direction);
+        closest[r] = rays[r].maxDistance;
+    }
+    
+    if (m_nodes.empty()) {
+        return;
+    }
+    
+    // The whole packet walks the tree together; a node is entered if any ray in the
+    // packet still hits it, and only those rays are tested against its contents
+    uint32_t stack[MAX_DEPTH * 2];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+    
+    while (stackSize > 0) {
+        const Node& node = m_nodes[stack[--stackSize]];
+        
+        uint32_t activeMask = 0;
+        float nearest = FLT_MAX;
+        int nearestRay = 0;
+        for (int r = 0; r < count; r++) {
+            float tNode;
+            if (intersectRayAABB(rays[r].origin, inverseDirections[r], closest[r], node.boundsMin, node.boundsMax, tNode)) {
+                activeMask |= 1u << r;
+                if (tNode < nearest) {
+                    nearest = tNode;
+                    nearestRay = r;
+                }
+            }
+        }
+        
+        if (activeMask == 0) {
+            continue;
+        }
+        
+        if (node.primitiveCount > 0) {
+            for (uint32_t i = 0; i < node.primitiveCount; i++) {
+                uint32_t primitive = m_primitiveIndices[node.leftFirst + i];
+                for (int r = 0; r < count; r++) {
+                    if (!(activeMask & (1u << r))) {
+                        continue;
+                    }
+                    RayHit candidate;
+                    if (intersectPrimitive(primitive, rays[r], inverseDirections[r], closest[r], candidate)) {
+                        closest[r] = candidate.distance;
+                        hits[r] = candidate;
+                    }
+                }
+            }
+            continue;
+        }
+        
+        // Order children by the ray that reached this node first
+        uint32_t nearChild = node.leftFirst;
+        uint32_t farChild = node.leftFirst + 1;
+        const Node& left = m_nodes[nearChild];
+        const Node& right = m_nodes[farChild];
+        const Ray& lead = rays[nearestRay];
+        float tLeft = FLT_MAX, tRight = FLT_MAX;
+        intersectRayAABB(lead.origin, inverseDirections[nearestRay], FLT_MAX, left.boundsMin, left.boundsMax, tLeft);
+        intersectRayAABB(lead.origin, inverseDirections[nearestRay], FLT_MAX, right.boundsMin, right.boundsMax, tRight);
+        if (tRight < tLeft) {
+            std::swap(nearChild, farChild);
+        }
+        stack[stackSize++] = farChild;
+        stack[stackSize++] = nearChild;
+    }
+}
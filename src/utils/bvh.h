@@ -0,0 +1,63 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "math_utils.h"
+
+// Bounding volume hierarchy over a set of axis-aligned boxes. Built with a binned
+// surface area heuristic and stored as a flat node array; children of a node are
+// always adjacent, so an interior node only needs the index of its left child.
+class BVH {
+public:
+    // Rays traced together by raycastBatch share one traversal
+    static const int PACKET_SIZE = 8;
+    
+    BVH();
+    
+    void build(const std::vector<AABB>& primitives);
+    void clear();
+    
+    bool empty() const { return m_nodes.empty(); }
+    int getNodeCount() const { return static_cast<int>(m_nodes.size()); }
+    
+    // Closest hit along the ray, up to ray.maxDistance
+    bool raycast(const Ray& ray, RayHit& hit) const;
+    
+    // True if anything blocks the ray; stops at the first hit found
+    bool occluded(const Ray& ray) const;
+    
+    // Traces many rays at once, walking the tree once per packet of PACKET_SIZE rays
+    void raycastBatch(const Ray* rays, RayHit* hits, size_t count) const;
+    
+    // Appends the index of every primitive whose box overlaps the query box
+    void queryOverlaps(const AABB& box, std::vector<int>& results) const;
+    
+private:
+    struct Node {
+        glm::vec3 boundsMin;
+        uint32_t leftFirst;       // Left child index, or first primitive for leaves
+        glm::vec3 boundsMax;
+        uint32_t primitiveCount;  // Zero for interior nodes
+    };
+    
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_primitiveIndices;
+    std::vector<AABB> m_primitives;
+    std::vector<glm::vec3> m_centroids;
+    
+    static const int SAH_BINS = 12;
+    static const int MAX_LEAF_SIZE = 2;
+    static const int MAX_DEPTH = 64;
+    
+    void updateNodeBounds(uint32_t nodeIndex);
+    void subdivide(uint32_t nodeIndex);
+    float findBestSplit(const Node& node, int& axis, float& splitPosition) const;
+    
+    void tracePacket(const Ray* rays, RayHit* hits, int count) const;
+    bool intersectPrimitive(uint32_t primitive, const Ray& ray, const glm::vec3& inverseDirection,
+                            float maxDistance, RayHit& hit) const;
+};
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <cstddef>
+#include <cstdint>
+
+// xxHash64 (XXH64). Fast non-cryptographic hash used to compare simulation states
+// between peers and replays; output matches the reference implementation.
+uint64_t hash64(const void* data, size_t size, uint64_t seed = 0);
+
+#endif
@@ -0,0 +1,81 @@
+#include "hdr_histogram.h"
+#include <algorithm>
+#include <cmath>
+
+HdrHistogram::HdrHistogram(uint64_t maxValue)
+    : m_buckets(bucketIndex(maxValue) + 1, 0)
+    , m_maxValue(maxValue)
+    , m_count(0)
+    , m_total(0)
+    , m_min(UINT64_MAX)
+    , m_max(0)
+{
+}
+
+// Values below SUB_BUCKET_COUNT get a bucket each. Above that, a value is kept to its top
+// SUB_BUCKET_BITS bits; the shift that takes and the remaining bits pick the bucket.
+int HdrHistogram::bucketIndex(uint64_t value) {
+    if (value < SUB_BUCKET_COUNT) {
+        return static_cast<int>(value);
+    }
+    int bits = 64 - __builtin_clzll(value);
+    int shift = bits - SUB_BUCKET_BITS;
+    int subBucket = static_cast<int>(value >> shift) - SUB_BUCKET_HALF;
+    return SUB_BUCKET_COUNT + (shift - 1) * SUB_BUCKET_HALF + subBucket;
+}
+
+uint64_t HdrHistogram::bucketHighest(int index) {
+    if (index < SUB_BUCKET_COUNT) {
+        return static_cast<uint64_t>(index);
+    }
+    int shift = (index - SUB_BUCKET_COUNT) / SUB_BUCKET_HALF + 1;
+    uint64_t subBucket = static_cast<uint64_t>((index - SUB_BUCKET_COUNT) % SUB_BUCKET_HALF + SUB_BUCKET_HALF);
+    return ((subBucket + 1) << shift) - 1;
+}
+
+void HdrHistogram::record(uint64_t value) {
+    value = std::min(value, m_maxValue);
+    m_buckets[bucketIndex(value)]++;
+    m_count++;
+    m_total += value;
+    m_min = std::min(m_min, value);
+    m_max = std::max(m_max, value);
+}
+
+void HdrHistogram::reset() {
+    std::fill(m_buckets.begin(), m_buckets.end(), 0);
+    m_count = 0;
+    m_total = 0;
+    m_min = UINT64_MAX;
+    m_max = 0;
+}
+
+void HdrHistogram::add(const HdrHistogram& other) {
+    size_t count = std::min(m_buckets.size(), other.m_buckets.size());
+    for (size_t i = 0; i < count; i++) {
+        m_buckets[i] += other.m_buckets[i];
+    }
+    m_count += other.m_count;
+    m_total += other.m_total;
+    m_min = std::min(m_min, other.m_min);
+    m_max = std::max(m_max, other.m_max);
+}
+
+uint64_t HdrHistogram::getPercentile(double percentile) const {
+    if (m_count == 0) {
+        return 0;
+    }
+    
+    // Rank of the sample at this percentile, 1-based
+    uint64_t rank = static_cast<uint64_t>(std::ceil(percentile / 100.0 * m_count));
+    rank = std::min(std::max<uint64_t>(rank, 1), m_count);
+    
+    uint64_t seen = 0;
+    for (size_t i = 0; i < m_buckets.size(); i++) {
+        seen += m_buckets[i];
+        if (seen >= rank) {
+            return std::min(bucketHighest(static_cast<int>(i)), m_max);
+        }
+    }
+    return m_max;
+}
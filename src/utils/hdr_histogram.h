@@ -0,0 +1,46 @@
+#ifndef HDR_HISTOGRAM_H
+#define HDR_HISTOGRAM_H
+
+#include <vector>
+#include <cstdint>
+
+// High-dynamic-range histogram of integer values (microseconds, say). Buckets are
+// log-linear: every power-of-two range is split into 128 equal sub-buckets, so any value
+// up to the maximum is stored to within 1% of itself while the bucket count stays in the
+// low thousands. Values above the maximum are clamped to it.
+class HdrHistogram {
+public:
+    HdrHistogram(uint64_t maxValue);
+    
+    void record(uint64_t value);
+    void reset();
+    
+    // Adds another histogram's samples; both must have the same maximum
+    void add(const HdrHistogram& other);
+    
+    uint64_t getCount() const { return m_count; }
+    uint64_t getMin() const { return m_count ? m_min : 0; }
+    uint64_t getMax() const { return m_max; }
+    double getMean() const { return m_count ? static_cast<double>(m_total) / m_count : 0.0; }
+    
+    // Highest value that falls in the same bucket as the given percentile (0-100),
+    // capped at the exact maximum
+    uint64_t getPercentile(double percentile) const;
+    
+private:
+    static constexpr int SUB_BUCKET_BITS = 8;
+    static constexpr int SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+    static constexpr int SUB_BUCKET_HALF = SUB_BUCKET_COUNT / 2;
+    
+    std::vector<uint64_t> m_buckets;
+    uint64_t m_maxValue;
+    uint64_t m_count;
+    uint64_t m_total;
+    uint64_t m_min;
+    uint64_t m_max;
+    
+    static int bucketIndex(uint64_t value);
+    static uint64_t bucketHighest(int index);
+};
+
+#endif
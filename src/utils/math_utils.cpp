@@ -0,0 +1,142 @@
+#include "math_utils.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+glm::vec3 safeInverse(const glm::vec3& direction) {
+    const float LARGE = 1e30f;
+    return glm::vec3(
+        std::abs(direction.x) > 1e-12f ? 1.0f / direction.x : (direction.x < 0.0f ? -LARGE : LARGE),
+        std::abs(direction.y) > 1e-12f ? 1.0f / direction.y : (direction.y < 0.0f ? -LARGE : LARGE),
+        std::abs(direction.z) > 1e-12f ? 1.0f / direction.z : (direction.z < 0.0f ? -LARGE : LARGE)
+    );
+}
+
+bool intersectRayAABB(const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance,
+                      const glm::vec3& boxMin, const glm::vec3& boxMax, float& tNear) {
+    float tx1 = (boxMin.x - origin.x) * inverseDirection.x;
+    float tx2 = (boxMax.x - origin.x) * inverseDirection.x;
+    float tMin = std::min(tx1, tx2);
+    float tMax = std::max(tx1, tx2);
+    
+    float ty1 = (boxMin.y - origin.y) * inverseDirection.y;
+    float ty2 = (boxMax.y - origin.y) * inverseDirection.y;
+    tMin = std::max(tMin, std::min(ty1, ty2));
+    tMax = std::min(tMax, std::max(ty1, ty2));
+    
+    float tz1 = (boxMin.z - origin.z) * inverseDirection.z;
+    float tz2 = (boxMax.z - origin.z) * inverseDirection.z;
+    tMin = std::max(tMin, std::min(tz1, tz2));
+    tMax = std::min(tMax, std::max(tz1, tz2));
+    
+    if (tMax < tMin || tMax < 0.0f || tMin > maxDistance) {
+        return false;
+    }
+    
+    tNear = std::max(tMin, 0.0f);
+    return true;
+}
+
+bool intersectRayAABB(const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance,
+                      const glm::vec3& boxMin, const glm::vec3& boxMax, float& tNear, glm::vec3& normal) {
+    float tMin = -FLT_MAX;
+    float tMax = FLT_MAX;
+    int enterAxis = -1;
+    float enterSide = 0.0f;
+    
+    for (int axis = 0; axis < 3; axis++) {
+        float t1 = (boxMin[axis] - origin[axis]) * inverseDirection[axis];
+        float t2 = (boxMax[axis] - origin[axis]) * inverseDirection[axis];
+        float side = -1.0f;
+        if (t1 > t2) {
+            std::swap(t1, t2);
+            side = 1.0f;
+        }
+        
+        if (t1 > tMin) {
+            tMin = t1;
+            enterAxis = axis;
+            enterSide = side;
+        }
+        tMax = std::min(tMax, t2);
+    }
+    
+    if (tMax < tMin || tMax < 0.0f || tMin > maxDistance) {
+        return false;
+    }
+    
+    tNear = std::max(tMin, 0.0f);
+    normal = glm::vec3(0.0f);
+    if (enterAxis >= 0 && tMin >= 0.0f) {
+        normal[enterAxis] = enterSide;
+    }
+    return true;
+}
+
+bool intersectRaySphere(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+                        const glm::vec3& center, float radius, float& t) {
+    glm::vec3 offset = origin - center;
+    float b = glm::dot(offset, direction);
+    float c = glm::dot(offset, offset) - radius * radius;
+    if (c <= 0.0f) {
+        t = 0.0f;
+        return true;
+    }
+    
+    float discriminant = b * b - c;
+    if (b > 0.0f || discriminant < 0.0f) {
+        return false;
+    }
+    
+    t = -b - std::sqrt(discriminant);
+    return t <= maxDistance;
+}
+
+bool intersectRayCapsule(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+                         const glm::vec3& a, const glm::vec3& b, float radius, float& t) {
+    glm::vec3 axis = b - a;
+    glm::vec3 offset = origin - a;
+    float axisLengthSq = glm::dot(axis, axis);
+    float axisDotDir = glm::dot(axis, direction);
+    float axisDotOffset = glm::dot(axis, offset);
+    
+    // Origin inside the capsule
+    float along = axisLengthSq > 0.0f ? std::min(std::max(axisDotOffset / axisLengthSq, 0.0f), 1.0f) : 0.0f;
+    glm::vec3 closest = a + axis * along;
+    if (glm::dot(origin - closest, origin - closest) <= radius * radius) {
+        t = 0.0f;
+        return true;
+    }
+    
+    // Infinite cylinder, accepted only where the hit lies between the end caps.
+    // Skipped for rays parallel to the axis, which can only enter through a cap.
+    float best = FLT_MAX;
+    float qa = axisLengthSq - axisDotDir * axisDotDir;
+    if (qa > 1e-8f * axisLengthSq) {
+        float qb = axisLengthSq * glm::dot(offset, direction) - axisDotOffset * axisDotDir;
+        float qc = axisLengthSq * glm::dot(offset, offset) - axisDotOffset * axisDotOffset - radius * radius * axisLengthSq;
+        float discriminant = qb * qb - qa * qc;
+        if (discriminant >= 0.0f) {
+            float tCylinder = (-qb - std::sqrt(discriminant)) / qa;
+            float y = axisDotOffset + tCylinder * axisDotDir;
+            if (tCylinder >= 0.0f && y >= 0.0f && y <= axisLengthSq) {
+                best = tCylinder;
+            }
+        }
+    }
+    
+    float tCap;
+    if (intersectRaySphere(origin, direction, maxDistance, a, radius, tCap)) {
+        best = std::min(best, tCap);
+    }
+    if (intersectRaySphere(origin, direction, maxDistance, b, radius, tCap)) {
+        best = std::min(best, tCap);
+    }
+    
+    if (best > maxDistance) {
+        return false;
+    }
+    
+    t = best;
+    return true;
+}
@@ -0,0 +1,76 @@
+#ifndef MATH_UTILS_H
+#define MATH_UTILS_H
+
+#include <glm/glm.hpp>
+#include <cfloat>
+
+// Axis-aligned bounding box
+struct AABB {
+    glm::vec3 min;
+    glm::vec3 max;
+    
+    AABB() : min(FLT_MAX), max(-FLT_MAX) {}
+    AABB(const glm::vec3& min, const glm::vec3& max) : min(min), max(max) {}
+    
+    void expand(const glm::vec3& point) {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+    
+    void expand(const AABB& other) {
+        min = glm::min(min, other.min);
+        max = glm::max(max, other.max);
+    }
+    
+    glm::vec3 center() const { return (min + max) * 0.5f; }
+    glm::vec3 extent() const { return max - min; }
+    
+    bool overlaps(const AABB& other) const {
+        return min.x <= other.max.x && max.x >= other.min.x &&
+               min.y <= other.max.y && max.y >= other.min.y &&
+               min.z <= other.max.z && max.z >= other.min.z;
+    }
+    
+    // Half the surface area, which is all the SAH cost needs
+    float halfArea() const {
+        glm::vec3 e = extent();
+        return e.x * e.y + e.y * e.z + e.z * e.x;
+    }
+};
+
+// Ray with a maximum travel distance; direction is expected to be normalized
+struct Ray {
+    glm::vec3 origin;
+    glm::vec3 direction;
+    float maxDistance;
+};
+
+struct RayHit {
+    bool hit = false;
+    float distance = FLT_MAX;
+    int primitive = -1;
+    glm::vec3 point = glm::vec3(0.0f);
+    glm::vec3 normal = glm::vec3(0.0f);
+};
+
+// Reciprocal of a direction, with zero components mapped to a large value so slab
+// tests don't divide by zero
+glm::vec3 safeInverse(const glm::vec3& direction);
+
+// Slab test; returns the entry distance in tNear (clamped to 0 if the origin is inside)
+bool intersectRayAABB(const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance,
+                      const glm::vec3& boxMin, const glm::vec3& boxMax, float& tNear);
+
+// Like intersectRayAABB but also reports which face was entered
+bool intersectRayAABB(const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance,
+                      const glm::vec3& boxMin, const glm::vec3& boxMax, float& tNear, glm::vec3& normal);
+
+// Entry distance into a sphere; 0 if the origin is already inside
+bool intersectRaySphere(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+                        const glm::vec3& center, float radius, float& t);
+
+// Entry distance into the capsule around segment a-b; 0 if the origin is already inside
+bool intersectRayCapsule(const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+                         const glm::vec3& a, const glm::vec3& b, float radius, float& t);
+
+#endif
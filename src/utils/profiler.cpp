@@ -0,0 +1,81 @@
+#include "profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+std::atomic<bool> Profiler::m_capturing(false);
+std::mutex Profiler::m_mutex;
+std::vector<TraceEvent> Profiler::m_events;
+uint64_t Profiler::m_droppedEvents = 0;
+
+void Profiler::beginCapture() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_events.clear();
+    m_droppedEvents = 0;
+    m_capturing = true;
+}
+
+uint64_t Profiler::getTimeMicroseconds() {
+    // Never 0, which ProfileZone uses for "not timing"
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count()) + 1;
+}
+
+uint32_t Profiler::getThreadTrack() {
+    static std::atomic<uint32_t> nextTrack(1);
+    thread_local uint32_t track = nextTrack.fetch_add(1);
+    return track;
+}
+
+void Profiler::record(const char* name, const char* category, uint64_t startMicroseconds, uint64_t durationMicroseconds, uint32_t track) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_capturing) {
+        return;
+    }
+    if (m_events.size() >= MAX_EVENTS) {
+        m_droppedEvents++;
+        return;
+    }
+    m_events.push_back({name, category, startMicroseconds, durationMicroseconds, track});
+}
+
+bool Profiler::endCapture(const std::string& path) {
+    std::vector<TraceEvent> events;
+    uint64_t dropped;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_capturing = false;
+        events.swap(m_events);
+        dropped = m_droppedEvents;
+    }
+    
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Failed to write trace to " << path << std::endl;
+        return false;
+    }
+    
+    // Timestamps relative to the first event keep the numbers short
+    uint64_t origin = UINT64_MAX;
+    for (const TraceEvent& event : events) {
+        origin = std::min(origin, event.startMicroseconds);
+    }
+    
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    out << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << GPU_TRACK << ", \"args\": {\"name\": \"GPU\"}}";
+    for (const TraceEvent& event : events) {
+        // Names are string literals from our own code, so there's nothing to escape
+        out << ",\n{\"name\": \"" << event.name << "\", \"cat\": \"" << event.category
+            << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << event.track
+            << ", \"ts\": " << event.startMicroseconds - origin
+            << ", \"dur\": " << event.durationMicroseconds << "}";
+    }
+    out << "\n]}\n";
+    
+    if (dropped > 0) {
+        std::cerr << "Trace full, dropped " << dropped << " events" << std::endl;
+    }
+    std::cout << "Wrote " << events.size() << " trace events to " << path << std::endl;
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,68 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// One timed span on a track (a thread, or the GPU)
+struct TraceEvent {
+    const char* name;       // String literals only; they're kept by pointer
+    const char* category;
+    uint64_t startMicroseconds;
+    uint64_t durationMicroseconds;
+    uint32_t track;
+};
+
+// Collects timed zones from any thread while a capture is running and writes them as a
+// Chrome trace (chrome://tracing, Perfetto). Outside a capture a zone costs two relaxed
+// atomic loads, one when it opens and one when it closes.
+class Profiler {
+public:
+    static constexpr uint32_t GPU_TRACK = 1000;
+    
+    static void beginCapture();
+    // Stops capturing and writes everything recorded since beginCapture
+    static bool endCapture(const std::string& path);
+    static bool isCapturing() { return m_capturing.load(std::memory_order_relaxed); }
+    
+    static uint64_t getTimeMicroseconds();
+    static void record(const char* name, const char* category, uint64_t startMicroseconds, uint64_t durationMicroseconds, uint32_t track);
+    
+    // Small stable id for the calling thread, used as its track
+    static uint32_t getThreadTrack();
+    
+private:
+    // About 40 MB; events past this are counted and dropped
+    static constexpr size_t MAX_EVENTS = 1 << 20;
+    
+    static std::atomic<bool> m_capturing;
+    static std::mutex m_mutex;
+    static std::vector<TraceEvent> m_events;
+    static uint64_t m_droppedEvents;
+};
+
+// Times the enclosing scope on the calling thread's track
+class ProfileZone {
+public:
+    ProfileZone(const char* name, const char* category = "cpu")
+        : m_name(name), m_category(category), m_start(Profiler::isCapturing() ? Profiler::getTimeMicroseconds() : 0) {}
+    
+    ~ProfileZone() {
+        if (m_start != 0 && Profiler::isCapturing()) {
+            Profiler::record(m_name, m_category, m_start, Profiler::getTimeMicroseconds() - m_start, Profiler::getThreadTrack());
+        }
+    }
+    
+private:
+    const char* m_name;
+    const char* m_category;
+    uint64_t m_start;
+    
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+};
+
+#endif